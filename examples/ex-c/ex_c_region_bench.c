@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+//
+//  Compares the cost per region of the library interfaces:
+//
+//      timemory_push_region / timemory_pop_region          (name lookup per call)
+//      timemory_get_begin_record / timemory_end_record     (record created per call)
+//      timemory_push_region_id / timemory_pop_region_id    (id requested once)
+//
+//  Each interface is measured while the library is enabled and again after
+//  timemory_pause(), which swaps the markers to no-op implementations.
+//
+//  Usage: ex_c_region_bench <ITERATIONS> <REGIONS>
+//
+//  Set TIMEMORY_REGION_BATCH_SIZE=<N> to batch the completed records of the region
+//  ids before they are inserted into storage.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "timemory/library.h"
+
+#define MAX_REGIONS 64
+
+static char     names[MAX_REGIONS][32];
+static uint64_t ids[MAX_REGIONS];
+
+//======================================================================================//
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1.0e9 * ts.tv_sec + ts.tv_nsec;
+}
+
+//======================================================================================//
+
+static void
+report(const char* mode, const char* label, double beg, double end, long n)
+{
+    printf("[%s] %-24s : %10.2f ns per region\n", mode, label, (end - beg) / n);
+}
+
+//======================================================================================//
+
+static void
+run(const char* mode, long nitr, int nreg)
+{
+    double beg = now();
+    for(long i = 0; i < nitr; ++i)
+    {
+        const char* name = names[i % nreg];
+        timemory_push_region(name);
+        timemory_pop_region(name);
+    }
+    double end = now();
+    report(mode, "push/pop region", beg, end, nitr);
+
+    beg = now();
+    for(long i = 0; i < nitr; ++i)
+    {
+        uint64_t id = timemory_get_begin_record(names[i % nreg]);
+        timemory_end_record(id);
+    }
+    end = now();
+    report(mode, "begin/end record", beg, end, nitr);
+
+    beg = now();
+    for(long i = 0; i < nitr; ++i)
+    {
+        uint64_t id = ids[i % nreg];
+        timemory_push_region_id(id);
+        timemory_pop_region_id(id);
+    }
+    end = now();
+    report(mode, "push/pop region id", beg, end, nitr);
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    long nitr = (argc > 1) ? atol(argv[1]) : 1000000;
+    int  nreg = (argc > 2) ? atoi(argv[2]) : 8;
+    if(nreg < 1)
+        nreg = 1;
+    if(nreg > MAX_REGIONS)
+        nreg = MAX_REGIONS;
+
+    timemory_init_library(argc, argv);
+
+    for(int i = 0; i < nreg; ++i)
+    {
+        sprintf(names[i], "region/%i", i);
+        ids[i] = timemory_get_region_id(names[i]);
+    }
+
+    run("enabled", nitr, nreg);
+
+    timemory_pause();
+    run("disabled", nitr, nreg);
+    timemory_resume();
+
+    timemory_finalize_library();
+    return EXIT_SUCCESS;
+}
+
+//======================================================================================//
@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+//
+//  Compares the cost of throttled functions in binaries rewritten by timemory-run
+//  with and without the --patchable option:
+//
+//      timemory-run -o ex_dynamic_throttle.inst -- ./ex_dynamic_throttle
+//      timemory-run --patchable -o ex_dynamic_throttle.patch -- ./ex_dynamic_throttle
+//
+//      ./ex_dynamic_throttle
+//      ./ex_dynamic_throttle.inst
+//      ./ex_dynamic_throttle.patch
+//
+//  'tiny' is throttled after TIMEMORY_THROTTLE_COUNT calls. In the first rewritten
+//  binary every call still enters and exits the trace library, in the second the
+//  calls are skipped once the flag of the function is set.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+volatile int64_t sink = 0;
+
+__attribute__((noinline)) int64_t
+tiny(int64_t i)
+{
+    sink += i;
+    return sink;
+}
+
+__attribute__((noinline)) int64_t
+heavy(int64_t n)
+{
+    int64_t _sum = 0;
+    for(int64_t i = 0; i < n; ++i)
+        _sum += tiny(i);
+    return _sum;
+}
+
+int
+main(int argc, char** argv)
+{
+    int64_t nitr  = (argc > 1) ? atol(argv[1]) : 10;
+    int64_t ncall = (argc > 2) ? atol(argv[2]) : 1000000;
+
+    using clock_type = std::chrono::steady_clock;
+    using duration_t = std::chrono::duration<double, std::nano>;
+
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        auto _beg = clock_type::now();
+        heavy(ncall);
+        auto _end = clock_type::now();
+        printf("[%s] iteration %2li :: %8.3f ns per call\n", argv[0], (long) i,
+               duration_t(_end - _beg).count() / ncall);
+    }
+
+    return (sink == 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -52,6 +52,8 @@ struct basic
 {};
 struct blank
 {};
+struct blank_constexpr
+{};
 struct none
 {};
 struct basic_pointer
@@ -131,6 +133,22 @@ fibonacci(int64_t n, int64_t cutoff)
 
 //======================================================================================//
 
+template <typename Tp,
+          tim::enable_if_t<std::is_same<Tp, mode::blank_constexpr>::value, int> = 0>
+int64_t
+fibonacci(int64_t n, int64_t cutoff)
+{
+    if(n > cutoff)
+    {
+        TIMEMORY_CONSTEXPR_BLANK_MARKER(auto_tuple_t, "fibonacci");
+        return (n < 2) ? n
+                       : (fibonacci<Tp>(n - 1, cutoff) + fibonacci<Tp>(n - 2, cutoff));
+    }
+    return fibonacci(n);
+}
+
+//======================================================================================//
+
 template <typename Tp, tim::enable_if_t<std::is_same<Tp, mode::basic>::value, int> = 0>
 int64_t
 fibonacci(int64_t n, int64_t cutoff)
@@ -189,6 +207,7 @@ run(int64_t n, int64_t cutoff, bool store = true)
 {
     // bool is_none  = std::is_same<Tp, mode::none>::value;
     bool is_blank = std::is_same<Tp, mode::blank>::value ||
+                    std::is_same<Tp, mode::blank_constexpr>::value ||
                     std::is_same<Tp, mode::blank_pointer>::value;
     bool is_basic = std::is_same<Tp, mode::basic>::value ||
                     std::is_same<Tp, mode::basic_pointer>::value;
@@ -252,6 +271,27 @@ launch(const int nitr, const int nfib, const int cutoff, int64_t& ex_measure,
     timer_list.at(timer_list.size() - 2).rekey("difference vs. " + prefix);
     timer_list.at(timer_list.size() - 1).rekey("average overhead of " + prefix);
 }
+//======================================================================================//
+// average cost of a start/stop of a clock component (without storage) in nanoseconds
+template <typename Tp>
+void
+clock_overhead(int64_t nitr)
+{
+    Tp   obj;
+    auto _beg = tim::get_clock_monotonic_raw_now<int64_t, std::nano>();
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        obj.start();
+        obj.stop();
+    }
+    auto _end = tim::get_clock_monotonic_raw_now<int64_t, std::nano>();
+    std::cout << std::setw(24) << Tp::get_label() << " : " << std::setw(8)
+              << std::setprecision(2) << std::fixed
+              << (static_cast<double>(_end - _beg) / nitr) << " ns per start/stop"
+              << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
 //======================================================================================//
 
 int
@@ -333,6 +373,7 @@ main(int argc, char** argv)
     //      run various modes
     //----------------------------------------------------------------------------------//
     launch<mode::blank>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
+    launch<mode::blank_constexpr>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::blank_pointer>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::basic>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
     launch<mode::basic_pointer>(nitr, nfib, cutoff, ex_measure, ex_unique, timer_list);
@@ -353,6 +394,16 @@ main(int argc, char** argv)
             std::cout << "\n";
     }
 
+    //----------------------------------------------------------------------------------//
+    //      compare the cost of the clocks
+    //----------------------------------------------------------------------------------//
+    std::cout << "Clock overhead (cycle counter is "
+              << ((tsc_clock::is_invariant()) ? "invariant" : "not invariant, fallback")
+              << "):" << std::endl;
+    clock_overhead<wall_clock>(1000000);
+    clock_overhead<monotonic_raw_clock>(1000000);
+    clock_overhead<tsc_clock>(1000000);
+
     auto l1_size  = tim::ert::cache_size::get<1>();
     auto l2_size  = tim::ert::cache_size::get<2>();
     auto l3_size  = tim::ert::cache_size::get<3>();
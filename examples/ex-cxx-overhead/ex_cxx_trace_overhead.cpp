@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  Compares the cost per call of timemory_push_trace_hash / timemory_pop_trace_hash
+//  (the interface used by binaries instrumented with timemory-run) for:
+//
+//      registered ids      (dense index + per-thread shadow stack)
+//      unregistered ids    (per-thread trace map, i.e. the generic path)
+//      deep recursion      (registered ids nested deeper than the shadow stack)
+//
+//  Usage: ex_cxx_trace_overhead <ITERATIONS> <FUNCTIONS> <DEPTH>
+//
+//  Set TIMEMORY_TRACE_STACK_DEPTH=<N> to change the depth of the shadow stack and
+//  TIMEMORY_TRACE_COMPONENTS to change the components of each record.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "timemory/library.h"
+#include "timemory/timemory.hpp"
+
+using steady_clock_t = std::chrono::steady_clock;
+using id_vector_t    = std::vector<uint64_t>;
+
+//======================================================================================//
+
+static void
+report(const std::string& label, steady_clock_t::time_point beg, int64_t n)
+{
+    auto end = steady_clock_t::now();
+    std::cout << std::setw(28) << std::left << label << " : " << std::setw(10)
+              << std::right << std::setprecision(2) << std::fixed
+              << (std::chrono::duration<double, std::nano>(end - beg).count() / n)
+              << " ns per push/pop" << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+//======================================================================================//
+
+static void
+run(const std::string& label, int64_t nitr, const id_vector_t& ids)
+{
+    auto beg = steady_clock_t::now();
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        auto id = ids[i % ids.size()];
+        timemory_push_trace_hash(id);
+        timemory_pop_trace_hash(id);
+    }
+    report(label, beg, nitr);
+}
+
+//======================================================================================//
+
+static void
+recurse(uint64_t id, int64_t n)
+{
+    timemory_push_trace_hash(id);
+    if(n > 1)
+        recurse(id, n - 1);
+    timemory_pop_trace_hash(id);
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    int64_t nitr  = (argc > 1) ? atol(argv[1]) : 1000000;
+    int64_t nfunc = (argc > 2) ? atol(argv[2]) : 8;
+    int64_t depth = (argc > 3) ? atol(argv[3]) : 1024;
+    if(nfunc < 1)
+        nfunc = 1;
+    if(depth < 1)
+        depth = 1;
+
+    timemory_trace_init("wall_clock", false, argv[0]);
+    // every call is measured
+    tim::settings::throttle_count() = std::numeric_limits<size_t>::max();
+
+    id_vector_t registered{};
+    id_vector_t unregistered{};
+    for(int64_t i = 0; i < nfunc; ++i)
+    {
+        auto _name = std::string{ "registered/" } + std::to_string(i);
+        registered.emplace_back(tim::get_hash_id(_name));
+        timemory_add_hash_id(registered.back(), _name.c_str());
+        // the name is known but the id is never assigned a dense index
+        _name = std::string{ "unregistered/" } + std::to_string(i);
+        unregistered.emplace_back(tim::add_hash_id(_name));
+    }
+
+    std::cout << "\nRunning " << nitr << " push/pop of " << nfunc
+              << " functions (recursion depth = " << depth << ")...\n"
+              << std::endl;
+
+    run("registered ids", nitr, registered);
+    run("unregistered ids", nitr, unregistered);
+
+    auto beg = steady_clock_t::now();
+    for(int64_t i = 0; i < nitr; i += depth)
+        recurse(registered.front(), depth);
+    report("registered ids (recursion)", beg, ((nitr + depth - 1) / depth) * depth);
+
+    timemory_trace_finalize();
+    return EXIT_SUCCESS;
+}
+
+//======================================================================================//
@@ -450,7 +450,8 @@ def run_pyctest():
                    "TIMEOUT": "300",
                    "ENVIRONMENT": test_env})
 
-        pyunittests = ["flat", "rusage", "throttle", "timeline", "timing"]
+        pyunittests = ["binary", "flat", "rusage", "throttle", "timeline",
+                       "timing"]
         for t in pyunittests:
             pyct.test("python-unittest-{}".format(t),
                       [sys.executable, "-m",
@@ -485,6 +486,24 @@ def run_pyctest():
                "TIMEOUT": "600",
                "ENVIRONMENT": test_env})
 
+    pyct.test(construct_name("ex-cxx-trace-overhead"),
+              construct_command(["./ex_cxx_trace_overhead"], args),
+              {"WORKING_DIRECTORY": pyct.BINARY_DIRECTORY,
+               "LABELS": pyct.PROJECT_NAME,
+               "TIMEOUT": "300",
+               "ENVIRONMENT": test_env})
+
+    # rewritten by timemory-run with and without --patchable so that the throttled
+    # call sites are exercised through the dynamic instrumentation path
+    if args.dyninst and args.tools:
+        for _suffix in ["inst", "patch"]:
+            pyct.test(construct_name("ex-dynamic-throttle-{}".format(_suffix)),
+                      ["./ex_dynamic_throttle.{}".format(_suffix), "4", "100000"],
+                      {"WORKING_DIRECTORY": pyct.BINARY_DIRECTORY,
+                       "LABELS": pyct.PROJECT_NAME,
+                       "TIMEOUT": "300",
+                       "ENVIRONMENT": test_env})
+
     if args.cuda:
         pyct.test(construct_name("ex-cuda-event"),
                   ["./ex_cuda_event"],
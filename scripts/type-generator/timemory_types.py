@@ -11,6 +11,8 @@ components = [
     "cpu_clock",
     "monotonic_clock",
     "monotonic_raw_clock",
+    "tsc_clock",
+    "sampling_cpu_clock",
     "thread_cpu_clock",
     "process_cpu_clock",
     "cpu_util",
@@ -103,6 +105,8 @@ mangled_strings = {
     "gpu_roofline_dp_flops": ["gpu_roofline_dp", "gpu_roofline_double"],
     "gpu_roofline_hp_flops": ["gpu_roofline_hp", "gpu_roofline_half"],
     "caliper": ["cali"],
+    "tsc_clock": ["cycle_clock"],
+    "sampling_cpu_clock": ["sampling_clock"],
     "written_bytes": ["write_bytes"],
     "nvtx_marker": ["nvtx"],
     "tau_marker": ["tau"],
@@ -136,6 +140,8 @@ traits = {
                                "cpu_clock",
                                "monotonic_clock",
                                "monotonic_raw_clock",
+                               "tsc_clock",
+                               "sampling_cpu_clock",
                                "thread_cpu_clock",
                                "process_cpu_clock",
                                "cuda_event",
@@ -169,6 +175,8 @@ traits = {
                               "cpu_clock",
                               "monotonic_clock",
                               "monotonic_raw_clock",
+                              "tsc_clock",
+                              "sampling_cpu_clock",
                               "thread_cpu_clock",
                               "process_cpu_clock",
                               "cuda_event",
@@ -193,6 +201,8 @@ native_components = [
     "cpu_clock",
     "monotonic_clock",
     "monotonic_raw_clock",
+    "tsc_clock",
+    "sampling_cpu_clock",
     "thread_cpu_clock",
     "process_cpu_clock",
     "cpu_util",
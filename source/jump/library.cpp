@@ -63,6 +63,7 @@ public:
     void (*timemory_pop_region_jump)(const char*);
 
     void (*timemory_add_hash_id_jump)(uint64_t, const char*);
+    void (*timemory_add_trace_site_jump)(uint64_t, int*);
     void (*timemory_push_trace_jump)(const char*);
     void (*timemory_pop_trace_jump)(const char*);
     void (*timemory_push_trace_hash_jump)(uint64_t);
@@ -94,6 +95,9 @@ public:
 
         DLSYM_JUMP_FUNCTION(timemory_add_hash_id_jump, libhandle, "timemory_add_hash_id");
 
+        DLSYM_JUMP_FUNCTION(timemory_add_trace_site_jump, libhandle,
+                            "timemory_add_trace_site");
+
         DLSYM_JUMP_FUNCTION(timemory_push_trace_jump, libhandle, "timemory_push_trace");
 
         DLSYM_JUMP_FUNCTION(timemory_pop_trace_jump, libhandle, "timemory_pop_trace");
@@ -158,6 +162,11 @@ extern "C"
         (*get_jump()->timemory_add_hash_id_jump)(hash, name);
     }
 
+    void timemory_add_trace_site(uint64_t hash, int* throttled)
+    {
+        (*get_jump()->timemory_add_trace_site_jump)(hash, throttled);
+    }
+
     void timemory_push_trace(const char* name)
     {
         (*get_jump()->timemory_push_trace_jump)(name);
@@ -30,9 +30,12 @@
 //
 #include "timemory/config.hpp"
 
+#include <atomic>
 #include <cstdarg>
 #include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <stack>
 #include <unordered_map>
 #include <unordered_set>
@@ -85,6 +88,167 @@ get_region_map()
     return _instance;
 }
 
+//--------------------------------------------------------------------------------------//
+//  region ids are dense indexes into a process-wide table of names and hashes and into
+//  a per-thread table of records
+//
+struct region_names
+{
+    std::mutex                                   mutex;
+    std::unordered_map<std::string, uint64_t>    ids;
+    std::deque<std::pair<std::string, uint64_t>> entries;
+};
+
+static region_names&
+get_region_names()
+{
+    static region_names _instance;
+    return _instance;
+}
+
+// returns false if the id was not provided by timemory_get_region_id
+static bool
+get_region_info(uint64_t _id, std::string& _name, uint64_t& _hash)
+{
+    auto&                       _names = get_region_names();
+    std::lock_guard<std::mutex> _lk(_names.mutex);
+    if(_id >= _names.entries.size())
+        return false;
+    _name = _names.entries[_id].first;
+    _hash = _names.entries[_id].second;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+//  the records of one recursion depth of a region on one thread. The components are
+//  created once and restarted. When batching, the completed records are accumulated
+//  into batch and only inserted into storage once batch_size laps have completed
+//
+struct region_record
+{
+    region_record(uint64_t _hash, const component_enum_t& _types, size_t _batch_size)
+    : batch_size(_batch_size)
+    , record(_hash, _batch_size == 0)
+    {
+        tim::initialize(record, _types);
+        if(batch_size > 0)
+        {
+            batch = std::unique_ptr<toolset_t>(new toolset_t(_hash, false));
+            tim::initialize(*batch, _types);
+        }
+    }
+
+    void start()
+    {
+        if(batch)
+            record.reset();
+        record.start();
+    }
+
+    void stop()
+    {
+        record.stop();
+        if(!batch)
+            return;
+        *batch += record;
+        if(static_cast<size_t>(batch->laps()) >= batch_size)
+            flush();
+    }
+
+    // insert the accumulated records into storage under the current parent
+    void flush()
+    {
+        if(!batch || batch->laps() == 0)
+            return;
+        record.push();
+        record += *batch;
+        record.pop();
+        batch->reset();
+    }
+
+    size_t                     batch_size = 0;
+    toolset_t                  record;
+    std::unique_ptr<toolset_t> batch = {};
+};
+
+struct region_entry
+{
+    using record_vec_t = std::vector<std::unique_ptr<region_record>>;
+
+    uint64_t         hash    = 0;
+    size_t           depth   = 0;
+    component_enum_t types   = {};
+    record_vec_t     records = {};
+};
+
+using region_entries_t = std::vector<region_entry>;
+
+std::array<bool, 2>&
+get_library_state();
+
+//--------------------------------------------------------------------------------------//
+//  stop any running records and flush any batched records
+//
+static void
+finalize_region_entries(region_entries_t& _entries)
+{
+    for(auto& itr : _entries)
+    {
+        while(itr.depth > 0)
+            itr.records[--itr.depth]->stop();
+        for(auto& ritr : itr.records)
+            ritr->flush();
+    }
+    _entries.clear();
+}
+
+//--------------------------------------------------------------------------------------//
+//  the region entries of one thread. The storage of the components is initialized
+//  before the entries so that, when a thread exits, the entries are destroyed first
+//  and the batched records are flushed before the storage is merged into the master
+//
+struct region_thread_entries
+{
+    region_thread_entries()
+    {
+        toolset_t::init_storage();
+        exists() = true;
+    }
+
+    ~region_thread_entries()
+    {
+        auto lk = tim::trace::lock<tim::trace::library>();
+        if(lk && !get_library_state()[1])
+            finalize_region_entries(entries);
+        exists() = false;
+    }
+
+    // whether the entries of the calling thread have been created
+    static bool& exists()
+    {
+        static thread_local bool _instance = false;
+        return _instance;
+    }
+
+    region_entries_t entries = {};
+};
+
+static region_entries_t&
+get_region_entries()
+{
+    static thread_local region_thread_entries _instance{};
+    return _instance.entries;
+}
+
+//--------------------------------------------------------------------------------------//
+//  stop any running records and flush any batched records of the calling thread
+//
+static void
+finalize_region_entries()
+{
+    finalize_region_entries(get_region_entries());
+}
+
 //--------------------------------------------------------------------------------------//
 
 static components_stack_t&
@@ -132,6 +296,409 @@ get_library_state()
     return _instance;
 }
 
+//--------------------------------------------------------------------------------------//
+//  number of records started on the calling thread which have not been stopped
+//
+static int64_t&
+get_active_records()
+{
+    static thread_local int64_t _instance = 0;
+    return _instance;
+}
+
+static void
+set_library_dispatch(bool _enabled);
+
+//--------------------------------------------------------------------------------------//
+//
+//      Marker implementations when the library is enabled
+//
+//--------------------------------------------------------------------------------------//
+
+namespace
+{
+namespace enabled_api
+{
+void
+begin_record(const char* name, uint64_t* id)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || tim::settings::enabled() == false)
+    {
+        *id = std::numeric_limits<uint64_t>::max();
+        return;
+    }
+    auto& comp = get_current_components();
+    timemory_create_record(name, id, comp.size(), (int*) (comp.data()));
+
+#if defined(DEBUG)
+    if(tim::settings::verbose() > 2)
+        printf("beginning record for '%s' (id = %lli)...\n", name, (long long int) *id);
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+begin_record_types(const char* name, uint64_t* id, const char* ctypes)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || tim::settings::enabled() == false)
+    {
+        *id = std::numeric_limits<uint64_t>::max();
+        return;
+    }
+
+    auto comp = tim::enumerate_components(std::string(ctypes));
+    timemory_create_record(name, id, comp.size(), (int*) (comp.data()));
+
+#if defined(DEBUG)
+    if(tim::settings::verbose() > 2)
+        printf("beginning record for '%s' (id = %lli)...\n", name, (long long int) *id);
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+
+uint64_t
+get_begin_record(const char* name)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || tim::settings::enabled() == false)
+        return std::numeric_limits<uint64_t>::max();
+
+    uint64_t id   = 0;
+    auto&    comp = get_current_components();
+    timemory_create_record(name, &id, comp.size(), (int*) (comp.data()));
+
+#if defined(DEBUG)
+    if(tim::settings::verbose() > 2)
+        printf("beginning record for '%s' (id = %lli)...\n", name, (long long int) id);
+#endif
+
+    return id;
+}
+
+//--------------------------------------------------------------------------------------//
+
+uint64_t
+get_begin_record_types(const char* name, const char* ctypes)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || tim::settings::enabled() == false)
+        return std::numeric_limits<uint64_t>::max();
+
+    uint64_t id   = 0;
+    auto     comp = tim::enumerate_components(std::string(ctypes));
+    timemory_create_record(name, &id, comp.size(), (int*) (comp.data()));
+
+#if defined(DEBUG)
+    if(tim::settings::verbose() > 2)
+        printf("beginning record for '%s' (id = %lli)...\n", name, (long long int) id);
+#endif
+
+    return id;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+end_record(uint64_t id)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || id == std::numeric_limits<uint64_t>::max())
+        return;
+
+    timemory_delete_record(id);
+
+#if defined(DEBUG)
+    if(tim::settings::verbose() > 2)
+        printf("ending record for %lli...\n", (long long int) id);
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+push_region(const char* name)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk)
+        return;
+    auto& region_map = get_region_map();
+    lk.release();
+    auto idx = get_begin_record(name);
+    lk       = tim::trace::lock<tim::trace::library>();
+    region_map[name].push(idx);
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+pop_region(const char* name)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk)
+        return;
+    auto& region_map = get_region_map();
+    auto  itr        = region_map.find(name);
+    if(itr == region_map.end() || (itr != region_map.end() && itr->second.empty()))
+    {
+        if(tim::settings::enabled())
+            fprintf(stderr, "Warning! region '%s' does not exist!\n", name);
+    }
+    else
+    {
+        uint64_t idx = itr->second.top();
+        lk.release();
+        end_record(idx);
+        lk = tim::trace::lock<tim::trace::library>();
+        itr->second.pop();
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+push_region_id(uint64_t id)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk || tim::settings::enabled() == false)
+        return;
+
+    auto& _entries = get_region_entries();
+    if(id >= _entries.size() || _entries[id].hash == 0)
+    {
+        std::string _name;
+        uint64_t    _hash = 0;
+        if(!get_region_info(id, _name, _hash))
+        {
+            fprintf(stderr, "Warning! region id %llu does not exist!\n",
+                    (unsigned long long) id);
+            return;
+        }
+        if(timemory_create_function)
+        {
+            // defer to the tool providing the records
+            lk.release();
+            push_region(_name.c_str());
+            return;
+        }
+        if(id >= _entries.size())
+            _entries.resize(id + 1);
+        _entries[id].hash = _hash;
+    }
+
+    auto& _entry = _entries[id];
+    auto& _comp  = get_current_components();
+    if(_entry.depth == 0 && _entry.types != _comp)
+    {
+        // the components changed so the existing records are discarded
+        for(auto& itr : _entry.records)
+            itr->flush();
+        _entry.records.clear();
+        _entry.types = _comp;
+    }
+
+    if(_entry.depth == _entry.records.size())
+        _entry.records.emplace_back(new region_record(
+            _entry.hash, _entry.types, tim::settings::region_batch_size()));
+    _entry.records[_entry.depth++]->start();
+    ++get_active_records();
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+pop_region_id(uint64_t id)
+{
+    auto lk = tim::trace::lock<tim::trace::library>();
+    if(!lk)
+        return;
+
+    auto& _entries = get_region_entries();
+    if(id < _entries.size() && _entries[id].depth > 0)
+    {
+        auto& _entry = _entries[id];
+        _entry.records[--_entry.depth]->stop();
+        --get_active_records();
+    }
+    else if(timemory_delete_function)
+    {
+        std::string _name;
+        uint64_t    _hash = 0;
+        if(!get_region_info(id, _name, _hash))
+            return;
+        lk.release();
+        pop_region(_name.c_str());
+    }
+    else if(tim::settings::enabled())
+    {
+        fprintf(stderr, "Warning! region id %llu is not active!\n",
+                (unsigned long long) id);
+    }
+}
+}  // namespace enabled_api
+
+//--------------------------------------------------------------------------------------//
+//
+//      Marker implementations when the library is disabled. Records which were
+//      started before the library was disabled are still stopped
+//
+//--------------------------------------------------------------------------------------//
+
+namespace disabled_api
+{
+// the settings can be enabled directly (from C++, python, or the trace library)
+// instead of through timemory_resume so the disabled markers check them and restore
+// the enabled table
+bool
+reenabled()
+{
+    if(!tim::settings::enabled())
+        return false;
+    set_library_dispatch(true);
+    return true;
+}
+
+void
+begin_record(const char* name, uint64_t* id)
+{
+    if(reenabled())
+        return enabled_api::begin_record(name, id);
+    *id = std::numeric_limits<uint64_t>::max();
+}
+
+void
+begin_record_types(const char* name, uint64_t* id, const char* ctypes)
+{
+    if(reenabled())
+        return enabled_api::begin_record_types(name, id, ctypes);
+    *id = std::numeric_limits<uint64_t>::max();
+}
+
+uint64_t
+get_begin_record(const char* name)
+{
+    if(reenabled())
+        return enabled_api::get_begin_record(name);
+    return std::numeric_limits<uint64_t>::max();
+}
+
+uint64_t
+get_begin_record_types(const char* name, const char* ctypes)
+{
+    if(reenabled())
+        return enabled_api::get_begin_record_types(name, ctypes);
+    return std::numeric_limits<uint64_t>::max();
+}
+
+void
+end_record(uint64_t id)
+{
+    if(get_active_records() > 0 || reenabled())
+        enabled_api::end_record(id);
+}
+
+void
+push_region(const char* name)
+{
+    if(reenabled())
+        enabled_api::push_region(name);
+}
+
+void
+pop_region(const char* name)
+{
+    if(get_active_records() > 0 || reenabled())
+        enabled_api::pop_region(name);
+}
+
+void
+push_region_id(uint64_t id)
+{
+    if(reenabled())
+        enabled_api::push_region_id(id);
+}
+
+void
+pop_region_id(uint64_t id)
+{
+    if(get_active_records() > 0 || reenabled())
+        enabled_api::pop_region_id(id);
+}
+}  // namespace disabled_api
+}  // namespace
+
+//--------------------------------------------------------------------------------------//
+//  the marker functions of the library API call through this table. timemory_pause
+//  and timemory_resume swap the table so that a disabled marker costs one indirect
+//  call and a check of the settings instead of acquiring the library lock. The
+//  disabled markers swap it back when the settings were enabled directly
+//
+struct library_dispatch
+{
+    bool enabled;
+    void (*begin_record)(const char*, uint64_t*);
+    void (*begin_record_types)(const char*, uint64_t*, const char*);
+    uint64_t (*get_begin_record)(const char*);
+    uint64_t (*get_begin_record_types)(const char*, const char*);
+    void (*end_record)(uint64_t);
+    void (*push_region)(const char*);
+    void (*pop_region)(const char*);
+    void (*push_region_id)(uint64_t);
+    void (*pop_region_id)(uint64_t);
+};
+
+static const library_dispatch enabled_dispatch = {
+    true,
+    &enabled_api::begin_record,
+    &enabled_api::begin_record_types,
+    &enabled_api::get_begin_record,
+    &enabled_api::get_begin_record_types,
+    &enabled_api::end_record,
+    &enabled_api::push_region,
+    &enabled_api::pop_region,
+    &enabled_api::push_region_id,
+    &enabled_api::pop_region_id,
+};
+
+static const library_dispatch disabled_dispatch = {
+    false,
+    &disabled_api::begin_record,
+    &disabled_api::begin_record_types,
+    &disabled_api::get_begin_record,
+    &disabled_api::get_begin_record_types,
+    &disabled_api::end_record,
+    &disabled_api::push_region,
+    &disabled_api::pop_region,
+    &disabled_api::push_region_id,
+    &disabled_api::pop_region_id,
+};
+
+// constant-initialized so reading the table never checks a static guard
+static std::atomic<const library_dispatch*> library_dispatch_instance{
+    &enabled_dispatch
+};
+
+static inline const library_dispatch*
+get_library_dispatch()
+{
+    return library_dispatch_instance.load(std::memory_order_relaxed);
+}
+
+static void
+set_library_dispatch(bool _enabled)
+{
+    library_dispatch_instance.store((_enabled) ? &enabled_dispatch : &disabled_dispatch);
+}
+
+// start in the disabled state when TIMEMORY_ENABLED=OFF
+static struct library_dispatch_init
+{
+    library_dispatch_init() { set_library_dispatch(tim::settings::enabled()); }
+} library_dispatch_init_instance;
+
 //--------------------------------------------------------------------------------------//
 //
 //      TiMemory symbols
@@ -157,6 +724,7 @@ extern "C"
     //
     void timemory_create_record(const char* name, uint64_t* id, int n, int* ctypes)
     {
+        ++get_active_records();
         if(timemory_create_function)
         {
             (*timemory_create_function)(name, id, n, ctypes);
@@ -169,8 +737,6 @@ extern "C"
         _record_map.insert({ *id, toolset_t(name, true) });
         tim::initialize(_record_map[*id], n, ctypes);
         _record_map[*id].start();
-        if(_record_map.bucket_count() > _record_map.size())
-            _record_map.rehash(_record_map.size() + 10);
     }
 
     //----------------------------------------------------------------------------------//
@@ -181,6 +747,8 @@ extern "C"
         if(timemory_delete_function)
         {
             (*timemory_delete_function)(id);
+            if(get_active_records() > 0)
+                --get_active_records();
         }
         else if(get_record_map().find(id) != get_record_map().end())
         {
@@ -188,6 +756,7 @@ extern "C"
             // stop recording, destroy objects, and erase key from map
             _record_map[id].stop();
             _record_map.erase(id);
+            --get_active_records();
         }
     }
 
@@ -211,6 +780,7 @@ extern "C"
         tim::timemory_init(argc, argv);
         _manager->update_metadata_prefix();
         // tim::settings::parse();
+        set_library_dispatch(tim::settings::enabled());
     }
 
     //----------------------------------------------------------------------------------//
@@ -220,7 +790,8 @@ extern "C"
         auto lk                = tim::trace::lock<tim::trace::library>();
         get_library_state()[1] = true;
 
-        if(tim::settings::enabled() == false && get_record_map().empty())
+        if(tim::settings::enabled() == false && get_record_map().empty() &&
+           (!region_thread_entries::exists() || get_region_entries().empty()))
             return;
 
         auto& _record_map = get_record_map();
@@ -245,6 +816,9 @@ extern "C"
         // clear the map
         _record_map.clear();
 
+        // stop and flush the records of the region ids
+        finalize_region_entries();
+
         // have the manager finalize
         tim::manager::instance()->finalize();
 
@@ -253,6 +827,7 @@ extern "C"
 
         // just in case
         tim::settings::enabled() = false;
+        set_library_dispatch(false);
 
         // set the finalization state to true
         tim::dmp::is_finalized() = true;
@@ -269,12 +844,20 @@ extern "C"
     //----------------------------------------------------------------------------------//
     //  pause the collection
     //
-    void timemory_pause(void) { tim::settings::enabled() = false; }
+    void timemory_pause(void)
+    {
+        tim::settings::enabled() = false;
+        set_library_dispatch(false);
+    }
 
     //----------------------------------------------------------------------------------//
     //  resume the collection
     //
-    void timemory_resume(void) { tim::settings::enabled() = true; }
+    void timemory_resume(void)
+    {
+        tim::settings::enabled() = true;
+        set_library_dispatch(true);
+    }
 
     //----------------------------------------------------------------------------------//
 
@@ -350,50 +933,60 @@ extern "C"
     }
 
     //----------------------------------------------------------------------------------//
-
+    //  the markers dispatch through the table of the current state
+    //
     void timemory_begin_record(const char* name, uint64_t* id)
     {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk || tim::settings::enabled() == false)
-        {
-            *id = std::numeric_limits<uint64_t>::max();
-            return;
-        }
-        auto& comp = get_current_components();
-        timemory_create_record(name, id, comp.size(), (int*) (comp.data()));
+        get_library_dispatch()->begin_record(name, id);
+    }
 
-#if defined(DEBUG)
-        if(tim::settings::verbose() > 2)
-            printf("beginning record for '%s' (id = %lli)...\n", name,
-                   (long long int) *id);
-#endif
+    void timemory_begin_record_types(const char* name, uint64_t* id, const char* ctypes)
+    {
+        get_library_dispatch()->begin_record_types(name, id, ctypes);
     }
 
-    //----------------------------------------------------------------------------------//
+    uint64_t timemory_get_begin_record(const char* name)
+    {
+        return get_library_dispatch()->get_begin_record(name);
+    }
 
-    void timemory_begin_record_types(const char* name, uint64_t* id, const char* ctypes)
+    uint64_t timemory_get_begin_record_types(const char* name, const char* ctypes)
     {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk || tim::settings::enabled() == false)
-        {
-            *id = std::numeric_limits<uint64_t>::max();
-            return;
-        }
+        return get_library_dispatch()->get_begin_record_types(name, ctypes);
+    }
 
-        auto comp = tim::enumerate_components(std::string(ctypes));
-        timemory_create_record(name, id, comp.size(), (int*) (comp.data()));
+    void timemory_end_record(uint64_t id) { get_library_dispatch()->end_record(id); }
 
-#if defined(DEBUG)
-        if(tim::settings::verbose() > 2)
-            printf("beginning record for '%s' (id = %lli)...\n", name,
-                   (long long int) *id);
-#endif
+    void timemory_push_region(const char* name)
+    {
+        get_library_dispatch()->push_region(name);
+    }
+
+    void timemory_pop_region(const char* name)
+    {
+        get_library_dispatch()->pop_region(name);
+    }
+
+    void timemory_push_region_id(uint64_t id)
+    {
+        get_library_dispatch()->push_region_id(id);
+    }
+
+    void timemory_pop_region_id(uint64_t id)
+    {
+        get_library_dispatch()->pop_region_id(id);
     }
 
     //----------------------------------------------------------------------------------//
 
     void timemory_begin_record_enum(const char* name, uint64_t* id, ...)
     {
+        if(!get_library_dispatch()->enabled && !disabled_api::reenabled())
+        {
+            *id = std::numeric_limits<uint64_t>::max();
+            return;
+        }
+
         auto lk = tim::trace::lock<tim::trace::library>();
         if(!lk || tim::settings::enabled() == false)
         {
@@ -424,50 +1017,11 @@ extern "C"
 
     //----------------------------------------------------------------------------------//
 
-    uint64_t timemory_get_begin_record(const char* name)
+    uint64_t timemory_get_begin_record_enum(const char* name, ...)
     {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk || tim::settings::enabled() == false)
+        if(!get_library_dispatch()->enabled && !disabled_api::reenabled())
             return std::numeric_limits<uint64_t>::max();
 
-        uint64_t id   = 0;
-        auto&    comp = get_current_components();
-        timemory_create_record(name, &id, comp.size(), (int*) (comp.data()));
-
-#if defined(DEBUG)
-        if(tim::settings::verbose() > 2)
-            printf("beginning record for '%s' (id = %lli)...\n", name,
-                   (long long int) id);
-#endif
-
-        return id;
-    }
-
-    //----------------------------------------------------------------------------------//
-
-    uint64_t timemory_get_begin_record_types(const char* name, const char* ctypes)
-    {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk || tim::settings::enabled() == false)
-            return std::numeric_limits<uint64_t>::max();
-
-        uint64_t id   = 0;
-        auto     comp = tim::enumerate_components(std::string(ctypes));
-        timemory_create_record(name, &id, comp.size(), (int*) (comp.data()));
-
-#if defined(DEBUG)
-        if(tim::settings::verbose() > 2)
-            printf("beginning record for '%s' (id = %lli)...\n", name,
-                   (long long int) id);
-#endif
-
-        return id;
-    }
-
-    //----------------------------------------------------------------------------------//
-
-    uint64_t timemory_get_begin_record_enum(const char* name, ...)
-    {
         auto lk = tim::trace::lock<tim::trace::library>();
         if(!lk || tim::settings::enabled() == false)
             return std::numeric_limits<uint64_t>::max();
@@ -498,54 +1052,20 @@ extern "C"
     }
 
     //----------------------------------------------------------------------------------//
-
-    void timemory_end_record(uint64_t id)
-    {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk || id == std::numeric_limits<uint64_t>::max())
-            return;
-
-        timemory_delete_record(id);
-
-#if defined(DEBUG)
-        if(tim::settings::verbose() > 2)
-            printf("ending record for %lli...\n", (long long int) id);
-#endif
-    }
-
-    //----------------------------------------------------------------------------------//
-
-    void timemory_push_region(const char* name)
-    {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk)
-            return;
-        auto& region_map = get_region_map();
-        lk.release();
-        auto idx = timemory_get_begin_record(name);
-        lk       = tim::trace::lock<tim::trace::library>();
-        region_map[name].push(idx);
-    }
-
-    //----------------------------------------------------------------------------------//
-
-    void timemory_pop_region(const char* name)
+    //  get the id of a region. The id is the same on every thread and is intended to
+    //  be requested once per region name
+    //
+    uint64_t timemory_get_region_id(const char* name)
     {
-        auto lk = tim::trace::lock<tim::trace::library>();
-        if(!lk)
-            return;
-        auto& region_map = get_region_map();
-        auto  itr        = region_map.find(name);
-        if(itr == region_map.end() || (itr != region_map.end() && itr->second.empty()))
-            fprintf(stderr, "Warning! region '%s' does not exist!\n", name);
-        else
-        {
-            uint64_t idx = itr->second.top();
-            lk.release();
-            timemory_end_record(idx);
-            lk = tim::trace::lock<tim::trace::library>();
-            itr->second.pop();
-        }
+        auto&                       _names = get_region_names();
+        std::lock_guard<std::mutex> _lk(_names.mutex);
+        auto                        itr = _names.ids.find(name);
+        if(itr != _names.ids.end())
+            return itr->second;
+        uint64_t _id = _names.entries.size();
+        _names.entries.emplace_back(name, tim::add_hash_id(name));
+        _names.ids.emplace(name, _id);
+        return _id;
     }
 
     //==================================================================================//
@@ -606,6 +1126,15 @@ extern "C"
 
     void timemory_pop_region_(const char* name) { return timemory_pop_region(name); }
 
+    uint64_t timemory_get_region_id_(const char* name)
+    {
+        return timemory_get_region_id(name);
+    }
+
+    void timemory_push_region_id_(uint64_t id) { return timemory_push_region_id(id); }
+
+    void timemory_pop_region_id_(uint64_t id) { return timemory_pop_region_id(id); }
+
     //======================================================================================//
 
 }  // extern "C"
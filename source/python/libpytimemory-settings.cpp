@@ -62,16 +62,27 @@ generate(py::module& _pymod)
     SETTING_PROPERTY(bool, file_output);
     SETTING_PROPERTY(bool, text_output);
     SETTING_PROPERTY(bool, json_output);
+    SETTING_PROPERTY(bool, binary_output);
+    SETTING_PROPERTY(bool, binary_only_output);
+    SETTING_PROPERTY(size_t, output_threads);
     SETTING_PROPERTY(bool, dart_output);
     SETTING_PROPERTY(bool, time_output);
     SETTING_PROPERTY(bool, plot_output);
     SETTING_PROPERTY(bool, diff_output);
     SETTING_PROPERTY(bool, flamegraph_output);
+    SETTING_PROPERTY(bool, trace_output);
+    SETTING_PROPERTY(size_t, trace_buffer);
+    SETTING_PROPERTY(double, snapshot_interval);
+    SETTING_PROPERTY(string_t, export_socket);
+    SETTING_PROPERTY(string_t, export_components);
     SETTING_PROPERTY(int, verbose);
     SETTING_PROPERTY(bool, debug);
     SETTING_PROPERTY(bool, banner);
     SETTING_PROPERTY(bool, flat_profile);
     SETTING_PROPERTY(bool, timeline_profile);
+    SETTING_PROPERTY(size_t, timeline_buffer);
+    SETTING_PROPERTY(bool, timeline_flush);
+    SETTING_PROPERTY(bool, timeline_compress);
     SETTING_PROPERTY(bool, collapse_threads);
     SETTING_PROPERTY(bool, collapse_processes);
     SETTING_PROPERTY(bool, destructor_report);
@@ -81,6 +92,10 @@ generate(py::module& _pymod)
     SETTING_PROPERTY(strvector_t, command_line);
     SETTING_PROPERTY(size_t, throttle_count);
     SETTING_PROPERTY(size_t, throttle_value);
+    SETTING_PROPERTY(double, throttle_hysteresis);
+    SETTING_PROPERTY(double, throttle_budget);
+    SETTING_PROPERTY(double, throttle_interval);
+    SETTING_PROPERTY(size_t, region_batch_size);
     // width/precision
     SETTING_PROPERTY(int16_t, precision);
     SETTING_PROPERTY(int16_t, width);
@@ -102,7 +117,10 @@ generate(py::module& _pymod)
     SETTING_PROPERTY(bool, dart_label);
     // parallelism
     SETTING_PROPERTY(size_t, max_thread_bookmarks);
+    SETTING_PROPERTY(size_t, merge_threads);
+    SETTING_PROPERTY(size_t, merge_interval);
     SETTING_PROPERTY(bool, cpu_affinity);
+    SETTING_PROPERTY(size_t, thread_pool_size);
     SETTING_PROPERTY(bool, mpi_init);
     SETTING_PROPERTY(bool, mpi_finalize);
     SETTING_PROPERTY(bool, mpi_thread);
@@ -154,6 +172,15 @@ generate(py::module& _pymod)
     SETTING_PROPERTY(uint64_t, ert_max_data_size_cpu);
     SETTING_PROPERTY(uint64_t, ert_max_data_size_gpu);
     SETTING_PROPERTY(string_t, ert_skip_ops);
+    SETTING_PROPERTY(bool, ert_pin_threads);
+    SETTING_PROPERTY(bool, ert_cache_sweep);
+    SETTING_PROPERTY(bool, ert_cache);
+    SETTING_PROPERTY(string_t, ert_cache_dir);
+    SETTING_PROPERTY(double, ert_cache_max_age);
+    // sampling
+    SETTING_PROPERTY(double, sampling_frequency);
+    SETTING_PROPERTY(size_t, sampling_buffer);
+    SETTING_PROPERTY(int, sampling_backtrace);
     // signals
     SETTING_PROPERTY(bool, allow_signal_handler);
     SETTING_PROPERTY(bool, enable_signal_handler);
@@ -94,10 +94,14 @@ extern "C"
     void     timemory_end_record(uint64_t) {}
     void     timemory_push_region(const char*) {}
     void     timemory_pop_region(const char*) {}
+    uint64_t timemory_get_region_id(const char*) { RETURN_MAX(uint64_t); }
+    void     timemory_push_region_id(uint64_t) {}
+    void     timemory_pop_region_id(uint64_t) {}
 
     bool timemory_is_throttled(const char*) { return true; }
     void timemory_add_hash_id(uint64_t, const char*) {}
     void timemory_add_hash_ids(uint64_t, uint64_t*, const char**) {}
+    void timemory_add_trace_site(uint64_t, int*) {}
 
     // tracing API
     void timemory_push_trace(const char*) {}
@@ -123,8 +127,11 @@ extern "C"
     {
         RETURN_MAX(uint64_t);
     }
-    void timemory_end_record_(uint64_t) {}
-    void timemory_push_region_(const char*) {}
-    void timemory_pop_region_(const char*) {}
+    void     timemory_end_record_(uint64_t) {}
+    void     timemory_push_region_(const char*) {}
+    void     timemory_pop_region_(const char*) {}
+    uint64_t timemory_get_region_id_(const char*) { RETURN_MAX(uint64_t); }
+    void     timemory_push_region_id_(uint64_t) {}
+    void     timemory_pop_region_id_(uint64_t) {}
 
 }  // extern "C"
@@ -0,0 +1,457 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "timemory/timemory.hpp"
+
+using namespace tim::component;
+
+static int    _argc = 0;
+static char** _argv = nullptr;
+
+using toolset_t = tim::auto_tuple<wall_clock>;
+using printer_t = tim::operation::finalize::print<wall_clock, true>;
+
+TIMEMORY_DECLARE_EXTERN_STORAGE(component::wall_clock, wc)
+TIMEMORY_DECLARE_EXTERN_OPERATIONS(component::wall_clock, true)
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//  Get the current tests name
+//
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// generic tree which both the JSON and the binary output are decoded into
+struct value
+{
+    enum kind_t
+    {
+        null_kind,
+        bool_kind,
+        int_kind,
+        uint_kind,
+        real_kind,
+        string_kind,
+        array_kind,
+        object_kind
+    };
+
+    kind_t                       kind   = null_kind;
+    bool                         b      = false;
+    int64_t                      i      = 0;
+    uint64_t                     u      = 0;
+    double                       d      = 0.0;
+    std::string                  s      = {};
+    std::vector<value>           array  = {};
+    std::map<std::string, value> object = {};
+
+    bool is_number() const
+    {
+        return kind == int_kind || kind == uint_kind || kind == real_kind;
+    }
+    double as_double() const
+    {
+        return (kind == int_kind) ? static_cast<double>(i)
+                                  : (kind == uint_kind) ? static_cast<double>(u) : d;
+    }
+    const value& operator[](const std::string& _key) const { return object.at(_key); }
+    const value& operator[](size_t _idx) const { return array.at(_idx); }
+};
+
+// converts the document parsed from the JSON output into the generic tree
+template <typename JsonT>
+value
+from_json(const JsonT& _json)
+{
+    value _v{};
+    if(_json.IsObject())
+    {
+        _v.kind = value::object_kind;
+        for(auto itr = _json.MemberBegin(); itr != _json.MemberEnd(); ++itr)
+        {
+            std::string _key{ itr->name.GetString(), itr->name.GetStringLength() };
+            _v.object[_key] = from_json(itr->value);
+        }
+    }
+    else if(_json.IsArray())
+    {
+        _v.kind = value::array_kind;
+        for(auto itr = _json.Begin(); itr != _json.End(); ++itr)
+            _v.array.emplace_back(from_json(*itr));
+    }
+    else if(_json.IsString())
+    {
+        _v.kind = value::string_kind;
+        _v.s    = std::string{ _json.GetString(), _json.GetStringLength() };
+    }
+    else if(_json.IsBool())
+    {
+        _v.kind = value::bool_kind;
+        _v.b    = _json.GetBool();
+    }
+    else if(_json.IsUint64())
+    {
+        _v.kind = value::uint_kind;
+        _v.u    = _json.GetUint64();
+    }
+    else if(_json.IsInt64())
+    {
+        _v.kind = value::int_kind;
+        _v.i    = _json.GetInt64();
+    }
+    else if(_json.IsNumber())
+    {
+        _v.kind = value::real_kind;
+        _v.d    = _json.GetDouble();
+    }
+    return _v;
+}
+
+// decoder of the tokens written by cereal::StreamingBinaryOutputArchive
+struct binary_reader
+{
+    using archive_t = cereal::StreamingBinaryOutputArchive;
+
+    explicit binary_reader(std::istream& _is)
+    : is(_is)
+    {}
+
+    value parse()
+    {
+        char _magic[5];
+        is.read(_magic, 5);
+        if(!is || std::string(_magic, 5) != "TMBIN")
+            throw std::runtime_error("invalid binary header");
+        if(byte() != archive_t::version)
+            throw std::runtime_error("invalid binary version");
+        return parse_value(byte());
+    }
+
+private:
+    uint8_t byte()
+    {
+        auto _c = is.get();
+        if(_c == std::char_traits<char>::eof())
+            throw std::runtime_error("unexpected end of binary data");
+        return static_cast<uint8_t>(_c);
+    }
+
+    uint64_t varint()
+    {
+        uint64_t _v     = 0;
+        int      _shift = 0;
+        while(true)
+        {
+            auto _c = byte();
+            _v |= static_cast<uint64_t>(_c & 0x7f) << _shift;
+            if(_c < 0x80)
+                return _v;
+            _shift += 7;
+        }
+    }
+
+    std::string string()
+    {
+        std::string _s(varint(), '\0');
+        is.read(&_s[0], _s.length());
+        return _s;
+    }
+
+    template <typename Tp>
+    Tp fixed()
+    {
+        char _bytes[sizeof(Tp)];
+        for(auto& itr : _bytes)
+            itr = static_cast<char>(byte());
+        Tp _v;
+        std::memcpy(&_v, _bytes, sizeof(Tp));
+        return _v;
+    }
+
+    std::string key(uint8_t _tok)
+    {
+        auto _id = varint();
+        if(_tok == archive_t::define_key)
+            keys[_id] = string();
+        else if(_tok != archive_t::key_ref)
+            throw std::runtime_error("expected a key token");
+        return keys.at(_id);
+    }
+
+    value parse_value(uint8_t _tok)
+    {
+        value _v{};
+        switch(_tok)
+        {
+            case archive_t::begin_object:
+                _v.kind = value::object_kind;
+                for(auto _c = byte(); _c != archive_t::end_node; _c = byte())
+                {
+                    auto _key       = key(_c);
+                    _v.object[_key] = parse_value(byte());
+                }
+                break;
+            case archive_t::begin_array:
+                _v.kind = value::array_kind;
+                for(auto _c = byte(); _c != archive_t::end_node; _c = byte())
+                    _v.array.emplace_back(parse_value(_c));
+                break;
+            case archive_t::null_value: break;
+            case archive_t::false_value:
+            case archive_t::true_value:
+                _v.kind = value::bool_kind;
+                _v.b    = (_tok == archive_t::true_value);
+                break;
+            case archive_t::int_value:
+            {
+                auto _z = varint();
+                _v.kind = value::int_kind;
+                _v.i    = static_cast<int64_t>(_z >> 1) ^ -static_cast<int64_t>(_z & 1);
+                break;
+            }
+            case archive_t::uint_value:
+                _v.kind = value::uint_kind;
+                _v.u    = varint();
+                break;
+            case archive_t::f64_value:
+                _v.kind = value::real_kind;
+                _v.d    = fixed<double>();
+                break;
+            case archive_t::f32_value:
+                _v.kind = value::real_kind;
+                _v.d    = fixed<float>();
+                break;
+            case archive_t::str_value:
+                _v.kind = value::string_kind;
+                _v.s    = string();
+                break;
+            default: throw std::runtime_error("invalid token in binary data");
+        }
+        return _v;
+    }
+
+    std::istream&                   is;
+    std::map<uint64_t, std::string> keys = {};
+};
+
+// recursively compares the trees and reports the path of the first difference
+inline void
+compare(const value& _json, const value& _bin, const std::string& _path)
+{
+    if(_json.is_number() && _bin.is_number())
+    {
+        if(_json.kind != value::real_kind && _bin.kind != value::real_kind)
+        {
+            if(_json.kind == _bin.kind)
+            {
+                ASSERT_EQ(_json.i, _bin.i) << _path;
+                ASSERT_EQ(_json.u, _bin.u) << _path;
+            }
+            else
+            {
+                // non-negative signed values are written as unsigned in JSON
+                auto& _s = (_json.kind == value::int_kind) ? _json : _bin;
+                auto& _u = (_json.kind == value::uint_kind) ? _json : _bin;
+                ASSERT_GE(_s.i, 0) << _path;
+                ASSERT_EQ(static_cast<uint64_t>(_s.i), _u.u) << _path;
+            }
+        }
+        else
+        {
+            auto _a = _json.as_double();
+            auto _b = _bin.as_double();
+            if(std::isfinite(_a) || std::isfinite(_b))
+            {
+                ASSERT_NEAR(_a, _b, 1.0e-6 * std::max(1.0, std::fabs(_a))) << _path;
+            }
+        }
+        return;
+    }
+
+    ASSERT_EQ(_json.kind, _bin.kind) << _path;
+    switch(_json.kind)
+    {
+        case value::bool_kind: ASSERT_EQ(_json.b, _bin.b) << _path; break;
+        case value::string_kind: ASSERT_EQ(_json.s, _bin.s) << _path; break;
+        case value::array_kind:
+            ASSERT_EQ(_json.array.size(), _bin.array.size()) << _path;
+            for(size_t i = 0; i < _json.array.size(); ++i)
+                compare(_json.array.at(i), _bin.array.at(i),
+                        _path + "[" + std::to_string(i) + "]");
+            break;
+        case value::object_kind:
+            ASSERT_EQ(_json.object.size(), _bin.object.size()) << _path;
+            for(const auto& itr : _json.object)
+            {
+                ASSERT_EQ(_bin.object.count(itr.first), 1) << _path << "/" << itr.first;
+                compare(itr.second, _bin.object.at(itr.first), _path + "/" + itr.first);
+            }
+            break;
+        default: break;
+    }
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class binary_tests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        static bool configured = false;
+        if(!configured)
+        {
+            configured                   = true;
+            tim::settings::verbose()     = 0;
+            tim::settings::debug()       = false;
+            tim::settings::json_output() = true;
+            tim::settings::mpi_thread()  = false;
+            tim::mpi::initialize(_argc, _argv);
+            tim::timemory_init(_argc, _argv);
+            tim::settings::dart_output() = false;
+            tim::settings::banner()      = false;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(binary_tests, round_trip)
+{
+    auto _name = details::get_test_name();
+
+    // small hierarchy with a distinct number of laps per node
+    for(int i = 0; i < 3; ++i)
+    {
+        toolset_t _outer{ _name + "/outer" };
+        for(int j = 0; j < 2; ++j)
+        {
+            toolset_t _inner{ _name + "/inner" };
+            toolset_t _leaf{ _name + "/leaf" };
+        }
+        toolset_t _other{ _name + "/other" };
+    }
+
+    auto*     _storage = tim::storage<wall_clock>::instance();
+    printer_t _printer{ wall_clock::get_label(), _storage };
+    ASSERT_TRUE(_printer.prepare());
+    auto _results = _printer.get_node_results();
+    ASSERT_FALSE(_results.empty());
+
+    auto _json_fname = tim::settings::compose_output_filename(_name, ".json");
+    auto _bin_fname  = tim::settings::compose_output_filename(_name, ".tmb");
+    _printer.print_json(_json_fname, _results, 1);
+    _printer.print_binary(_bin_fname, _results, 1);
+
+    std::ifstream _json_ifs{ _json_fname };
+    std::ifstream _bin_ifs{ _bin_fname, std::ios::in | std::ios::binary };
+    ASSERT_TRUE(_json_ifs.good()) << _json_fname;
+    ASSERT_TRUE(_bin_ifs.good()) << _bin_fname;
+
+    namespace json = CEREAL_RAPIDJSON_NAMESPACE;
+
+    std::stringstream _json_ss{};
+    _json_ss << _json_ifs.rdbuf();
+    json::Document _doc{};
+    _doc.Parse<json::kParseNanAndInfFlag>(_json_ss.str().c_str());
+    ASSERT_FALSE(_doc.HasParseError()) << _json_fname;
+
+    details::value _json = details::from_json(_doc);
+    details::value _bin  = details::binary_reader{ _bin_ifs }.parse();
+
+    // the entire tree matches the JSON output
+    details::compare(_json, _bin, "");
+
+    // the values, laps and hierarchy match the data which was written
+    const auto& _nodes = _results.at(0);
+    const auto& _graph = _bin["timemory"]["ranks"][0]["graph"];
+    ASSERT_EQ(_graph.array.size(), _nodes.size());
+
+    std::map<std::string, int64_t> _laps = {
+        { "outer", 3 }, { "inner", 6 }, { "leaf", 6 }, { "other", 3 }
+    };
+    std::map<std::string, int64_t> _depth{};
+    for(size_t i = 0; i < _nodes.size(); ++i)
+    {
+        const auto& _node  = _nodes.at(i);
+        const auto& _entry = _graph[i];
+        EXPECT_EQ(_entry["hash"].u, _node.hash());
+        EXPECT_EQ(_entry["prefix"].s, _node.prefix());
+        EXPECT_EQ(_entry["depth"].i, _node.depth());
+        EXPECT_EQ(_entry["entry"]["laps"].i, _node.data().get_laps());
+        EXPECT_EQ(_entry["entry"]["accum"].i, _node.data().get_accum());
+
+        for(const auto& itr : _laps)
+        {
+            if(_node.prefix().find(_name + "/" + itr.first) == std::string::npos)
+                continue;
+            EXPECT_EQ(_node.data().get_laps(), itr.second) << _node.prefix();
+            _depth[itr.first] = _node.depth();
+        }
+    }
+
+    ASSERT_EQ(_depth.size(), _laps.size());
+    EXPECT_EQ(_depth.at("inner"), _depth.at("outer") + 1);
+    EXPECT_EQ(_depth.at("leaf"), _depth.at("inner") + 1);
+    EXPECT_EQ(_depth.at("other"), _depth.at("outer") + 1);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    _argc = argc;
+    _argv = argv;
+
+    auto ret = RUN_ALL_TESTS();
+
+    tim::timemory_finalize();
+    tim::dmp::finalize();
+    return ret;
+}
+
+//--------------------------------------------------------------------------------------//
@@ -0,0 +1,282 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "timemory/timemory.hpp"
+
+#include "timemory/ert/cache.hpp"
+#include "timemory/ert/sweep.hpp"
+
+namespace cache = tim::ert::cache;
+namespace sweep = tim::ert::sweep;
+
+using data_type = tim::ert::exec_data<tim::component::wall_clock>;
+
+static constexpr uint64_t KiB = 1024;
+static constexpr uint64_t MiB = 1024 * KiB;
+static constexpr uint64_t GiB = 1024 * MiB;
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+// the sizes of the L1, L2, and L3 caches
+inline std::array<uint64_t, 3>
+get_sizes()
+{
+    return { { 32 * KiB, 1 * MiB, 32 * MiB } };
+}
+
+// every thread is pinned to the same CPU so all of them are on one socket
+inline tim::topology::int_list_t
+get_one_socket()
+{
+    return { tim::topology::get_cpus().front().cpu };
+}
+
+// the names of the levels
+inline std::vector<std::string>
+get_names(const sweep::level_list_t& _levels)
+{
+    std::vector<std::string> _ret{};
+    for(const auto& itr : _levels)
+        _ret.emplace_back(itr.name);
+    return _ret;
+}
+
+// results with a single ceiling
+inline data_type
+get_data(double _bandwidth)
+{
+    tim::ert::cache_ceiling _ceiling{};
+    _ceiling.level          = "L1";
+    _ceiling.size           = 32 * KiB;
+    _ceiling.working_set    = 16 * KiB;
+    _ceiling.read_bandwidth = _bandwidth;
+
+    data_type _data{};
+    _data.set_ceilings({ _ceiling });
+    return _data;
+}
+
+// moves the timestamp of the cache file of the key back by the given number of hours
+inline void
+set_age(const std::string& _key, double _hours)
+{
+    auto              _fname = cache::get_filename(_key);
+    std::stringstream _ss{};
+    {
+        std::ifstream ifs(_fname);
+        _ss << ifs.rdbuf();
+    }
+    auto        _stamp = cache::get_timestamp() - static_cast<int64_t>(_hours * 3600);
+    std::regex  _re("\"timestamp\": *[0-9]+");
+    std::string _fmt = "\"timestamp\": " + std::to_string(_stamp);
+    std::ofstream ofs(_fname);
+    ofs << std::regex_replace(_ss.str(), _re, _fmt);
+}
+
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class ert_tests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // every test uses an empty cache directory
+        m_dir = tim::get_env<std::string>("TMPDIR", "/tmp") + "/ert_tests-" +
+                std::to_string(tim::process::get_id()) + "-" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        tim::settings::ert_cache()         = true;
+        tim::settings::ert_cache_dir()     = m_dir;
+        tim::settings::ert_cache_max_age() = 168.0;
+    }
+
+    void TearDown() override
+    {
+        for(const auto& itr : m_keys)
+            std::remove(cache::get_filename(itr).c_str());
+        std::remove(m_dir.c_str());
+    }
+
+    std::string get_key(const std::string& _config)
+    {
+        m_keys.emplace_back(cache::get_system_key() + ";" + _config);
+        return m_keys.back();
+    }
+
+    std::string              m_dir  = {};
+    std::vector<std::string> m_keys = {};
+};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, get_levels)
+{
+    auto _cpus   = details::get_one_socket();
+    auto _levels = sweep::get_levels(details::get_sizes(), 8, 1 * GiB, _cpus);
+
+    using names_t = std::vector<std::string>;
+    ASSERT_EQ(details::get_names(_levels), (names_t{ "L1", "L2", "L3", "DRAM" }));
+    EXPECT_EQ(_levels.at(0).share, 32 * KiB);
+    EXPECT_EQ(_levels.at(1).share, 1 * MiB);
+    // the eight threads share the L3 of their socket
+    EXPECT_EQ(_levels.at(2).size, 32 * MiB);
+    EXPECT_EQ(_levels.at(2).share, 4 * MiB);
+    EXPECT_EQ(_levels.at(3).share, 128 * MiB);
+
+    // a single thread (e.g. the latency sweep) has the whole L3
+    auto _single = sweep::get_levels(details::get_sizes(), 1, 1 * GiB, _cpus);
+    ASSERT_EQ(_single.size(), 4);
+    EXPECT_EQ(_single.at(2).share, 32 * MiB);
+    EXPECT_EQ(_single.at(3).share, 1 * GiB);
+
+    // the L3 share of 64 threads on one socket is smaller than the L2
+    auto _crowded = sweep::get_levels(details::get_sizes(), 64, 1 * GiB, _cpus);
+    EXPECT_EQ(details::get_names(_crowded), (names_t{ "L1", "L2", "DRAM" }));
+    EXPECT_EQ(_crowded.back().share, 16 * MiB);
+
+    // unknown levels are skipped
+    auto _unknown = sweep::get_levels({ { 32 * KiB, 0, 0 } }, 1, 1 * GiB, _cpus);
+    EXPECT_EQ(details::get_names(_unknown), (names_t{ "L1", "DRAM" }));
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, get_working_sets)
+{
+    sweep::level_list_t _levels = { { "L1", 32 * KiB, 32 * KiB },
+                                    { "L2", 64 * KiB, 64 * KiB },
+                                    { "DRAM", 1 * GiB, 256 * KiB } };
+
+    // the working set of 1.5x the L1 is 0.75x the L2 and is only measured once
+    std::vector<uint64_t> _expected = { 8 * KiB,  16 * KiB, 24 * KiB, 32 * KiB,
+                                        48 * KiB, 96 * KiB, 256 * KiB };
+    EXPECT_EQ(sweep::get_working_sets(_levels), _expected);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, classify)
+{
+    sweep::level_list_t _levels = { { "L1", 32 * KiB, 32 * KiB },
+                                    { "L2", 1 * MiB, 1 * MiB },
+                                    { "L3", 32 * MiB, 4 * MiB },
+                                    { "DRAM", 1 * GiB, 128 * MiB } };
+
+    EXPECT_EQ(sweep::classify(_levels, 8 * KiB), 0);
+    EXPECT_EQ(sweep::classify(_levels, 512 * KiB), 1);
+    EXPECT_EQ(sweep::classify(_levels, 2 * MiB), 2);
+    EXPECT_EQ(sweep::classify(_levels, 128 * MiB), 3);
+    // too close to the boundary of a level
+    EXPECT_EQ(sweep::classify(_levels, 30 * KiB), -1);
+    // too small for the previous level not to contribute
+    EXPECT_EQ(sweep::classify(_levels, 48 * KiB), -1);
+    EXPECT_EQ(sweep::classify(_levels, 5 * MiB), -1);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, cache_round_trip)
+{
+    auto _key = get_key("round-trip");
+
+    data_type _data{};
+    EXPECT_FALSE(cache::load(_key, _data));
+
+    ASSERT_TRUE(cache::save(_key, details::get_data(1.0e9)));
+    ASSERT_TRUE(cache::load(_key, _data));
+    ASSERT_EQ(_data.get_ceilings().size(), 1);
+    EXPECT_EQ(_data.get_ceilings().front().level, "L1");
+    EXPECT_EQ(_data.get_ceilings().front().size, 32 * KiB);
+    EXPECT_EQ(_data.get_ceilings().front().working_set, 16 * KiB);
+    EXPECT_DOUBLE_EQ(_data.get_ceilings().front().read_bandwidth, 1.0e9);
+
+    // the cache is disabled
+    tim::settings::ert_cache() = false;
+    EXPECT_FALSE(cache::save(_key, details::get_data(2.0e9)));
+    EXPECT_FALSE(cache::load(_key, _data));
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, cache_key_mismatch)
+{
+    auto _key   = get_key("threads=1");
+    auto _other = get_key("threads=2");
+
+    ASSERT_TRUE(cache::save(_key, details::get_data(1.0e9)));
+
+    data_type _data{};
+    EXPECT_FALSE(cache::load(_other, _data));
+
+    // a file whose name collides with the key is rejected by the stored key
+    std::rename(cache::get_filename(_key).c_str(), cache::get_filename(_other).c_str());
+    EXPECT_FALSE(cache::load(_other, _data));
+    EXPECT_TRUE(_data.get_ceilings().empty());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(ert_tests, cache_max_age)
+{
+    auto _key = get_key("max-age");
+
+    ASSERT_TRUE(cache::save(_key, details::get_data(1.0e9)));
+    details::set_age(_key, 200.0);
+
+    data_type _data{};
+    EXPECT_FALSE(cache::load(_key, _data));
+
+    tim::settings::ert_cache_max_age() = 300.0;
+    EXPECT_TRUE(cache::load(_key, _data));
+
+    // the results are never stale
+    tim::settings::ert_cache_max_age() = 0.0;
+    details::set_age(_key, 1.0e4);
+    EXPECT_TRUE(cache::load(_key, _data));
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+//--------------------------------------------------------------------------------------//
@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "timemory/timemory.hpp"
+
+#if defined(_UNIX)
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+using namespace tim::component;
+
+static int    _argc = 0;
+static char** _argv = nullptr;
+
+using toolset_t = tim::auto_tuple<wall_clock>;
+
+TIMEMORY_DECLARE_EXTERN_STORAGE(component::wall_clock, wc)
+TIMEMORY_DECLARE_EXTERN_OPERATIONS(component::wall_clock, true)
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//--------------------------------------------------------------------------------------//
+//  Get the current tests name
+//
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// this function consumes an unknown number of cpu resources
+inline long
+fibonacci(long n)
+{
+    return (n < 2) ? n : (fibonacci(n - 1) + fibonacci(n - 2));
+}
+
+// measures one invocation of fibonacci under the given name
+inline void
+run(const std::string& name)
+{
+    toolset_t t(name, tim::scope::config{ false, false, false });
+    fibonacci(5);
+}
+
+#if defined(_UNIX)
+// sends the request to the socket at the given path and returns the response
+inline std::string
+query(const std::string& _path, const std::string& _request)
+{
+    sockaddr_un _addr{};
+    _addr.sun_family = AF_UNIX;
+    strncpy(_addr.sun_path, _path.c_str(), sizeof(_addr.sun_path) - 1);
+    std::string _response{};
+    int         _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(connect(_fd, reinterpret_cast<sockaddr*>(&_addr), sizeof(_addr)) == 0 &&
+       send(_fd, _request.data(), _request.length(), 0) > 0)
+    {
+        char _buff[1024];
+        for(ssize_t n = 0; (n = recv(_fd, _buff, sizeof(_buff), 0)) > 0;)
+            _response.append(_buff, n);
+    }
+    close(_fd);
+    return _response;
+}
+#endif
+
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class export_tests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        static bool configured = false;
+        if(!configured)
+        {
+            configured                   = true;
+            tim::settings::verbose()     = 0;
+            tim::settings::debug()       = false;
+            tim::settings::json_output() = false;
+            tim::settings::mpi_thread()  = false;
+            tim::mpi::initialize(_argc, _argv);
+            tim::timemory_init(_argc, _argv);
+            tim::settings::dart_output() = false;
+            tim::settings::banner()      = false;
+        }
+    }
+
+    void TearDown() override { tim::metrics_server::instance().stop(); }
+};
+
+//--------------------------------------------------------------------------------------//
+
+#if defined(_UNIX)
+TEST_F(export_tests, first_request)
+{
+    auto  name    = details::get_test_name();
+    auto  fname   = tim::get_env<std::string>("TMPDIR", "/tmp") + "/" + name + "-%p.sock";
+    auto& _server = tim::metrics_server::instance();
+
+    ASSERT_TRUE(_server.start(fname, wall_clock::get_label()));
+    _server.set_timeout(std::chrono::milliseconds{ 10000 });
+
+    // the storage registers its slot when it is initialized while the server runs
+    tim::storage<wall_clock>::instance()->initialize();
+
+    auto        _epoch = tim::metrics_server::epoch();
+    std::string _json{};
+    std::thread _client(
+        [&]() { _json = details::query(_server.get_path(), "json\n"); });
+
+    // the request is received before anything is measured
+    while(tim::metrics_server::epoch() == _epoch)
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+
+    // the first pop after the request publishes the graph
+    details::run(name);
+    _client.join();
+
+    auto _key = "\"epoch\":" + std::to_string(_epoch + 1);
+    EXPECT_NE(_json.find(_key), std::string::npos) << _json;
+    EXPECT_NE(_json.find("\"type\":\"" + wall_clock::get_label()), std::string::npos)
+        << _json;
+    EXPECT_NE(_json.find(name), std::string::npos) << _json;
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(export_tests, list)
+{
+    auto  name    = details::get_test_name();
+    auto  fname   = tim::get_env<std::string>("TMPDIR", "/tmp") + "/" + name + "-%p.sock";
+    auto& _server = tim::metrics_server::instance();
+
+    ASSERT_TRUE(_server.start(fname, wall_clock::get_label()));
+    tim::storage<wall_clock>::instance()->initialize();
+
+    // listing the slots does not wait for a publication
+    EXPECT_EQ(details::query(_server.get_path(), "list\n"),
+              wall_clock::get_label() + "\n");
+    EXPECT_EQ(details::query(_server.get_path(), "xml\n").find("error:"), 0);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(export_tests, path)
+{
+    auto  name    = details::get_test_name();
+    auto  fname   = tim::get_env<std::string>("TMPDIR", "/tmp") + "/" + name + ".sock";
+    auto& _server = tim::metrics_server::instance();
+
+    {
+        std::ofstream ofs(fname);
+        ofs << name << "\n";
+    }
+
+    // an existing file which is not a socket is never removed
+    EXPECT_FALSE(_server.start(fname, wall_clock::get_label()));
+
+    std::string   line{};
+    std::ifstream ifs(fname);
+    std::getline(ifs, line);
+    EXPECT_EQ(line, name);
+
+    std::remove(fname.c_str());
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    _argc = argc;
+    _argv = argv;
+
+    auto ret = RUN_ALL_TESTS();
+
+    tim::timemory_finalize();
+    tim::dmp::finalize();
+    return ret;
+}
+
+//--------------------------------------------------------------------------------------//
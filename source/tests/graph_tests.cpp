@@ -0,0 +1,587 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "timemory/storage/graph.hpp"
+#include "timemory/storage/graph_data.hpp"
+#include "timemory/timemory.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//  Get the current tests name
+//
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+using clock_type    = std::chrono::steady_clock;
+using duration_type = std::chrono::duration<double, std::milli>;
+
+using node_type     = tim::tgraph_node<int64_t>;
+using std_graph_t   = tim::graph<int64_t, std::allocator<node_type>>;
+using arena_graph_t = tim::graph<int64_t, tim::graph_arena_allocator<node_type>>;
+using throughput_t  = std::pair<double, double>;
+
+static int64_t nwidth = 2500;
+static int64_t ndepth = 40;
+
+// builds a call-graph of "nwidth" call-paths which are each "ndepth" deep and
+// returns the time (msec) to build the graph and to traverse it
+template <typename GraphT>
+throughput_t
+build(GraphT& _graph, int64_t& _sum)
+{
+    auto _beg  = clock_type::now();
+    auto _head = _graph.set_head(0);
+    for(int64_t i = 0; i < nwidth; ++i)
+    {
+        auto _itr = _head;
+        for(int64_t j = 0; j < ndepth; ++j)
+            _itr = _graph.append_child(_itr, i * ndepth + j);
+    }
+    auto _mid = clock_type::now();
+    for(auto itr = _graph.begin(); itr != _graph.end(); ++itr)
+        _sum += *itr;
+    auto _end = clock_type::now();
+    return throughput_t{ duration_type(_mid - _beg).count(),
+                         duration_type(_end - _mid).count() };
+}
+
+// minimal node satisfying the parts of the graph_data interface used by the index
+struct id_node
+{
+    int64_t m_id    = 0;
+    int64_t m_depth = 0;
+    int64_t m_count = 1;
+
+    id_node() = default;
+    id_node(int64_t _id, int64_t _depth)
+    : m_id(_id)
+    , m_depth(_depth)
+    {}
+
+    int64_t id() const { return m_id; }
+    int64_t depth() const { return m_depth; }
+
+    bool operator==(const id_node& rhs) const
+    {
+        return (m_id == rhs.m_id && m_depth == rhs.m_depth);
+    }
+};
+
+using id_graph_data_t = tim::graph_data<id_node>;
+using id_iterator_t   = typename id_graph_data_t::iterator;
+using id_sibling_t    = typename id_graph_data_t::sibling_iterator;
+using id_submap_t     = std::unordered_map<int64_t, id_iterator_t>;
+using id_map_t        = std::unordered_map<int64_t, id_submap_t>;
+
+inline int64_t
+get_path_id(int64_t _path, int64_t _depth)
+{
+    return static_cast<int64_t>(std::hash<int64_t>{}(_path * 1000003 + _depth)) ^
+           _depth;
+}
+
+// mirrors the storage lookup prior to the child index: per-depth map lookup which
+// requires the depth to match followed by a scan of the children of current
+inline id_iterator_t
+find_legacy(id_map_t& _ids, id_iterator_t _current, int64_t _id, int64_t _depth)
+{
+    auto& _submap = _ids[_depth];
+    auto  _itr    = _submap.find(_id);
+    if(_itr != _submap.end() && _itr->second->depth() == _current->depth())
+        return _itr->second;
+    for(id_sibling_t itr = _current.begin(); itr != _current.end(); ++itr)
+    {
+        if(itr->id() == _id)
+            return itr;
+    }
+    return id_iterator_t{ nullptr };
+}
+
+// builds "_width" call-paths which are each "_depth" deep
+template <typename DataT, typename MapT>
+void
+build_paths(DataT& _data, MapT& _ids, int64_t _width, int64_t _depth)
+{
+    for(int64_t i = 0; i < _width; ++i)
+    {
+        _data.current() = _data.head();
+        for(int64_t j = 1; j <= _depth; ++j)
+        {
+            id_node _node{ get_path_id(i, j), j };
+            auto    _parent = _data.current();
+            auto    _itr    = _data.emplace_child(_parent, _node);
+            _ids[j][_node.id()] = _itr;
+            _data.cache_child(_itr);
+            _data.current() = _itr;
+        }
+    }
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class graph_tests : public ::testing::Test
+{};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, arena_equivalence)
+{
+    int64_t                _std_sum   = 0;
+    int64_t                _arena_sum = 0;
+    details::std_graph_t   _std;
+    details::arena_graph_t _arena;
+    details::build(_std, _std_sum);
+    details::build(_arena, _arena_sum);
+
+    EXPECT_EQ(_std.size(), _arena.size());
+    EXPECT_EQ(_std_sum, _arena_sum);
+
+    auto sitr = _std.begin();
+    auto aitr = _arena.begin();
+    for(; sitr != _std.end() && aitr != _arena.end(); ++sitr, ++aitr)
+    {
+        ASSERT_EQ(*sitr, *aitr);
+        ASSERT_EQ(_std.depth(sitr), _arena.depth(aitr));
+    }
+    EXPECT_TRUE(sitr == _std.end());
+    EXPECT_TRUE(aitr == _arena.end());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, arena_reuse)
+{
+    int64_t                _sum = 0;
+    details::arena_graph_t _graph;
+    details::build(_graph, _sum);
+
+    // copies of the allocator share the arena
+    auto _alloc = _graph.get_allocator();
+
+    auto _nodes = _alloc.size();
+    auto _bytes = _alloc.alloc_bytes();
+    EXPECT_GE(_nodes, details::nwidth * details::ndepth);
+    EXPECT_GT(_bytes, 0);
+
+    // erasing the nodes returns them to the arena which recycles them
+    _graph.clear();
+    EXPECT_LT(_alloc.size(), _nodes);
+    details::build(_graph, _sum);
+    EXPECT_EQ(_alloc.size(), _nodes);
+    EXPECT_EQ(_alloc.alloc_bytes(), _bytes);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, arena_trim)
+{
+    using arena_data_t =
+        tim::graph_data<details::id_node,
+                        tim::graph_arena_allocator<tim::tgraph_node<details::id_node>>>;
+
+    using arena_map_t = std::unordered_map<
+        int64_t, std::unordered_map<int64_t, typename arena_data_t::iterator>>;
+
+    arena_data_t _data{ details::id_node{}, 0 };
+    auto         _alloc = _data.graph().get_allocator();
+
+    // repeated build/reset cycles release the chunks of the erased nodes
+    size_t _peak  = 0;
+    size_t _bytes = 0;
+    for(int64_t i = 0; i < 4; ++i)
+    {
+        arena_map_t _ids{};
+        details::build_paths(_data, _ids, details::nwidth / 10, details::ndepth);
+        if(i == 0)
+            _peak = _alloc.alloc_bytes();
+        EXPECT_EQ(_alloc.alloc_bytes(), _peak);
+        _data.reset();
+        // only the head node and the sentinels of the graph remain
+        EXPECT_EQ(_alloc.size(), 3);
+        EXPECT_LT(_alloc.alloc_bytes(), _peak);
+        if(i == 0)
+            _bytes = _alloc.alloc_bytes();
+        EXPECT_EQ(_alloc.alloc_bytes(), _bytes);
+    }
+
+    _data.clear();
+    EXPECT_EQ(_alloc.size(), 2);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, arena_move)
+{
+    int64_t                _sum = 0;
+    details::arena_graph_t _graph;
+    details::build(_graph, _sum);
+    auto _size = _graph.size();
+
+    // move-construction shares the arena
+    details::arena_graph_t _moved(std::move(_graph));
+    EXPECT_EQ(_moved.size(), _size);
+    EXPECT_EQ(_graph.size(), 0);
+
+    // move-assignment between different arenas copies
+    details::arena_graph_t _assigned;
+    _assigned = std::move(_moved);
+    EXPECT_EQ(_assigned.size(), _size);
+    EXPECT_EQ(_moved.size(), 0);
+
+    int64_t _check = 0;
+    for(auto itr = _assigned.begin(); itr != _assigned.end(); ++itr)
+        _check += *itr;
+    EXPECT_EQ(_check, _sum);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, throughput)
+{
+    int64_t _std_sum   = 0;
+    int64_t _arena_sum = 0;
+
+    details::throughput_t _std_time{ 0.0, 0.0 };
+    details::throughput_t _arena_time{ 0.0, 0.0 };
+    for(int i = 0; i < 5; ++i)
+    {
+        details::std_graph_t   _std;
+        details::arena_graph_t _arena;
+        auto                   _std_t   = details::build(_std, _std_sum);
+        auto                   _arena_t = details::build(_arena, _arena_sum);
+        _std_time.first += _std_t.first;
+        _std_time.second += _std_t.second;
+        _arena_time.first += _arena_t.first;
+        _arena_time.second += _arena_t.second;
+    }
+
+    auto _nodes = 5 * details::nwidth * details::ndepth;
+    auto _print = [_nodes](const std::string& _label, const details::throughput_t& _t) {
+        std::cout << "[" << details::get_test_name() << "]> " << std::setw(12)
+                  << _label << " :: insert = " << std::setw(10) << std::setprecision(3)
+                  << std::fixed << (_nodes / _t.first) << " nodes/msec, traverse = "
+                  << std::setw(10) << (_nodes / _t.second) << " nodes/msec"
+                  << std::endl;
+    };
+
+    _print("std", _std_time);
+    _print("arena", _arena_time);
+    EXPECT_EQ(_std_sum, _arena_sum);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, child_index)
+{
+    using index_t = tim::graph_child_index<details::id_iterator_t>;
+
+    int64_t                  _width = 300;
+    int64_t                  _depth = 8;
+    details::id_map_t        _ids;
+    details::id_graph_data_t _data(details::id_node{}, 0);
+    details::build_paths(_data, _ids, _width, _depth);
+
+    // every cached entry agrees with the reference lookup
+    for(int64_t i = 0; i < _width; ++i)
+    {
+        auto _current = _data.head();
+        for(int64_t j = 1; j <= _depth; ++j)
+        {
+            auto _id     = details::get_path_id(i, j);
+            auto _cached = _data.find_child(_current, _id);
+            auto _legacy = details::find_legacy(_ids, _current, _id, j);
+            ASSERT_TRUE(_cached);
+            ASSERT_TRUE(_cached == _legacy);
+            ASSERT_EQ(_cached->id(), _id);
+            _current = _cached;
+        }
+        // a child that was never inserted is not found
+        EXPECT_FALSE(_data.find_child(_current, details::get_path_id(i, 0)));
+    }
+
+    // entries are keyed on the actual parent of the child, whatever the caller
+    // considers the current node to be
+    {
+        auto _child  = _data.find_child(_data.head(), details::get_path_id(0, 1));
+        auto _grand  = _data.find_child(_child, details::get_path_id(0, 2));
+        auto _nested = _data.emplace_child(_grand, *_child);
+        _data.cache_child(_nested);
+        EXPECT_TRUE(_data.find_child(_grand, _child->id()) == _nested);
+        EXPECT_TRUE(_data.find_child(_data.head(), _child->id()) == _child);
+        EXPECT_FALSE(_data.find_child(_child, _child->id()));
+    }
+
+    // resetting the graph drops every cached iterator
+    _data.reset();
+    EXPECT_FALSE(_data.find_child(_data.head(), details::get_path_id(0, 1)));
+
+    // overwrite + growth
+    index_t _index;
+    int     _dummy[2] = { 0, 0 };
+    for(int64_t i = 0; i < 1000; ++i)
+        _index.insert(&_dummy[i % 2], i, details::id_iterator_t{ nullptr });
+    EXPECT_EQ(_index.size(), 1000);
+    EXPECT_GE(_index.capacity(), 2 * _index.size());
+    _index.insert(&_dummy[0], 0, _data.head());
+    EXPECT_EQ(_index.size(), 1000);
+    EXPECT_TRUE(_index.find(&_dummy[0], 0) == _data.head());
+    EXPECT_FALSE(_index.find(&_dummy[1], 0));
+    _index.clear();
+    EXPECT_TRUE(_index.empty());
+    EXPECT_FALSE(_index.find(&_dummy[0], 0));
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, child_index_insert_cost)
+{
+    // re-enter every call-path of a tree of the given width and depth "nrepeat"
+    // times and report the cost per node lookup
+    const int64_t nrepeat = 20;
+    int64_t       _nerr   = 0;
+
+    std::cout << "[" << details::get_test_name() << "]> " << std::setw(8) << "width"
+              << std::setw(8) << "depth" << std::setw(16) << "legacy (ns)"
+              << std::setw(16) << "index (ns)" << std::endl;
+
+    for(int64_t _width : { 4, 32, 256, 2048 })
+    {
+        for(int64_t _depth : { 4, 16, 64 })
+        {
+            details::id_map_t        _ids;
+            details::id_graph_data_t _data(details::id_node{}, 0);
+            details::build_paths(_data, _ids, _width, _depth);
+
+            auto _run = [&](auto&& _func) {
+                auto _beg = details::clock_type::now();
+                for(int64_t r = 0; r < nrepeat; ++r)
+                {
+                    for(int64_t i = 0; i < _width; ++i)
+                    {
+                        auto _current = _data.head();
+                        for(int64_t j = 1; j <= _depth; ++j)
+                        {
+                            auto _itr = _func(_current, details::get_path_id(i, j), j);
+                            if(!_itr)
+                            {
+                                ++_nerr;
+                                break;
+                            }
+                            _current = _itr;
+                        }
+                    }
+                }
+                auto _end = details::clock_type::now();
+                return std::chrono::duration<double, std::nano>(_end - _beg).count() /
+                       (nrepeat * _width * _depth);
+            };
+
+            auto _legacy = _run([&](details::id_iterator_t _current, int64_t _id,
+                                    int64_t _lvl) {
+                return details::find_legacy(_ids, _current, _id, _lvl);
+            });
+            auto _index  = _run([&](details::id_iterator_t _current, int64_t _id,
+                                   int64_t) { return _data.find_child(_current, _id); });
+
+            std::cout << "[" << details::get_test_name() << "]> " << std::setw(8)
+                      << _width << std::setw(8) << _depth << std::setw(16)
+                      << std::setprecision(2) << std::fixed << _legacy << std::setw(16)
+                      << _index << std::endl;
+        }
+    }
+
+    EXPECT_EQ(_nerr, 0);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, combine)
+{
+    using data_ptr_t = std::unique_ptr<details::id_graph_data_t>;
+
+    // workers 0-5 forked from the same master node, workers 6-7 from another
+    const int64_t           nworkers = 8;
+    const int64_t           nwidth   = 10;
+    const int64_t           ndepth   = 5;
+    std::vector<data_ptr_t> _workers;
+    for(int64_t i = 0; i < nworkers; ++i)
+    {
+        details::id_node  _fork{ (i < 6) ? 100 : 200, 2 };
+        details::id_map_t _ids;
+        _workers.emplace_back(new details::id_graph_data_t(_fork, 2));
+        details::build_paths(*_workers.back(), _ids, nwidth, ndepth);
+    }
+
+    // pairwise tree-reduction
+    int64_t _grafted = 0;
+    for(size_t _stride = 1; _stride < _workers.size(); _stride *= 2)
+    {
+        for(size_t i = 0; i + _stride < _workers.size(); i += 2 * _stride)
+        {
+            _grafted += _workers.at(i)->combine(*_workers.at(i + _stride));
+            EXPECT_FALSE(_workers.at(i + _stride)->has_head());
+        }
+    }
+
+    // each of the log2(8) = 3 levels grafts half of the subgraphs and the bookmarks
+    // for the two fork points are preserved
+    auto& _combined = *_workers.front();
+    EXPECT_EQ(_grafted, 3 * (nworkers / 2) * nwidth);
+    EXPECT_EQ(_combined.dummy_count(), 2);
+    EXPECT_EQ(_combined.graph().size(), 2 + nworkers * nwidth * ndepth);
+
+    auto _inverse = _combined.get_inverse_insert();
+    for(const auto& itr : _inverse)
+    {
+        auto _expected = (itr.second->id() == 100) ? 6 : 2;
+        EXPECT_EQ(_combined.graph().number_of_children(itr.second), _expected * nwidth);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, combine_reduce)
+{
+    using data_ptr_t = std::unique_ptr<details::id_graph_data_t>;
+
+    // workers 0-5 forked from the same master node, workers 6-7 from another
+    const int64_t           nworkers = 8;
+    const int64_t           nwidth   = 10;
+    const int64_t           ndepth   = 5;
+    std::vector<data_ptr_t> _workers;
+    for(int64_t i = 0; i < nworkers; ++i)
+    {
+        details::id_node  _fork{ (i < 6) ? 100 : 200, 2 };
+        details::id_map_t _ids;
+        _workers.emplace_back(new details::id_graph_data_t(_fork, 2));
+        details::build_paths(*_workers.back(), _ids, nwidth, ndepth);
+    }
+
+    auto _reduce = [](details::id_node& _lhs, const details::id_node& _rhs) {
+        _lhs.m_count += _rhs.m_count;
+        return true;
+    };
+
+    int64_t _combined_n = 0;
+    for(size_t _stride = 1; _stride < _workers.size(); _stride *= 2)
+    {
+        for(size_t i = 0; i + _stride < _workers.size(); i += 2 * _stride)
+            _combined_n += _workers.at(i)->combine(*_workers.at(i + _stride), _reduce);
+    }
+
+    // every node of a graph with the same fork point is combined and the subgraphs
+    // of the other fork point are copied once at the second and third level
+    auto& _combined = *_workers.front();
+    EXPECT_EQ(_combined_n, 6 * nwidth * ndepth + 2 * nwidth);
+    EXPECT_EQ(_combined.dummy_count(), 2);
+    EXPECT_EQ(_combined.graph().size(), 2 + 2 * nwidth * ndepth);
+
+    for(const auto& itr : _combined.get_inverse_insert())
+    {
+        auto _expected = (itr.second->id() == 100) ? 6 : 2;
+        EXPECT_EQ(_combined.graph().number_of_children(itr.second), nwidth);
+        int64_t                                    _n = 0;
+        std::function<void(details::id_sibling_t)> _check;
+        _check = [&](details::id_sibling_t _parent) {
+            for(auto nitr = _parent.begin(); nitr != _parent.end(); ++nitr, ++_n)
+            {
+                EXPECT_EQ(nitr->m_count, _expected) << "id = " << nitr->id();
+                _check(nitr);
+            }
+        };
+        _check(itr.second);
+        EXPECT_EQ(_n, nwidth * ndepth);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(graph_tests, background_merger)
+{
+    using merger_t   = tim::graph_data_merger<details::id_graph_data_t>;
+    using data_ptr_t = typename merger_t::pointer;
+
+    const int64_t nthreads = 4;
+    const int64_t nhandoff = 25;
+    const int64_t nwidth   = 4;
+    const int64_t ndepth   = 3;
+
+    merger_t _merger;
+    auto     _run = [&]() {
+        for(int64_t i = 0; i < nhandoff; ++i)
+        {
+            details::id_node  _fork{ 100, 1 };
+            details::id_map_t _ids;
+            data_ptr_t        _data{ new details::id_graph_data_t(_fork, 1) };
+            details::build_paths(*_data, _ids, nwidth, ndepth);
+            _merger.push(std::move(_data));
+        }
+    };
+
+    std::vector<std::thread> _threads;
+    for(int64_t i = 0; i < nthreads; ++i)
+        _threads.emplace_back(_run);
+    for(auto& itr : _threads)
+        itr.join();
+
+    auto _staged = _merger.release();
+    ASSERT_TRUE(_staged != nullptr);
+    EXPECT_EQ(_staged->dummy_count(), 1);
+    EXPECT_EQ(_staged->graph().size(), 1 + nthreads * nhandoff * nwidth * ndepth);
+
+    // the merger can be reused after it has been released
+    _run();
+    _staged = _merger.release();
+    ASSERT_TRUE(_staged != nullptr);
+    EXPECT_EQ(_staged->graph().size(), 1 + nhandoff * nwidth * ndepth);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+//--------------------------------------------------------------------------------------//
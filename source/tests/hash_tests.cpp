@@ -0,0 +1,191 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "timemory/timemory.hpp"
+
+using steady_clock_t = std::chrono::steady_clock;
+
+static const size_t nthreads = 8;
+static const size_t nids     = 100000;
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//  Get the current tests name
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// average time in microseconds to create and join a thread which executes func
+template <typename FuncT>
+double
+spin_up(size_t nthreads, FuncT&& func)
+{
+    auto _beg = steady_clock_t::now();
+    for(size_t i = 0; i < nthreads; ++i)
+        std::thread(func).join();
+    auto _end = steady_clock_t::now();
+    return std::chrono::duration<double, std::micro>(_end - _beg).count() / nthreads;
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class hash_tests : public ::testing::Test
+{};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(hash_tests, registry)
+{
+    tim::hash::registry<size_t, std::string, 4> _reg;
+
+    EXPECT_TRUE(_reg.empty());
+    EXPECT_TRUE(_reg.begin() == _reg.end());
+
+    for(size_t i = 0; i < 1000; ++i)
+        EXPECT_TRUE(_reg.emplace(i, std::to_string(i)).second);
+
+    // existing entries are never replaced
+    auto _ret = _reg.insert({ 10, "ten" });
+    EXPECT_FALSE(_ret.second);
+    EXPECT_EQ(_ret.first->second, std::string("10"));
+
+    EXPECT_EQ(_reg.size(), 1000);
+    EXPECT_EQ(_reg.count(999), 1);
+    EXPECT_EQ(_reg.count(1000), 0);
+    EXPECT_EQ(_reg.at(500), std::string("500"));
+    EXPECT_THROW(_reg.at(1000), std::out_of_range);
+
+    size_t _n = 0;
+    for(const auto& itr : _reg)
+    {
+        EXPECT_EQ(itr.second, std::to_string(itr.first));
+        ++_n;
+    }
+    EXPECT_EQ(_n, _reg.size());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(hash_tests, concurrent_insert)
+{
+    tim::hash::registry<size_t, std::string> _reg;
+
+    // overlapping ranges so that threads race to insert the same keys
+    auto _insert = [&_reg](size_t _offset) {
+        for(size_t i = 0; i < nids / 10; ++i)
+        {
+            auto _key = _offset + i;
+            _reg.emplace(_key, std::to_string(_key));
+            auto itr = _reg.find(_key);
+            ASSERT_TRUE(itr != _reg.end());
+            EXPECT_EQ(itr->second, std::to_string(_key));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < nthreads; ++i)
+        threads.emplace_back(_insert, (i / 2) * (nids / 20));
+    for(auto& itr : threads)
+        itr.join();
+
+    size_t _expected = (nthreads / 2 - 1) * (nids / 20) + (nids / 10);
+    EXPECT_EQ(_reg.size(), _expected);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(hash_tests, shared_across_threads)
+{
+    auto _name = details::get_test_name();
+    auto _hash = tim::add_hash_id(_name);
+
+    std::string _worker = {};
+    std::thread([&]() { _worker = tim::get_hash_identifier(_hash); }).join();
+    EXPECT_EQ(_worker, _name);
+
+    // registered on a worker thread is visible on the main thread
+    tim::hash_result_type _other = 0;
+    std::thread([&]() { _other = tim::add_hash_id(_name + "/worker"); }).join();
+    EXPECT_EQ(tim::get_hash_identifier(_other), _name + "/worker");
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(hash_tests, thread_spin_up)
+{
+    auto _name = details::get_test_name();
+    for(size_t i = 0; i < nids; ++i)
+        tim::add_hash_id(_name + "/" + std::to_string(i));
+    EXPECT_GE(tim::get_hash_ids()->size(), nids);
+
+    auto _hash = tim::get_hash_id(_name + "/" + std::to_string(nids / 2));
+
+    // previous behavior: each new thread received a copy of the table
+    std::unordered_map<tim::hash_result_type, std::string> _copy(
+        tim::get_hash_ids()->begin(), tim::get_hash_ids()->end());
+    auto _copy_time = details::spin_up(nthreads, [&]() {
+        auto _local = _copy;
+        EXPECT_EQ(_local.count(_hash), 1);
+    });
+
+    auto _shared_time = details::spin_up(nthreads, [&]() {
+        EXPECT_EQ(tim::get_hash_ids()->count(_hash), 1);
+    });
+
+    auto _empty_time = details::spin_up(nthreads, []() {});
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "[" << _name << "]> thread spin-up with " << tim::get_hash_ids()->size()
+              << " hash ids:\n";
+    std::cout << "    empty thread      : " << std::setw(10) << _empty_time << " usec\n";
+    std::cout << "    copy of hash ids  : " << std::setw(10) << _copy_time << " usec\n";
+    std::cout << "    shared hash ids   : " << std::setw(10) << _shared_time << " usec\n";
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+//--------------------------------------------------------------------------------------//
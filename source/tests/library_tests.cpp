@@ -26,6 +26,7 @@
 
 #include "timemory/compat/timemory_c.h"
 #include "timemory/library.h"
+#include "timemory/settings.hpp"
 
 #include <chrono>
 #include <condition_variable>
@@ -420,6 +421,159 @@ TEST_F(library_tests, region)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(library_tests, region_id)
+{
+    printf("TEST_NAME: %s\n", details::get_test_name().c_str());
+
+    auto id = timemory_get_region_id(TEST_NAME);
+    ASSERT_EQ(id, timemory_get_region_id(TEST_NAME));
+    ASSERT_NE(id, timemory_get_region_id(details::get_test_name().c_str()));
+
+    timemory_push_region_id(id);
+    ret += details::fibonacci(35);
+
+    timemory_push_region_id(id);
+    ret += details::fibonacci(35);
+
+    timemory_pop_region_id(id);
+    timemory_pop_region_id(id);
+
+    // records are re-used so repeated calls do not add entries
+    for(int i = 0; i < 10; ++i)
+    {
+        timemory_push_region_id(id);
+        ret += details::fibonacci(20);
+        timemory_pop_region_id(id);
+    }
+
+    printf("fibonacci(35) = %li\n\n", ret);
+
+    auto wc_n = wc_size_orig + 2;
+    auto cu_n = cu_size_orig + 2;
+    auto cc_n = cc_size_orig + 2;
+    auto pr_n = pr_size_orig + 2;
+
+    ASSERT_EQ(get_wc_storage_size(), wc_n);
+    ASSERT_EQ(get_cu_storage_size(), cu_n);
+    ASSERT_EQ(get_cc_storage_size(), cc_n);
+    ASSERT_EQ(get_pr_storage_size(), pr_n);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(library_tests, region_id_batch)
+{
+    printf("TEST_NAME: %s\n", details::get_test_name().c_str());
+
+    auto _batch                        = tim::settings::region_batch_size();
+    tim::settings::region_batch_size() = 4;
+
+    auto id = timemory_get_region_id(TEST_NAME);
+    for(int i = 0; i < 3; ++i)
+    {
+        timemory_push_region_id(id);
+        ret += details::fibonacci(20);
+        timemory_pop_region_id(id);
+    }
+
+    // nothing is inserted until the batch is full
+    ASSERT_EQ(get_wc_storage_size(), wc_size_orig);
+    ASSERT_EQ(get_cu_storage_size(), cu_size_orig);
+
+    timemory_push_region_id(id);
+    ret += details::fibonacci(20);
+    timemory_pop_region_id(id);
+
+    tim::settings::region_batch_size() = _batch;
+
+    printf("fibonacci(20) = %li\n\n", ret);
+
+    ASSERT_EQ(get_wc_storage_size(), wc_size_orig + 1);
+    ASSERT_EQ(get_cu_storage_size(), cu_size_orig + 1);
+    ASSERT_EQ(get_cc_storage_size(), cc_size_orig + 1);
+    ASSERT_EQ(get_pr_storage_size(), pr_size_orig + 1);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(library_tests, region_id_batch_thread)
+{
+    printf("TEST_NAME: %s\n", details::get_test_name().c_str());
+
+    auto _batch                        = tim::settings::region_batch_size();
+    tim::settings::region_batch_size() = 4;
+
+    auto id   = timemory_get_region_id(TEST_NAME);
+    long _ret = 0;
+
+    // the batch is never filled on the thread so the laps are only inserted into
+    // storage when the thread exits
+    std::thread _thread{ [id, &_ret]() {
+        for(int i = 0; i < 3; ++i)
+        {
+            timemory_push_region_id(id);
+            _ret += details::fibonacci(20);
+            timemory_pop_region_id(id);
+        }
+    } };
+    _thread.join();
+
+    tim::settings::region_batch_size() = _batch;
+    ret += _ret;
+
+    printf("fibonacci(20) = %li\n\n", ret);
+
+    ASSERT_GT(get_wc_storage_size(), wc_size_orig);
+    ASSERT_GT(get_cu_storage_size(), cu_size_orig);
+    ASSERT_GT(get_cc_storage_size(), cc_size_orig);
+    ASSERT_GT(get_pr_storage_size(), pr_size_orig);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(library_tests, settings_toggle)
+{
+    printf("TEST_NAME: %s\n", details::get_test_name().c_str());
+
+    auto id = timemory_get_region_id(TEST_NAME);
+
+    // enabling the settings directly after a pause re-enables the markers
+    timemory_pause();
+    tim::settings::enabled() = true;
+
+    timemory_push_region(TEST_NAME);
+    ret += details::fibonacci(20);
+    timemory_pop_region(TEST_NAME);
+
+    timemory_push_region_id(id);
+    ret += details::fibonacci(20);
+    timemory_pop_region_id(id);
+
+    ASSERT_EQ(get_wc_storage_size(), wc_size_orig + 2);
+    ASSERT_EQ(get_cu_storage_size(), cu_size_orig + 2);
+
+    // disabling the settings directly disables the markers
+    tim::settings::enabled() = false;
+
+    timemory_push_region("disabled");
+    ret += details::fibonacci(20);
+    timemory_pop_region("disabled");
+
+    uint64_t _record = 0;
+    timemory_begin_record("disabled", &_record);
+    timemory_end_record(_record);
+
+    tim::settings::enabled() = true;
+
+    printf("fibonacci(20) = %li\n\n", ret);
+
+    ASSERT_EQ(_record, std::numeric_limits<uint64_t>::max());
+    ASSERT_EQ(get_wc_storage_size(), wc_size_orig + 2);
+    ASSERT_EQ(get_cu_storage_size(), cu_size_orig + 2);
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(library_tests, add)
 {
     timemory_push_components("wall_clock, cpu_util");
@@ -232,6 +232,46 @@ TEST_F(macro_tests, marker_auto_type)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(macro_tests, constexpr_blank_marker)
+{
+    static_assert(TIMEMORY_HASH_LITERAL("constexpr_blank_marker") != 0,
+                  "hash of string literal must be computed at compile-time");
+
+    TIMEMORY_CONSTEXPR_BLANK_MARKER(auto_tuple_t, "constexpr_blank_marker");
+    details::do_sleep(25);
+    timemory_variable_240.stop();
+
+    EXPECT_EQ(timemory_variable_240.hash(), tim::get_hash_id(details::get_test_name()));
+    EXPECT_EQ(timemory_variable_240.key(), details::get_test_name());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(macro_tests, constexpr_basic_marker)
+{
+    TIMEMORY_CONSTEXPR_BASIC_MARKER(auto_tuple_t, "constexpr_basic_marker");
+    details::do_sleep(25);
+    timemory_variable_252.stop();
+
+    std::stringstream expected;
+    expected << __FUNCTION__ << "/" << details::get_test_name();
+    EXPECT_EQ(timemory_variable_252.hash(), tim::get_hash_id(expected.str()));
+    EXPECT_EQ(timemory_variable_252.key(), expected.str());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(macro_tests, hash_collision)
+{
+    auto _hash = tim::get_hash_id(details::get_test_name());
+    EXPECT_EQ(tim::add_hash_id(_hash, details::get_test_name().c_str()), _hash);
+    // a different label with an existing hash does not replace the original label
+    EXPECT_EQ(tim::add_hash_id(_hash, "hash_collision_alias"), _hash);
+    EXPECT_EQ(tim::get_hash_ids()->at(_hash), details::get_test_name());
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
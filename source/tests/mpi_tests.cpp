@@ -31,6 +31,7 @@
 #include <future>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <random>
 #include <thread>
 #include <unordered_map>
@@ -380,6 +381,127 @@ TEST_F(mpi_tests, per_thread)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(mpi_tests, collapse_processes)
+{
+    using tuple_t = tim::auto_tuple_t<trip_count>;
+
+    auto mpi_rank = tim::mpi::rank();
+    auto mpi_size = tim::mpi::size();
+    auto name     = details::get_test_name();
+    auto nwidth   = 8;
+
+    {
+        TIMEMORY_BLANK_MARKER(tuple_t, name);
+        for(int i = 0; i < nwidth; ++i)
+        {
+            // each rank has a different number of laps for each label
+            for(int j = 0; j <= mpi_rank; ++j)
+            {
+                TIMEMORY_BLANK_MARKER(tuple_t, name, "/", i);
+            }
+        }
+    }
+
+    auto _get_laps = [&](const auto& _result) {
+        std::map<std::string, int64_t> _laps;
+        for(const auto& itr : _result)
+        {
+            if(itr.prefix().find(name + "/") != std::string::npos)
+                _laps[itr.prefix()] += itr.data().get_laps();
+        }
+        return _laps;
+    };
+
+    auto _collapse = tim::settings::collapse_processes();
+
+    tim::settings::collapse_processes() = false;
+    auto rc_storage = tim::storage<trip_count>::instance()->mpi_get();
+
+    tim::settings::collapse_processes() = true;
+    auto cc_storage = tim::storage<trip_count>::instance()->mpi_get();
+
+    tim::settings::collapse_processes() = _collapse;
+
+    if(mpi_rank == 0)
+    {
+        EXPECT_EQ(rc_storage.size(), mpi_size);
+        EXPECT_EQ(cc_storage.size(), 1);
+
+        for(int i = 0; i < mpi_size; ++i)
+        {
+            auto _laps = _get_laps(rc_storage.at(i));
+            EXPECT_EQ(_laps.size(), nwidth) << " rank " << i;
+            for(const auto& itr : _laps)
+                EXPECT_EQ(itr.second, i + 1) << " rank " << i << " " << itr.first;
+        }
+
+        auto _laps = _get_laps(cc_storage.front());
+        EXPECT_EQ(_laps.size(), nwidth);
+        for(const auto& itr : _laps)
+            EXPECT_EQ(itr.second, mpi_size * (mpi_size + 1) / 2) << " " << itr.first;
+    }
+    else
+    {
+        EXPECT_EQ(rc_storage.size(), 1);
+        EXPECT_EQ(cc_storage.size(), 1);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  run with e.g. "mpirun --oversubscribe -np 64 ./mpi_tests
+//  --gtest_filter=mpi_tests.gather_scaling" to measure the scaling of the reduction
+//
+TEST_F(mpi_tests, gather_scaling)
+{
+    using tuple_t = tim::auto_tuple_t<trip_count>;
+
+    auto mpi_rank = tim::mpi::rank();
+    auto mpi_size = tim::mpi::size();
+    auto name     = details::get_test_name();
+
+    auto _collapse = tim::settings::collapse_processes();
+    if(mpi_rank == 0)
+        printf("\n%8s | %8s | %12s | %12s\n", "ranks", "records", "gather (s)",
+               "collapse (s)");
+
+    for(int nwidth : { 64, 512, 4096 })
+    {
+        {
+            TIMEMORY_BLANK_MARKER(tuple_t, name, "/", nwidth);
+            for(int i = 0; i < nwidth; ++i)
+            {
+                TIMEMORY_BLANK_MARKER(tuple_t, name, "/", nwidth, "/", i);
+            }
+        }
+
+        auto _nrecords = tim::storage<trip_count>::instance()->get().size();
+
+        tim::mpi::barrier();
+        tim::settings::collapse_processes() = false;
+        auto _beg                           = std::chrono::steady_clock::now();
+        auto rc_storage = tim::storage<trip_count>::instance()->mpi_get();
+        auto _mid       = std::chrono::steady_clock::now();
+        tim::settings::collapse_processes() = true;
+        auto cc_storage = tim::storage<trip_count>::instance()->mpi_get();
+        auto _end       = std::chrono::steady_clock::now();
+
+        using duration_t = std::chrono::duration<double>;
+        if(mpi_rank == 0)
+        {
+            EXPECT_EQ(rc_storage.size(), mpi_size);
+            EXPECT_EQ(cc_storage.size(), 1);
+            EXPECT_EQ(cc_storage.front().size(), _nrecords);
+            printf("%8i | %8i | %12.6f | %12.6f\n", (int) mpi_size, (int) _nrecords,
+                   duration_t(_mid - _beg).count(), duration_t(_end - _mid).count());
+        }
+    }
+
+    tim::settings::collapse_processes() = _collapse;
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
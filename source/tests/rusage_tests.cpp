@@ -28,6 +28,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <random>
 #include <thread>
@@ -293,6 +294,43 @@ TEST_F(rusage_tests, current_peak_rss)
 
 //--------------------------------------------------------------------------------------//
 
+#if defined(_LINUX)
+TEST_F(rusage_tests, proc_file_reuse)
+{
+    auto& _statm = tim::proc_file::statm();
+
+    // a long window so that the reuse is deterministic
+    auto _window                   = tim::proc_file::reuse_window();
+    tim::proc_file::reuse_window() = std::numeric_limits<int64_t>::max() / 2;
+
+    // the first request re-reads (field previously used), the others share the read
+    tim::get_page_rss();
+    auto _beg = _statm.reads();
+    auto _vm  = tim::get_virt_mem();
+    auto _rss = tim::get_page_rss();
+    auto _drs = tim::get_data_rss();
+    EXPECT_EQ(_statm.reads(), _beg + 1);
+    EXPECT_GT(_vm, 0);
+    EXPECT_GT(_rss, 0);
+    EXPECT_GE(_vm, _rss);
+    EXPECT_GE(_vm, _drs);
+
+    // requesting the same field again is a new sample
+    EXPECT_GT(tim::get_page_rss(), 0);
+    EXPECT_EQ(_statm.reads(), _beg + 2);
+
+    // without a window, every request is a new sample
+    tim::proc_file::reuse_window() = -1;
+    tim::get_virt_mem();
+    tim::get_page_rss();
+    EXPECT_EQ(_statm.reads(), _beg + 4);
+
+    tim::proc_file::reuse_window() = _window;
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
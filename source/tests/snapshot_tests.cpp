@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "timemory/timemory.hpp"
+
+using namespace tim::component;
+
+static int    _argc = 0;
+static char** _argv = nullptr;
+
+using toolset_t = tim::auto_tuple<wall_clock>;
+
+TIMEMORY_DECLARE_EXTERN_STORAGE(component::wall_clock, wc)
+TIMEMORY_DECLARE_EXTERN_OPERATIONS(component::wall_clock, true)
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//--------------------------------------------------------------------------------------//
+//  Get the current tests name
+//
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// this function consumes an unknown number of cpu resources
+inline long
+fibonacci(long n)
+{
+    return (n < 2) ? n : (fibonacci(n - 1) + fibonacci(n - 2));
+}
+
+// measures "n" invocations of fibonacci under the given name
+inline void
+run(const std::string& name, long n)
+{
+    for(long i = 0; i < n; ++i)
+    {
+        toolset_t t(name, tim::scope::config{ false, false, false });
+        fibonacci(5);
+    }
+}
+
+// reads the lines of the snapshot file
+inline std::vector<std::string>
+read_snapshots()
+{
+    auto fname = tim::settings::compose_output_filename(
+        wall_clock::get_label() + ".snapshot", ".jsonl");
+    std::vector<std::string> lines;
+    std::ifstream            ifs(fname);
+    for(std::string line; std::getline(ifs, line);)
+        lines.emplace_back(line);
+    return lines;
+}
+
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class snapshot_tests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        static bool configured = false;
+        if(!configured)
+        {
+            configured                   = true;
+            tim::settings::verbose()     = 0;
+            tim::settings::debug()       = false;
+            tim::settings::json_output() = true;
+            tim::settings::mpi_thread()  = false;
+            tim::mpi::initialize(_argc, _argv);
+            tim::timemory_init(_argc, _argv);
+            tim::settings::dart_output() = false;
+            tim::settings::banner()      = false;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(snapshot_tests, delta)
+{
+    auto  name     = details::get_test_name();
+    auto* _storage = tim::storage<wall_clock>::instance();
+
+    details::run(name, 10);
+    _storage->write_snapshot();
+    details::run(name, 5);
+    _storage->write_snapshot();
+    // nothing was measured since the previous snapshot so nothing is written
+    _storage->write_snapshot();
+    // the snapshots are serialized and written by the thread of the writer
+    _storage->wait_snapshots();
+
+    auto lines = details::read_snapshots();
+
+    // the second snapshot only contains the node which was invoked again
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_NE(lines.at(0).find(name), std::string::npos);
+    EXPECT_NE(lines.at(0).find("\"snapshot\":1"), std::string::npos);
+    EXPECT_NE(lines.at(1).find(name), std::string::npos);
+    EXPECT_NE(lines.at(1).find("\"snapshot\":2"), std::string::npos);
+    EXPECT_NE(lines.at(1).find("\"graph_size\":1"), std::string::npos);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    _argc = argc;
+    _argv = argv;
+
+    auto ret = RUN_ALL_TESTS();
+
+    tim::timemory_finalize();
+    tim::dmp::finalize();
+    return ret;
+}
+
+//--------------------------------------------------------------------------------------//
@@ -0,0 +1,261 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "timemory/backends/thread_pool.hpp"
+#include "timemory/timemory.hpp"
+
+using steady_clock_t = std::chrono::steady_clock;
+using thread_pool_t  = tim::threading::thread_pool;
+
+static const size_t ntasks   = 100000;
+static const size_t nthreads = 1000;
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//  Get the current tests name
+inline std::string
+get_test_name()
+{
+    return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// average time in nanoseconds between start and now
+inline double
+elapsed(steady_clock_t::time_point _beg, size_t _n)
+{
+    auto _end = steady_clock_t::now();
+    return std::chrono::duration<double, std::nano>(_end - _beg).count() / _n;
+}
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class thread_pool_tests : public ::testing::Test
+{};
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, submit)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    std::vector<std::future<int>> _futures{};
+    for(int i = 0; i < 100; ++i)
+        _futures.emplace_back(_pool.submit([](int _v) { return 2 * _v; }, i));
+
+    int _sum = 0;
+    for(auto& itr : _futures)
+        _sum += itr.get();
+    EXPECT_EQ(_sum, 9900);
+    EXPECT_GT(_pool.num_workers(), 0);
+    EXPECT_FALSE(_pool.is_worker());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, parallel_for)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    std::vector<int> _data(10000, 0);
+    _pool.parallel_for(_data.size(), [&](size_t i) { _data.at(i) += 1; });
+    EXPECT_EQ(std::accumulate(_data.begin(), _data.end(), 0), 10000);
+
+    // fewer tasks than indices
+    _pool.parallel_for(_data.size(), [&](size_t i) { _data.at(i) += 1; }, 2);
+    EXPECT_EQ(std::accumulate(_data.begin(), _data.end(), 0), 20000);
+
+    // nested calls from a worker help instead of blocking
+    std::atomic<int> _count{ 0 };
+    _pool.parallel_for(16, [&](size_t) {
+        _pool.parallel_for(16, [&](size_t) { ++_count; });
+    });
+    EXPECT_EQ(_count.load(), 256);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, exceptions)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    EXPECT_THROW(_pool.parallel_for(8,
+                                    [](size_t i) {
+                                        if(i == 3)
+                                            throw std::runtime_error("parallel_for");
+                                    }),
+                 std::runtime_error);
+
+    auto _fut = _pool.submit([]() -> int { throw std::out_of_range("submit"); });
+    EXPECT_THROW(_fut.get(), std::out_of_range);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, run_concurrent)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    // every task spins until all of them have arrived, like the ERT barriers
+    for(size_t _n : { 2, 8, 16 })
+    {
+        std::atomic<size_t> _arrived{ 0 };
+        _pool.run_concurrent(_n, [&](size_t) {
+            ++_arrived;
+            while(_arrived.load() < _n)
+                std::this_thread::yield();
+        });
+        EXPECT_EQ(_arrived.load(), _n);
+    }
+
+    // from inside of a worker
+    std::atomic<size_t> _total{ 0 };
+    _pool.parallel_for(4, [&](size_t) {
+        std::atomic<size_t> _arrived{ 0 };
+        _pool.run_concurrent(3, [&](size_t) {
+            ++_arrived;
+            ++_total;
+            while(_arrived.load() < 3)
+                std::this_thread::yield();
+        });
+    });
+    EXPECT_EQ(_total.load(), 12);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, run_concurrent_contention)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    // several callers at once while other work occupies the workers. Each barrier task
+    // helps with nested work before it synchronizes so it must never execute one of
+    // its siblings
+    std::atomic<size_t>      _total{ 0 };
+    std::vector<std::thread> _callers{};
+    for(size_t t = 0; t < 4; ++t)
+    {
+        _callers.emplace_back([&]() {
+            for(size_t k = 0; k < 5; ++k)
+            {
+                std::atomic<size_t> _arrived{ 0 };
+                _pool.run_concurrent(3, [&](size_t) {
+                    _pool.parallel_for(8, [&](size_t) { ++_total; });
+                    ++_arrived;
+                    while(_arrived.load() < 3)
+                        std::this_thread::yield();
+                });
+            }
+        });
+    }
+    _pool.parallel_for(64, [](size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+    });
+    for(auto& itr : _callers)
+        itr.join();
+
+    EXPECT_EQ(_total.load(), 4 * 5 * 3 * 8);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, shutdown)
+{
+    auto& _pool = thread_pool_t::instance();
+
+    _pool.shutdown();
+    EXPECT_EQ(_pool.num_workers(), 0);
+    // workers restart lazily
+    EXPECT_EQ(_pool.submit([]() { return 7; }).get(), 7);
+    EXPECT_GT(_pool.num_workers(), 0);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(thread_pool_tests, overhead)
+{
+    auto& _pool = thread_pool_t::instance();
+    auto  _name = details::get_test_name();
+
+    // make sure the workers are started
+    _pool.submit([]() {}).get();
+
+    std::vector<std::future<void>> _futures{};
+    _futures.reserve(ntasks);
+    auto _beg = steady_clock_t::now();
+    for(size_t i = 0; i < ntasks; ++i)
+        _futures.emplace_back(_pool.submit([]() {}));
+    for(auto& itr : _futures)
+        itr.get();
+    auto _submit_time = details::elapsed(_beg, ntasks);
+
+    std::atomic<size_t> _count{ 0 };
+    _beg = steady_clock_t::now();
+    _pool.parallel_for(ntasks, [&](size_t) { ++_count; });
+    auto _parfor_time = details::elapsed(_beg, ntasks);
+    EXPECT_EQ(_count.load(), ntasks);
+
+    _beg = steady_clock_t::now();
+    for(size_t i = 0; i < nthreads; ++i)
+        std::thread([]() {}).join();
+    auto _thread_time = details::elapsed(_beg, nthreads);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "[" << _name << "]> overhead with " << _pool.num_workers()
+              << " workers:\n";
+    std::cout << "    submit + get      : " << std::setw(10) << _submit_time
+              << " nsec/task\n";
+    std::cout << "    parallel_for      : " << std::setw(10) << _parfor_time
+              << " nsec/index\n";
+    std::cout << "    std::thread       : " << std::setw(10) << _thread_time
+              << " nsec/thread\n";
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+//--------------------------------------------------------------------------------------//
@@ -24,9 +24,12 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <random>
 #include <thread>
@@ -177,17 +180,219 @@ TEST_F(throttle_tests, multithreaded)
     for(auto& itr : threads)
         itr.join();
 
+    // throttling decisions are shared by all threads so the threads whose calls are
+    // above the threshold observe the throttling by the other threads
     for(uint64_t i = 0; i < nthreads; ++i)
     {
-        bool _answer = (i % 2 == 1) ? false : true;
         std::cout << "thread " << i << " throttling: " << std::boolalpha
                   << is_throttled[i] << std::endl;
-        EXPECT_TRUE(is_throttled[i] == _answer);
+        EXPECT_TRUE(is_throttled[i]);
     }
 }
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(throttle_tests, registered_hash)
+{
+    auto name  = details::get_test_name();
+    auto inner = name + "/inner";
+    auto n     = 2 * tim::settings::throttle_count();
+
+    uint64_t    hash_ids[2] = { tim::get_hash_id(name), tim::get_hash_id(inner) };
+    const char* names[2]    = { name.c_str(), inner.c_str() };
+    timemory_add_hash_ids(2, hash_ids, names);
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        timemory_push_trace_hash(hash_ids[0]);
+        timemory_push_trace_hash(hash_ids[1]);
+        // pop out-of-order on every other iteration
+        if(i % 2 == 0)
+        {
+            timemory_pop_trace_hash(hash_ids[0]);
+            timemory_pop_trace_hash(hash_ids[1]);
+        }
+        else
+        {
+            timemory_pop_trace_hash(hash_ids[1]);
+            timemory_pop_trace_hash(hash_ids[0]);
+        }
+    }
+
+    EXPECT_TRUE(timemory_is_throttled(name.c_str()));
+    EXPECT_TRUE(timemory_is_throttled(inner.c_str()));
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(throttle_tests, recursion_overflow)
+{
+    using wall_clock = tim::component::wall_clock;
+
+    auto name = details::get_test_name();
+    // deeper than the shadow stack of the thread
+    const int64_t ndepth = 12;
+    const long    nwork  = 1000000;
+
+    tim::set_env("TIMEMORY_TRACE_STACK_DEPTH", "4", 1);
+
+    std::function<void(int64_t)> _recurse = [&](int64_t _n) {
+        timemory_push_trace(name.c_str());
+        if(_n > 1)
+            _recurse(_n - 1);
+        details::consume(nwork);
+        timemory_pop_trace(name.c_str());
+    };
+
+    std::vector<std::pair<int64_t, double>> _results{};
+    std::thread                             _thread([&]() {
+        _recurse(ndepth);
+        for(auto& itr : tim::storage<wall_clock>::instance()->get())
+        {
+            if(itr.prefix().find(name) == std::string::npos)
+                continue;
+            EXPECT_EQ(itr.data().get_laps(), 1) << itr.prefix();
+            _results.emplace_back(itr.depth(), itr.data().get());
+        }
+    });
+    _thread.join();
+
+    tim::set_env("TIMEMORY_TRACE_STACK_DEPTH", "512", 1);
+
+    // one entry per level and each level includes the time of the deeper levels
+    ASSERT_EQ(_results.size(), ndepth);
+    std::sort(_results.begin(), _results.end());
+    for(size_t i = 1; i < _results.size(); ++i)
+    {
+        EXPECT_EQ(_results.at(i).first, _results.at(i - 1).first + 1);
+        EXPECT_GT(_results.at(i - 1).second, _results.at(i).second)
+            << "depth " << _results.at(i).first;
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(throttle_tests, recursion_throttled)
+{
+    using wall_clock = tim::component::wall_clock;
+
+    auto       name   = details::get_test_name();
+    auto       n      = 2 * tim::settings::throttle_count();
+    const long nwork  = 10000000;
+    double     _outer = 0.0;
+    double     _func  = 0.0;
+    int64_t    _depth = std::numeric_limits<int64_t>::max();
+
+    // the function is throttled by the calls nested in the first call so the pops
+    // of the throttled calls must not stop the record of the first call
+    std::thread _thread([&]() {
+        timemory_push_trace("outer");
+        timemory_push_trace(name.c_str());
+        for(size_t i = 0; i < n; ++i)
+        {
+            timemory_push_trace(name.c_str());
+            timemory_pop_trace(name.c_str());
+        }
+        details::consume(nwork);
+        timemory_pop_trace(name.c_str());
+        timemory_pop_trace("outer");
+        for(auto& itr : tim::storage<wall_clock>::instance()->get())
+        {
+            if(itr.prefix().find("outer") != std::string::npos)
+            {
+                _outer = itr.data().get();
+            }
+            else if(itr.prefix().find(name) != std::string::npos && itr.depth() < _depth)
+            {
+                _depth = itr.depth();
+                _func  = itr.data().get();
+            }
+        }
+    });
+    _thread.join();
+
+    EXPECT_TRUE(timemory_is_throttled(name.c_str()));
+    ASSERT_GT(_outer, 0.0);
+    EXPECT_GT(_func, 0.5 * _outer) << "outer: " << _outer << ", function: " << _func;
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(throttle_tests, reenable)
+{
+    auto name       = details::get_test_name();
+    auto n          = tim::settings::throttle_count();
+    auto v          = tim::settings::throttle_value();
+    auto _interval  = tim::settings::throttle_interval();
+    auto _threshold = 2 * tim::settings::throttle_hysteresis() * v;
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        timemory_pop_trace(name.c_str());
+    }
+
+    EXPECT_TRUE(timemory_is_throttled(name.c_str()));
+
+    // throttled calls trigger the re-evaluation
+    tim::settings::throttle_interval() = 1.0e-6;
+    for(size_t i = 0; i < 2 * n && timemory_is_throttled(name.c_str()); ++i)
+    {
+        timemory_push_trace(name.c_str());
+        timemory_pop_trace(name.c_str());
+    }
+    tim::settings::throttle_interval() = _interval;
+
+    EXPECT_FALSE(timemory_is_throttled(name.c_str()));
+
+    // above the threshold scaled by the hysteresis so it remains enabled
+    for(size_t i = 0; i < n; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        details::consume(_threshold);
+        timemory_pop_trace(name.c_str());
+    }
+
+    EXPECT_FALSE(timemory_is_throttled(name.c_str()));
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(throttle_tests, budget)
+{
+    auto name    = details::get_test_name();
+    auto fast    = name + "/fast";
+    auto slow    = name + "/slow";
+    auto _count  = tim::settings::throttle_count();
+    auto _budget = tim::settings::throttle_budget();
+
+    tim::settings::throttle_count()  = 1000;
+    tim::settings::throttle_budget() = 5.0;
+
+    // nearly all the time of these calls is spent in the instrumentation
+    for(size_t i = 0; i < 2 * tim::settings::throttle_count(); ++i)
+    {
+        timemory_push_trace(fast.c_str());
+        timemory_pop_trace(fast.c_str());
+    }
+
+    // the instrumentation is a small fraction of the time of these calls
+    for(size_t i = 0; i < 2 * tim::settings::throttle_count(); ++i)
+    {
+        timemory_push_trace(slow.c_str());
+        details::consume(10 * tim::settings::throttle_value());
+        timemory_pop_trace(slow.c_str());
+    }
+
+    tim::settings::throttle_count()  = _count;
+    tim::settings::throttle_budget() = _budget;
+
+    EXPECT_TRUE(timemory_is_throttled(fast.c_str()));
+    EXPECT_FALSE(timemory_is_throttled(slow.c_str()));
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(throttle_tests, do_nothing)
 {
     auto n = tim::settings::throttle_count();
@@ -281,6 +486,36 @@ TEST_F(throttle_tests, tuple_multithreaded)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(throttle_tests, patched_site)
+{
+    auto name      = details::get_test_name();
+    auto n         = tim::settings::throttle_count();
+    auto _interval = tim::settings::throttle_interval();
+    int  _site     = 0;
+
+    tim::settings::throttle_interval() = 0.25;
+    timemory_add_trace_site(tim::add_hash_id(name), &_site);
+
+    // the instrumentation does not call the library while the flag is set
+    for(size_t i = 0; i < n && _site == 0; ++i)
+    {
+        timemory_push_trace(name.c_str());
+        timemory_pop_trace(name.c_str());
+    }
+
+    EXPECT_EQ(_site, 1);
+
+    // re-enabled on probation without any further calls into the library
+    for(int i = 0; i < 200 && _site != 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    tim::settings::throttle_interval() = _interval;
+
+    EXPECT_EQ(_site, 0);
+    EXPECT_FALSE(timemory_is_throttled(name.c_str()));
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
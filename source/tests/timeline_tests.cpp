@@ -26,9 +26,11 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <fstream>
 #include <iostream>
 #include <mutex>
 #include <random>
+#include <sstream>
 #include <thread>
 #include <vector>
 
@@ -211,6 +213,138 @@ TEST_F(timeline_tests, nested)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(timeline_tests, stream)
+{
+    using writer_t = tim::timeline_writer<wall_clock>;
+    using buffer_t = tim::timeline_buffer<wall_clock>;
+
+    auto fname = tim::settings::compose_output_filename(details::get_test_name(), ".tmt");
+    auto writer = std::make_shared<writer_t>(fname, wall_clock::get_label(), true);
+
+    long n = 100;
+    {
+        // the buffer is flushed to the writer every 8 events and on destruction
+        buffer_t   buffer(8, 0, true, writer);
+        wall_clock obj;
+        for(long i = 0; i < n; ++i)
+        {
+            buffer.start(&obj, i % 4);
+            obj.start();
+            details::fibonacci(5, false);
+            obj.stop();
+            EXPECT_TRUE(buffer.stop(&obj));
+            EXPECT_LE(buffer.size(), 8);
+        }
+        EXPECT_EQ(buffer.dropped(), 0);
+        EXPECT_EQ(buffer.pending(), 0);
+    }
+
+    EXPECT_EQ(writer->close(), fname);
+    EXPECT_EQ(writer->size(), n);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(timeline_tests, ring_buffer)
+{
+    auto bsize = tim::storage<wall_clock>::instance()->size();
+
+    tim::settings::timeline_buffer() = 16;
+    tim::settings::timeline_flush()  = false;
+
+    long n = 100;
+    for(long i = 0; i < n; ++i)
+    {
+        TIMEMORY_BLANK_MARKER(toolset_t, details::get_test_name());
+        details::fibonacci(5, false);
+    }
+
+    auto esize    = tim::storage<wall_clock>::instance()->size();
+    auto timeline = tim::storage<wall_clock>::instance()->get_timeline();
+    printf("\nbsize = %lu\n", (unsigned long) bsize);
+    printf("esize = %lu\n\n", (unsigned long) esize);
+
+    // no nodes were added to the call-graph and only the last 16 events are retained
+    EXPECT_EQ(esize, bsize);
+    ASSERT_TRUE(timeline != nullptr);
+    EXPECT_EQ(timeline->size(), 16);
+    EXPECT_EQ(timeline->dropped(), n - 16);
+
+    auto hash   = tim::get_hash_id(details::get_test_name());
+    auto events = timeline->get();
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        EXPECT_EQ(events.at(i).hash, hash);
+        EXPECT_GE(events.at(i).stop, events.at(i).start);
+        EXPECT_GT(events.at(i).value, 0);
+        if(i > 0)
+            EXPECT_GE(events.at(i).start, events.at(i - 1).stop);
+    }
+
+    tim::settings::timeline_buffer() = 0;
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(timeline_tests, chrome_trace)
+{
+    using writer_t = tim::chrome_trace_writer<wall_clock>;
+    using buffer_t = tim::timeline_buffer<wall_clock>;
+
+    auto name   = details::get_test_name();
+    auto fname  = tim::settings::compose_output_filename(name, ".json");
+    auto writer = std::make_shared<writer_t>(fname, wall_clock::get_label(), 0, 0);
+
+    long     n        = 50;
+    uint32_t nthreads = 4;
+    auto     _run     = [&](uint32_t _tid) {
+        // labels are resolved on the recording thread
+        buffer_t   buffer(8, _tid, true, writer, [&](uint64_t _hash) {
+            return name + "/" + std::to_string(_hash);
+        });
+        wall_clock obj;
+        for(long i = 0; i < n; ++i)
+        {
+            buffer.start(&obj, i % 4);
+            obj.start();
+            details::fibonacci(5, false);
+            obj.stop();
+            EXPECT_TRUE(buffer.stop(&obj));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < nthreads; ++i)
+        threads.emplace_back(_run, i);
+    for(auto& itr : threads)
+        itr.join();
+
+    ASSERT_EQ(writer->close(), fname);
+    EXPECT_EQ(writer->size(), n * nthreads);
+
+    std::ifstream ifs(fname);
+    ASSERT_TRUE(ifs);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    auto contents = ss.str();
+
+    auto _count = [&contents](const std::string& _key) {
+        size_t _n = 0;
+        for(auto pos = contents.find(_key); pos != std::string::npos;
+            pos      = contents.find(_key, pos + 1))
+            ++_n;
+        return _n;
+    };
+
+    EXPECT_EQ(contents.find("{\"traceEvents\":["), 0);
+    EXPECT_NE(contents.find("\"displayTimeUnit\":\"ns\"}"), std::string::npos);
+    EXPECT_EQ(_count("\"ph\":\"X\""), n * nthreads);
+    EXPECT_EQ(_count("\"thread_name\""), nthreads);
+    EXPECT_EQ(_count("\"name\":\"" + name + "/3\""), (n / 4) * nthreads);
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
@@ -139,6 +139,56 @@ TEST_F(timing_tests, monotonic_raw_timer)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(timing_tests, tsc_timer)
+{
+    CHECK_AVAILABLE(tsc_clock);
+    tsc_clock obj;
+    obj.start();
+    details::do_sleep(1000);
+    obj.stop();
+    std::cout << "\n[" << details::get_test_name() << "]> result: " << obj
+              << " (invariant: " << std::boolalpha << tsc_clock::is_invariant() << ", "
+              << tim::tsc_calibration::get().frequency << " Hz)\n"
+              << std::endl;
+    ASSERT_NEAR(1.0, obj.get(), timer_tolerance);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(timing_tests, sampling_timer)
+{
+    CHECK_AVAILABLE(sampling_cpu_clock);
+    using profiler_t = tim::sampling::profiler;
+    using bundle_t   = tim::component_tuple<sampling_cpu_clock>;
+
+    auto     name = details::get_test_name();
+    bundle_t obj(name);
+    obj.push();
+    obj.start();
+    details::consume(500);
+    obj.stop();
+    obj.pop();
+
+    uint64_t _total  = 0;
+    uint64_t _region = 0;
+    for(const auto& itr : profiler_t::get())
+    {
+        _total += itr.second;
+        if(!itr.first.empty() && itr.first.front() == tim::get_hash_id(name))
+            _region += itr.second;
+    }
+
+    auto _secs = (_region * profiler_t::period()) / static_cast<double>(std::nano::den);
+    std::cout << "\n[" << details::get_test_name() << "]> samples: " << _region << " / "
+              << _total << " (dropped: " << profiler_t::dropped() << ", " << _secs
+              << " sec)\n"
+              << std::endl;
+    ASSERT_GT(_region, 0u);
+    ASSERT_NEAR(0.5, _secs, 0.25);
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(timing_tests, system_timer)
 {
     CHECK_AVAILABLE(system_clock);
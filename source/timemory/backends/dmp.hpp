@@ -178,6 +178,20 @@ barrier()
 #endif
 }
 
+//--------------------------------------------------------------------------------------//
+/// whether \param _value is true on every process. Must be called by all the processes
+inline bool
+all_of(bool _value)
+{
+#if defined(TIMEMORY_USE_UPCXX)
+    return upc::all_of(_value);
+#elif defined(TIMEMORY_USE_MPI)
+    return mpi::all_of(_value);
+#else
+    return _value;
+#endif
+}
+
 //--------------------------------------------------------------------------------------//
 
 }  // namespace dmp
@@ -395,6 +395,25 @@ barrier(comm_t comm)
 #endif
 }
 
+//--------------------------------------------------------------------------------------//
+/// whether \param _value is true on every rank of \param comm. Must be called by all
+/// the ranks
+inline bool
+all_of(bool _value, comm_t comm = comm_world_v)
+{
+#if defined(TIMEMORY_USE_MPI)
+    if(!is_initialized())
+        return _value;
+    int _send = (_value) ? 1 : 0;
+    int _recv = _send;
+    TIMEMORY_MPI_ERROR_CHECK(MPI_Allreduce(&_send, &_recv, 1, MPI_INT, MPI_LAND, comm));
+    return (_recv != 0);
+#else
+    consume_parameters(comm);
+    return _value;
+#endif
+}
+
 //--------------------------------------------------------------------------------------//
 
 inline void
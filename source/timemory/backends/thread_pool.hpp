@@ -0,0 +1,504 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file backends/thread_pool.hpp
+ * \headerfile backends/thread_pool.hpp "timemory/backends/thread_pool.hpp"
+ * Defines the work-stealing thread pool used for the internal parallel work of
+ * timemory, e.g. ERT, merging the call-graphs, writing the output, and processing
+ * the MPI results
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/threading.hpp"
+#include "timemory/backends/topology.hpp"
+#include "timemory/settings/declaration.hpp"
+#include "timemory/utility/macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_LINUX)
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace tim
+{
+namespace threading
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class thread_pool
+/// \brief A small work-stealing thread pool. The workers are started on the first
+/// submission. Each worker has its own deque: tasks submitted by a worker are pushed
+/// onto the deque of the worker (and popped LIFO by it), tasks submitted by other
+/// threads go to a shared queue, and idle workers steal the oldest task of the other
+/// workers, starting with their neighbors (which share a NUMA node when pinned
+/// compactly). When TIMEMORY_CPU_AFFINITY is enabled, the workers are pinned to the
+/// CPUs available to the process in the order of the affinity mode, i.e. the order in
+/// which ERT pins its threads (see tim::topology::get_order).
+///
+class thread_pool
+{
+public:
+    using size_type = size_t;
+    using task_type = std::function<void()>;
+    using mutex_t   = std::mutex;
+    using lock_t    = std::unique_lock<mutex_t>;
+    using cpu_ids_t = topology::int_list_t;
+
+    /// the pool shared by timemory (TIMEMORY_THREAD_POOL_SIZE workers). It is never
+    /// destroyed because the output may be written during the static destruction
+    static thread_pool& instance()
+    {
+        static auto* _instance = new thread_pool{ settings::thread_pool_size() };
+        return *_instance;
+    }
+
+    /// \param _nworkers number of workers (0 = the CPUs available to the process)
+    explicit thread_pool(size_type _nworkers = 0)
+    : m_size((_nworkers > 0) ? _nworkers
+                             : std::max<size_type>(topology::get_cpus().size(), 1))
+    , m_max(std::max<size_type>(4 * m_size, 256))
+    , m_queues(m_max)
+    , m_idle(m_max, false)
+    , m_assigned(m_max)
+    {}
+
+    ~thread_pool() { shutdown(); }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&)      = delete;
+
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+public:
+    /// number of workers which are started on the first submission
+    size_type size() const { return m_size; }
+    /// number of workers currently running
+    size_type num_workers() const { return m_nworkers.load(); }
+    /// whether the calling thread is a worker of this pool
+    bool is_worker() const { return get_worker_info().pool == this; }
+
+    /// starts workers until there are at least \param _n (up to 4x the size of the
+    /// pool or 256) and returns the number of workers
+    size_type reserve(size_type _n)
+    {
+        lock_t _lk(m_start_mutex);
+        m_stop.store(false);
+        _n         = std::min<size_type>(_n, m_max);
+        auto _cpus = (settings::cpu_affinity()) ? topology::get_order() : cpu_ids_t{};
+        for(size_type i = m_nworkers.load(); i < _n; ++i)
+        {
+            if(!m_queues.at(i))
+                m_queues.at(i).reset(new worker_queue{});
+            m_threads.emplace_back(&thread_pool::run, this, i, get_cpu(i, _cpus));
+            ++m_nworkers;
+        }
+        return m_nworkers.load();
+    }
+
+    /// submits \param _func and returns a future for the result. Workers which wait
+    /// for other tasks should use parallel_for, which executes queued tasks while
+    /// waiting, instead of blocking on the future
+    template <typename FuncT, typename... Args>
+    auto submit(FuncT&& _func, Args&&... _args)
+        -> std::future<decltype(_func(std::forward<Args>(_args)...))>
+    {
+        using result_type = decltype(_func(std::forward<Args>(_args)...));
+        auto _task        = std::make_shared<std::packaged_task<result_type()>>(
+            std::bind(std::forward<FuncT>(_func), std::forward<Args>(_args)...));
+        auto _ret = _task->get_future();
+        push([_task]() { (*_task)(); });
+        return _ret;
+    }
+
+    /// executes \param _func(i) for i in [0, \param _n) with at most \param _ntasks
+    /// concurrent tasks (0 = size of the pool + the calling thread). The calling thread
+    /// participates and the first exception is rethrown after all the calls complete
+    template <typename FuncT>
+    void parallel_for(size_type _n, FuncT&& _func, size_type _ntasks = 0)
+    {
+        if(_ntasks == 0)
+            _ntasks = m_size + 1;
+        _ntasks = std::min<size_type>(_ntasks, _n);
+
+        std::atomic<size_type> _idx{ 0 };
+        std::exception_ptr     _except{};
+        mutex_t                _except_mutex{};
+
+        auto _drain = [&]() {
+            for(size_type i = _idx++; i < _n; i = _idx++)
+            {
+                try
+                {
+                    _func(i);
+                } catch(...)
+                {
+                    lock_t _lk(_except_mutex);
+                    if(!_except)
+                        _except = std::current_exception();
+                }
+            }
+        };
+
+        if(_ntasks > 1)
+        {
+            latch _done{ _ntasks - 1 };
+            for(size_type i = 1; i < _ntasks; ++i)
+            {
+                push([&]() {
+                    _drain();
+                    _done.count_down();
+                });
+            }
+            _drain();
+            wait(_done, true);
+        }
+        else
+        {
+            _drain();
+        }
+
+        if(_except)
+            std::rethrow_exception(_except);
+    }
+
+    /// executes \param _func(i) for i in [0, \param _n) on \param _n threads at the
+    /// same time, which is required when the calls synchronize with each other (e.g.
+    /// the barriers of ERT). Each call is handed to a specific idle worker and is never
+    /// queued, so it cannot be taken by other work or stolen by a worker which helps
+    /// while waiting. When there are not enough idle workers, dedicated threads are
+    /// used. The calling thread only waits
+    template <typename FuncT>
+    void run_concurrent(size_type _n, FuncT&& _func)
+    {
+        if(_n == 0)
+            return;
+
+        latch                  _done{ _n };
+        std::vector<task_type> _tasks{};
+        _tasks.reserve(_n);
+        for(size_type i = 0; i < _n; ++i)
+        {
+            _tasks.emplace_back([&, i]() {
+                _func(i);
+                _done.count_down();
+            });
+        }
+
+        if(!assign(_tasks))
+        {
+            // not enough idle workers, use dedicated threads
+            std::vector<std::thread> _threads{};
+            for(auto& itr : _tasks)
+                _threads.emplace_back(std::move(itr));
+            for(auto& itr : _threads)
+                itr.join();
+            return;
+        }
+
+        wait(_done, false);
+    }
+
+    /// stops the workers after the queued tasks are completed
+    void shutdown()
+    {
+        lock_t _lk(m_start_mutex);
+        {
+            lock_t _wlk(m_mutex);
+            m_stop.store(true);
+        }
+        m_cv.notify_all();
+        for(auto& itr : m_threads)
+        {
+            if(itr.joinable())
+                itr.join();
+        }
+        m_threads.clear();
+        m_nworkers.store(0);
+    }
+
+private:
+    struct worker_queue
+    {
+        mutex_t               mutex;
+        std::deque<task_type> tasks;
+    };
+
+    struct worker_info
+    {
+        thread_pool* pool  = nullptr;
+        size_type    index = 0;
+    };
+
+    /// counts down the completed tasks of a parallel_for/run_concurrent
+    struct latch
+    {
+        explicit latch(size_type _n)
+        : count(_n)
+        {}
+
+        void count_down()
+        {
+            lock_t _lk(mutex);
+            if(--count == 0)
+                cv.notify_all();
+        }
+
+        bool done()
+        {
+            lock_t _lk(mutex);
+            return (count == 0);
+        }
+
+        size_type               count;
+        mutex_t                 mutex;
+        std::condition_variable cv;
+    };
+
+    static worker_info& get_worker_info()
+    {
+        static thread_local worker_info _instance{};
+        return _instance;
+    }
+
+    /// tasks of a worker go to the deque of the worker unless \param _shared
+    void push(task_type&& _task, bool _shared = false)
+    {
+        if(m_nworkers.load() == 0)
+            reserve(m_size);
+
+        ++m_pending;
+        auto&         _info  = get_worker_info();
+        worker_queue* _queue = (!_shared && _info.pool == this)
+                                   ? m_queues.at(_info.index).get()
+                                   : &m_shared;
+        {
+            lock_t _lk(_queue->mutex);
+            _queue->tasks.emplace_back(std::move(_task));
+        }
+        {
+            // prevents the notification from being lost between the check of the
+            // predicate and the wait of an idle worker
+            lock_t _lk(m_mutex);
+        }
+        m_cv.notify_one();
+    }
+
+    /// hands each of \param _tasks to a different idle worker. Workers are started and
+    /// waited on (briefly) until enough of them are idle. Returns false without
+    /// assigning anything if there are not enough idle workers
+    bool assign(std::vector<task_type>& _tasks)
+    {
+        auto _n = _tasks.size();
+        if(_n > m_max)
+            return false;
+
+        auto _idle = [this]() {
+            size_type _count = 0;
+            for(size_type i = 0; i < m_nworkers.load(); ++i)
+                _count += (m_idle.at(i) && !m_assigned.at(i)) ? 1 : 0;
+            return _count;
+        };
+
+        {
+            lock_t _lk(m_mutex);
+            auto   _missing = (_idle() < _n) ? (_n - _idle()) : 0;
+            _lk.unlock();
+            if(_missing > 0 && reserve(m_nworkers.load() + _missing) < _n)
+                return false;
+        }
+
+        lock_t _lk(m_mutex);
+        if(!m_idle_cv.wait_for(_lk, std::chrono::milliseconds{ 100 },
+                               [&]() { return _idle() >= _n; }))
+            return false;
+
+        for(size_type i = 0, j = 0; i < m_nworkers.load() && j < _n; ++i)
+        {
+            if(m_idle.at(i) && !m_assigned.at(i))
+            {
+                m_assigned.at(i) = std::move(_tasks.at(j++));
+                m_idle.at(i)     = false;
+            }
+        }
+        _lk.unlock();
+        m_cv.notify_all();
+        return true;
+    }
+
+    /// own deque (newest first), then the shared queue, then steal (oldest first)
+    bool acquire(size_type _idx, task_type& _task, bool _is_worker)
+    {
+        auto _pop = [&_task](worker_queue* _queue, bool _back) {
+            if(!_queue)
+                return false;
+            lock_t _lk(_queue->mutex);
+            if(_queue->tasks.empty())
+                return false;
+            if(_back)
+            {
+                _task = std::move(_queue->tasks.back());
+                _queue->tasks.pop_back();
+            }
+            else
+            {
+                _task = std::move(_queue->tasks.front());
+                _queue->tasks.pop_front();
+            }
+            return true;
+        };
+
+        bool _found = (_is_worker && _pop(m_queues.at(_idx).get(), true)) ||
+                      _pop(&m_shared, false);
+        auto _n     = m_nworkers.load();
+        for(size_type i = 1; !_found && i <= _n; ++i)
+            _found = _pop(m_queues.at((_idx + i) % _n).get(), false);
+
+        if(_found)
+            --m_pending;
+        return _found;
+    }
+
+    void execute(task_type& _task) { _task(); }
+
+    /// waits for \param _done. Workers execute other tasks while waiting when
+    /// \param _help so that nested parallel_for calls cannot exhaust the workers
+    void wait(latch& _done, bool _help)
+    {
+        auto& _info = get_worker_info();
+        if(_help && _info.pool == this)
+        {
+            task_type _task{};
+            while(!_done.done())
+            {
+                if(acquire(_info.index, _task, true))
+                    execute(_task);
+                else
+                    std::this_thread::yield();
+            }
+            return;
+        }
+
+        lock_t _lk(_done.mutex);
+        _done.cv.wait(_lk, [&_done]() { return _done.count == 0; });
+    }
+
+    /// the CPU of worker \param _idx in \param _cpus (negative if the workers are not
+    /// pinned), like the threads of ERT (see ert::counter::get_cpu)
+    static int64_t get_cpu(size_type _idx, const cpu_ids_t& _cpus)
+    {
+        return (_cpus.empty()) ? -1 : _cpus.at(_idx % _cpus.size());
+    }
+
+    void run(size_type _idx, int64_t _cpu)
+    {
+        auto& _info = get_worker_info();
+        _info.pool  = this;
+        _info.index = _idx;
+
+#if defined(_LINUX)
+        if(_cpu >= 0 && _cpu < CPU_SETSIZE)
+        {
+            cpu_set_t _cpuset;
+            CPU_ZERO(&_cpuset);
+            CPU_SET(_cpu, &_cpuset);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &_cpuset);
+        }
+#else
+        consume_parameters(_cpu);
+#endif
+
+        task_type _task{};
+        while(true)
+        {
+            if(acquire(_idx, _task, true))
+            {
+                execute(_task);
+                _task = task_type{};
+                continue;
+            }
+            lock_t _lk(m_mutex);
+            m_idle.at(_idx) = true;
+            m_idle_cv.notify_all();
+            m_cv.wait(_lk, [this, _idx]() {
+                return m_stop.load() || m_pending.load() > 0 || m_assigned.at(_idx);
+            });
+            m_idle.at(_idx) = false;
+            if(m_assigned.at(_idx))
+            {
+                // a task of run_concurrent, which is only executed by this worker
+                std::swap(_task, m_assigned.at(_idx));
+                _lk.unlock();
+                execute(_task);
+                _task = task_type{};
+                continue;
+            }
+            if(m_stop.load() && m_pending.load() <= 0)
+                break;
+        }
+
+        _info.pool = nullptr;
+    }
+
+private:
+    size_type                                  m_size = 1;
+    size_type                                  m_max  = 1;
+    std::atomic<bool>                          m_stop{ false };
+    std::atomic<size_type>                     m_nworkers{ 0 };
+    std::atomic<int64_t>                       m_pending{ 0 };
+    mutex_t                                    m_mutex{};
+    mutex_t                                    m_start_mutex{};
+    std::condition_variable                    m_cv{};
+    std::condition_variable                    m_idle_cv{};
+    worker_queue                               m_shared{};
+    std::vector<std::unique_ptr<worker_queue>> m_queues{};
+    std::vector<bool>                          m_idle{};
+    std::vector<task_type>                     m_assigned{};
+    std::vector<std::thread>                   m_threads{};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace threading
+}  // namespace tim
@@ -0,0 +1,284 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file timemory/backends/topology.hpp
+ * \headerfile timemory/backends/topology.hpp "timemory/backends/topology.hpp"
+ * Provides the CPU/NUMA topology used to pin the ERT threads and the workers of the
+ * thread pool
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/threading.hpp"
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/utility.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_LINUX)
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace tim
+{
+namespace topology
+{
+//--------------------------------------------------------------------------------------//
+/// a logical CPU which the process is allowed to run on
+///
+struct cpu_info
+{
+    int64_t cpu    = 0;
+    int64_t node   = 0;  // NUMA node
+    int64_t socket = 0;  // physical package
+};
+
+using cpu_list_t = std::vector<cpu_info>;
+using int_list_t = std::vector<int64_t>;
+
+//--------------------------------------------------------------------------------------//
+/// parses the format of the sysfs cpu lists, e.g. "0-3,8-11"
+///
+inline int_list_t
+parse_cpu_list(const std::string& _str)
+{
+    int_list_t _ret{};
+    for(auto itr : delimit(_str, ",\n "))
+    {
+        auto _pos = itr.find('-');
+        if(_pos == std::string::npos)
+        {
+            _ret.emplace_back(from_string<int64_t>(itr));
+            continue;
+        }
+        auto _beg = from_string<int64_t>(itr.substr(0, _pos));
+        auto _end = from_string<int64_t>(itr.substr(_pos + 1));
+        for(auto i = _beg; i <= _end; ++i)
+            _ret.emplace_back(i);
+    }
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+/// the CPUs in the affinity mask of the process (e.g. restricted by taskset or
+/// numactl) with their NUMA node and socket. Without sysfs, every CPU is assigned to
+/// node and socket zero
+///
+inline const cpu_list_t&
+get_cpus()
+{
+    static cpu_list_t _instance = []() {
+        cpu_list_t _cpus{};
+#if defined(_LINUX)
+        cpu_set_t _mask;
+        CPU_ZERO(&_mask);
+        bool _has_mask = (sched_getaffinity(0, sizeof(cpu_set_t), &_mask) == 0);
+
+        std::map<int64_t, int64_t> _nodes{};
+        for(int64_t i = 0; i < 4096; ++i)
+        {
+            std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(i) +
+                              "/cpulist");
+            if(!ifs)
+            {
+                if(i > 0)
+                    break;
+                continue;
+            }
+            std::stringstream ss;
+            ss << ifs.rdbuf();
+            for(auto itr : parse_cpu_list(ss.str()))
+                _nodes[itr] = i;
+        }
+
+        // the CPU ids in the mask are not necessarily contiguous (e.g. offline CPUs)
+        int64_t _ncpu = (_has_mask)
+                            ? CPU_SETSIZE
+                            : static_cast<int64_t>(threading::affinity::hw_concurrency());
+        for(int64_t i = 0; i < _ncpu && i < CPU_SETSIZE; ++i)
+        {
+            if(_has_mask && !CPU_ISSET(i, &_mask))
+                continue;
+            cpu_info _info{};
+            _info.cpu  = i;
+            _info.node = (_nodes.count(i) > 0) ? _nodes.at(i) : 0;
+            std::ifstream ifs("/sys/devices/system/cpu/cpu" + std::to_string(i) +
+                              "/topology/physical_package_id");
+            if(ifs)
+                ifs >> _info.socket;
+            _cpus.emplace_back(_info);
+        }
+#endif
+        if(_cpus.empty())
+        {
+            auto _ncpu = threading::affinity::hw_concurrency();
+            for(int64_t i = 0; i < static_cast<int64_t>(_ncpu); ++i)
+                _cpus.emplace_back(cpu_info{ i, 0, 0 });
+        }
+        return _cpus;
+    }();
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+/// the sockets which have at least one CPU in the affinity mask of the process
+///
+inline int_list_t
+get_sockets()
+{
+    int_list_t _ret{};
+    for(const auto& itr : get_cpus())
+    {
+        if(std::find(_ret.begin(), _ret.end(), itr.socket) == _ret.end())
+            _ret.emplace_back(itr.socket);
+    }
+    std::sort(_ret.begin(), _ret.end());
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+/// the order in which threads are assigned to the CPUs of \param _socket (all sockets
+/// if negative). Follows the mode of tim::threading::affinity: COMPACT fills a NUMA
+/// node before the next one, SCATTER/SPREAD alternates between the NUMA nodes so that
+/// fewer threads than CPUs still use the memory controllers of every node and EXPLICIT
+/// uses the CPUs in the affinity map (indexed by thread) which are on the socket
+///
+inline int_list_t
+get_order(int64_t _socket = -1)
+{
+    using mode_t = threading::affinity::MODE;
+
+    std::map<int64_t, int_list_t> _nodes{};
+    std::map<int64_t, int64_t>    _sockets{};
+    for(const auto& itr : get_cpus())
+    {
+        _sockets[itr.cpu] = itr.socket;
+        if(_socket < 0 || itr.socket == _socket)
+            _nodes[itr.node].emplace_back(itr.cpu);
+    }
+
+    int_list_t _ret{};
+    switch(threading::affinity::get_mode())
+    {
+        case mode_t::EXPLICIT:
+        {
+            for(const auto& itr : threading::affinity::get_affinity_map())
+            {
+                auto _cpu = itr.second;
+                if(_socket < 0 ||
+                   (_sockets.count(_cpu) > 0 && _sockets.at(_cpu) == _socket))
+                    _ret.emplace_back(_cpu);
+            }
+            if(!_ret.empty())
+                break;
+        }
+        // fall through
+        case mode_t::COMPACT:
+        {
+            for(const auto& itr : _nodes)
+                _ret.insert(_ret.end(), itr.second.begin(), itr.second.end());
+            break;
+        }
+        case mode_t::SCATTER:
+        case mode_t::SPREAD:
+        {
+            for(size_t i = 0; _ret.size() < get_cpus().size(); ++i)
+            {
+                size_t _n = 0;
+                for(const auto& itr : _nodes)
+                {
+                    if(i < itr.second.size())
+                    {
+                        _ret.emplace_back(itr.second.at(i));
+                        ++_n;
+                    }
+                }
+                if(_n == 0)
+                    break;
+            }
+            break;
+        }
+    }
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+/// pins the calling thread to \param _cpu for the lifetime of the object and restores
+/// the previous affinity afterwards (the thread may be the thread of the application)
+///
+class scoped_pin
+{
+public:
+    explicit scoped_pin(int64_t _cpu)
+    {
+#if defined(_LINUX)
+        if(_cpu < 0 || _cpu >= CPU_SETSIZE)
+            return;
+        pthread_t _thread = pthread_self();
+        CPU_ZERO(&m_previous);
+        if(pthread_getaffinity_np(_thread, sizeof(cpu_set_t), &m_previous) != 0)
+            return;
+        cpu_set_t _cpuset;
+        CPU_ZERO(&_cpuset);
+        CPU_SET(_cpu, &_cpuset);
+        m_pinned = (pthread_setaffinity_np(_thread, sizeof(cpu_set_t), &_cpuset) == 0);
+#else
+        consume_parameters(_cpu);
+#endif
+    }
+
+    ~scoped_pin()
+    {
+#if defined(_LINUX)
+        if(m_pinned)
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &m_previous);
+#endif
+    }
+
+    scoped_pin(const scoped_pin&) = delete;
+    scoped_pin(scoped_pin&&)      = delete;
+
+    scoped_pin& operator=(const scoped_pin&) = delete;
+    scoped_pin& operator=(scoped_pin&&) = delete;
+
+    bool is_pinned() const { return m_pinned; }
+
+private:
+    bool m_pinned = false;
+#if defined(_LINUX)
+    cpu_set_t m_previous;
+#endif
+};
+
+}  // namespace topology
+}  // namespace tim
@@ -188,6 +188,23 @@ barrier(comm_t& comm)
 #endif
 }
 
+//--------------------------------------------------------------------------------------//
+/// whether \param _value is true on every rank of \param comm. Must be called by all
+/// the ranks
+inline bool
+all_of(bool _value, comm_t& comm = world())
+{
+#if defined(TIMEMORY_USE_UPCXX)
+    if(!is_initialized())
+        return _value;
+    int _value_int = (_value) ? 1 : 0;
+    return (::upcxx::reduce_all(_value_int, ::upcxx::op_fast_bit_and, comm).wait() != 0);
+#else
+    consume_parameters(comm);
+    return _value;
+#endif
+}
+
 //--------------------------------------------------------------------------------------//
 
 }  // namespace upc
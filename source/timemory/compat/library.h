@@ -177,6 +177,13 @@ extern "C"
     TIMEMORY_DECL void timemory_pop_region(const char* name)
         TIMEMORY_VISIBILITY("default");
 
+    TIMEMORY_DECL uint64_t timemory_get_region_id(const char* name)
+        TIMEMORY_VISIBILITY("default");
+    TIMEMORY_DECL void timemory_push_region_id(uint64_t id)
+        TIMEMORY_VISIBILITY("default");
+    TIMEMORY_DECL void timemory_pop_region_id(uint64_t id)
+        TIMEMORY_VISIBILITY("default");
+
     TIMEMORY_DECL bool timemory_is_throttled(const char* name)
         TIMEMORY_VISIBILITY("default");
     TIMEMORY_DECL void timemory_add_hash_id(uint64_t id, const char* name)
@@ -184,6 +191,8 @@ extern "C"
     TIMEMORY_DECL void timemory_add_hash_ids(uint64_t nentries, uint64_t* ids,
                                              const char** names)
         TIMEMORY_VISIBILITY("default");
+    TIMEMORY_DECL void timemory_add_trace_site(uint64_t id, int* throttled)
+        TIMEMORY_VISIBILITY("default");
 
     TIMEMORY_DECL void timemory_push_trace_hash(uint64_t id)
         TIMEMORY_VISIBILITY("default");
@@ -150,7 +150,18 @@ template <typename Up, typename Vp, enable_if_t<(implements_storage<Up, Vp>::val
 void
 base<Tp, Value>::pop_node()
 {
-    if(is_on_stack)
+    if(is_on_stack && !graph_itr)
+    {
+        // the storage recorded a timeline event instead of inserting a node
+        is_on_stack   = false;
+        depth_change  = false;
+        Type& rhs     = static_cast<Type&>(*this);
+        auto _storage = static_cast<storage_type*>(get_storage());
+        assert(_storage != nullptr);
+        _storage->timeline_stop(&rhs);
+        _storage->stack_pop(&rhs);
+    }
+    else if(is_on_stack)
     {
         is_on_stack   = false;
         Type& obj     = graph_itr->obj();
@@ -127,12 +127,14 @@ TIMEMORY_EXTERN_FACTORY_TEMPLATE(priority_context_switch)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(process_cpu_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(process_cpu_util)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(read_bytes)
+TIMEMORY_EXTERN_FACTORY_TEMPLATE(sampling_cpu_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(stack_rss)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(system_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(tau_marker)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(thread_cpu_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(thread_cpu_util)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(trip_count)
+TIMEMORY_EXTERN_FACTORY_TEMPLATE(tsc_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(user_clock)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(user_mode_time)
 TIMEMORY_EXTERN_FACTORY_TEMPLATE(virtual_memory)
@@ -33,6 +33,7 @@
 #include "timemory/components/roofline/backends.hpp"
 #include "timemory/components/roofline/types.hpp"
 
+#include "timemory/ert/cache.hpp"
 #include "timemory/ert/configuration.hpp"
 
 #include <array>
@@ -286,6 +287,30 @@ struct cpu_roofline
     static void set_executor_callback(FuncT&& f)
     {
         ert_executor_type<Tp>::get_callback() = std::forward<FuncT>(f);
+        // the results of a custom executor are not identified by the cache key
+        get_custom_executor() = true;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static bool& get_custom_executor()
+    {
+        static bool _instance = false;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+    /// the key of the cached ERT results: the system and the parameters of each type
+    ///
+    static std::string get_ert_cache_key()
+    {
+        auto&             ert_config = get_finalizer();
+        std::stringstream ss;
+        ss << ert::cache::get_system_key();
+        TIMEMORY_FOLD_EXPRESSION(ss << ";"
+                                    << ert::cache::get_config_key(
+                                           std::get<ert_config_type<Types>>(ert_config)));
+        return ss.str();
     }
 
     //----------------------------------------------------------------------------------//
@@ -294,10 +319,27 @@ struct cpu_roofline
     {
         if(_store && _store->size() > 0)
         {
-            // run roofline peak generation
             auto ert_config = get_finalizer();
             auto ert_data   = get_ert_data();
-            apply<void>::access<ert_executor_t>(ert_config, ert_data);
+            auto ert_key =
+                (get_custom_executor()) ? std::string{} : get_ert_cache_key();
+            // reuse the results of a previous run on the same type of node. ERT
+            // synchronizes the processes so either all of them reuse the results or
+            // all of them run it
+            ert_data_t _cached{};
+            bool       _hit = !ert_key.empty() && ert_data &&
+                        ert::cache::load(ert_key, _cached);
+            if(dmp::all_of(_hit))
+            {
+                *ert_data = std::move(_cached);
+            }
+            else
+            {
+                // run roofline peak generation
+                apply<void>::access<ert_executor_t>(ert_config, ert_data);
+                if(ert_data && !ert_key.empty())
+                    ert::cache::save(ert_key, *ert_data);
+            }
             if(ert_data && (settings::verbose() > 1 || settings::debug()))
                 std::cout << *(ert_data) << std::endl;
         }
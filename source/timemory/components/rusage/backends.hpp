@@ -33,8 +33,10 @@
 #include "timemory/backends/process.hpp"
 #include "timemory/utility/macros.hpp"
 
+#include <array>
 #include <cstdint>
 #include <cstdio>
+#include <ctime>
 #include <fstream>
 #include <iomanip>
 #include <ios>
@@ -42,6 +44,7 @@
 #include <string>
 
 #if defined(_UNIX)
+#    include <fcntl.h>
 #    include <sys/resource.h>
 #    include <unistd.h>
 #    if defined(_MACOS)
@@ -99,6 +102,147 @@ check_rusage_call(int ret, const char* _func)
 #endif
 }
 
+#if defined(_LINUX)
+//
+/// \class tim::proc_file
+/// \brief Per-thread reader of a file in /proc/<pid> (e.g. statm, io) which keeps the
+/// file descriptor open, re-reads the contents with pread into a stack buffer and
+/// parses every integer in the file. A read is shared by all the fields requested
+/// in quick succession (i.e. several components in a bundle): the file is only re-read
+/// when a field is requested a second time or the last read is older than
+/// \ref reuse_window nanoseconds.
+///
+class proc_file
+{
+public:
+    static constexpr size_t max_fields  = 16;
+    static constexpr size_t buffer_size = 512;
+
+    using array_type = std::array<int64_t, max_fields>;
+
+    explicit proc_file(const char* _name)
+    : m_name(_name)
+    {}
+
+    ~proc_file() { close(); }
+
+    proc_file(const proc_file&) = delete;
+    proc_file& operator=(const proc_file&) = delete;
+
+    /// the thread-local reader of /proc/<pid>/statm
+    static proc_file& statm()
+    {
+        static thread_local proc_file _instance{ "statm" };
+        return _instance;
+    }
+
+    /// the thread-local reader of /proc/<pid>/io
+    static proc_file& io()
+    {
+        static thread_local proc_file _instance{ "io" };
+        return _instance;
+    }
+
+    /// maximum age (in nanoseconds) of a read which can be shared by other fields
+    static int64_t& reuse_window()
+    {
+        static int64_t _instance = 100000;
+        return _instance;
+    }
+
+    /// the value of the N-th integer in the file
+    int64_t get(size_t _idx)
+    {
+        if(_idx >= max_fields)
+            return 0;
+        auto _now = now();
+        if((m_used & (1u << _idx)) != 0 || (_now - m_last) > reuse_window() ||
+           m_pid != get_rusage_pid())
+            read(_now);
+        m_used |= (1u << _idx);
+        return (_idx < m_nfields) ? m_fields[_idx] : 0;
+    }
+
+    /// number of times the file has been read
+    size_t reads() const { return m_nreads; }
+
+private:
+    static int64_t now()
+    {
+        struct timespec _ts;
+        clock_gettime(CLOCK_MONOTONIC, &_ts);
+        return static_cast<int64_t>(_ts.tv_sec) * 1000000000L + _ts.tv_nsec;
+    }
+
+    void close()
+    {
+        if(m_fd >= 0)
+            ::close(m_fd);
+        m_fd = -1;
+    }
+
+    bool open()
+    {
+        close();
+        m_pid = get_rusage_pid();
+        char _path[64];
+        snprintf(_path, sizeof(_path), "/proc/%li/%s", (long int) m_pid, m_name);
+        m_fd = ::open(_path, O_RDONLY | O_CLOEXEC);
+        return (m_fd >= 0);
+    }
+
+    void read(int64_t _now)
+    {
+        m_last    = _now;
+        m_used    = 0;
+        m_nfields = 0;
+
+        // (re)open when the target pid changes. A file which could not be opened or
+        // read is not retried until the target pid changes
+        if(m_pid != get_rusage_pid())
+            open();
+        if(m_fd < 0)
+            return;
+
+        char    _buf[buffer_size];
+        ssize_t _n = ::pread(m_fd, _buf, buffer_size, 0);
+        // the descriptor is invalidated if the process exited and the pid was reused
+        if(_n <= 0 && open())
+            _n = ::pread(m_fd, _buf, buffer_size, 0);
+        if(_n <= 0)
+        {
+            close();
+            return;
+        }
+        ++m_nreads;
+
+        for(ssize_t i = 0; i < _n && m_nfields < max_fields;)
+        {
+            if(_buf[i] < '0' || _buf[i] > '9')
+            {
+                ++i;
+                continue;
+            }
+            int64_t _val = 0;
+            for(; i < _n && _buf[i] >= '0' && _buf[i] <= '9'; ++i)
+                _val = (_val * 10) + (_buf[i] - '0');
+            m_fields[m_nfields++] = _val;
+        }
+    }
+
+private:
+    int         m_fd      = -1;
+    pid_t       m_pid     = -1;
+    uint32_t    m_used    = 0;
+    size_t      m_nfields = 0;
+    size_t      m_nreads  = 0;
+    int64_t     m_last    = 0;
+    const char* m_name    = nullptr;
+    array_type  m_fields  = {};
+};
+//
+#endif
+
 int64_t
 get_peak_rss();
 int64_t
@@ -213,20 +357,8 @@ tim::get_page_rss()
 
 #    else  // Linux
 
-    int64_t           rss = 0;
-    std::stringstream fio;
-    fio << "/proc/" << get_rusage_pid() << "/statm";
-    FILE* fp = fopen(fio.str().c_str(), "r");
-    if(fp && fscanf(fp, "%*s%ld", &rss) == 1)
-    {
-        fclose(fp);
-        return static_cast<int64_t>(rss * units::get_page_size());
-    }
-
-    if(fp)
-        fclose(fp);
-
-    return static_cast<int64_t>(0);
+    // statm: size resident shared text lib data dt (pages)
+    return static_cast<int64_t>(proc_file::statm().get(1) * units::get_page_size());
 
 #    endif
 #elif defined(_WINDOWS)
@@ -283,21 +415,7 @@ tim::get_data_rss()
 
 #    else  // Linux
 
-    std::string fstatm = [&]() {
-        std::stringstream fio;
-        fio << "/proc/" << get_rusage_pid() << "/statm";
-        return fio.str();
-    }();
-    int64_t       drss_size = 0;
-    std::ifstream ifs;
-    ifs.open(fstatm.c_str());
-    if(ifs)
-    {
-        static int64_t dummy = 0;
-        ifs >> dummy >> dummy >> dummy >> dummy >> dummy >> drss_size;
-    }
-    ifs.close();
-    return static_cast<int64_t>(drss_size * units::get_page_size());
+    return static_cast<int64_t>(proc_file::statm().get(5) * units::get_page_size());
 #    endif
 #else
     return static_cast<int64_t>(0);
@@ -471,26 +589,8 @@ tim::get_bytes_read()
                (long int) get_rusage_pid());
 #    endif
 
-    std::stringstream fio;
-    fio << "/proc/" << get_rusage_pid() << "/io";
-    std::string   label = "";
-    int64_t       value = 0;
-    std::ifstream ifs(fio.str().c_str());
-    if(ifs)
-    {
-        static constexpr int max_lines = 1;
-        for(int i = 0; i < max_lines && !ifs.eof(); ++i)
-        {
-            ifs >> label;
-            ifs >> value;
-            // if(label.find("read_bytes") != std::string::npos)
-            //    return value;
-            // if(label.find("rchar") != std::string::npos)
-            //    return value;
-        }
-        if(!ifs.eof())
-            return value;
-    }
+    // io: rchar wchar syscr syscw read_bytes write_bytes cancelled_write_bytes
+    return proc_file::io().get(0);
 #endif
     return 0;
 }
@@ -512,26 +612,8 @@ tim::get_bytes_written()
                (long int) get_rusage_pid());
 #    endif
 
-    std::stringstream fio;
-    fio << "/proc/" << get_rusage_pid() << "/io";
-    std::string   label = "";
-    int64_t       value = 0;
-    std::ifstream ifs(fio.str().c_str());
-    if(ifs)
-    {
-        static constexpr int max_lines = 2;
-        for(int i = 0; i < max_lines && !ifs.eof(); ++i)
-        {
-            ifs >> label;
-            ifs >> value;
-            // if(label.find("write_bytes") != std::string::npos)
-            //     return value;
-            // if(label.find("wchar") != std::string::npos)
-            //    return value;
-        }
-        if(!ifs.eof())
-            return value;
-    }
+    // io: rchar wchar syscr syscw read_bytes write_bytes cancelled_write_bytes
+    return proc_file::io().get(1);
 #endif
     return 0;
 }
@@ -568,18 +650,7 @@ tim::get_virt_mem()
                (long int) get_rusage_pid());
 #        endif
 
-    std::string fstatm = [&]() {
-        std::stringstream fio;
-        fio << "/proc/" << get_rusage_pid() << "/statm";
-        return fio.str();
-    }();
-    int64_t       vm_size = 0;
-    std::ifstream ifs;
-    ifs.open(fstatm.c_str());
-    if(ifs)
-        ifs >> vm_size;
-    ifs.close();
-    return static_cast<int64_t>(vm_size * units::get_page_size());
+    return static_cast<int64_t>(proc_file::statm().get(0) * units::get_page_size());
 
 #    endif
 #elif defined(_WINDOWS)
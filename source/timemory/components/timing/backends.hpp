@@ -33,6 +33,7 @@
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/utility.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
@@ -55,6 +56,11 @@
 #    include <sys/times.h>
 #    include <unistd.h>
 
+#    if defined(__x86_64__) || defined(__i386__)
+#        include <cpuid.h>
+#        include <x86intrin.h>
+#    endif
+
 #elif defined(_WINDOWS)
 //
 //  Windows does not have tms definition
@@ -419,6 +425,113 @@ get_clock_cpu_now()
            static_cast<Tp>(clock_tick<Precision>());
 }
 
+//--------------------------------------------------------------------------------------//
+// reads the cycle counter: the time-stamp counter on x86 (rdtscp waits for all prior
+// instructions to execute before reading) or the virtual counter on aarch64. Returns
+// zero when there is no supported counter
+inline uint64_t
+get_cycle_counter()
+{
+#if defined(_UNIX) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int _aux = 0;
+    return __rdtscp(&_aux);
+#elif defined(_UNIX) && defined(__aarch64__)
+    uint64_t _val = 0;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(_val));
+    return _val;
+#else
+    return 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+// conversion of the cycle counter to time. The counter is only used when it increments
+// at a constant rate regardless of the frequency scaling and sleep states of the CPU
+// (invariant TSC on x86, always true for the aarch64 generic timer). The frequency is
+// measured at startup against CLOCK_MONOTONIC_RAW (the median of several short
+// samples) or read from cntfrq_el0 on aarch64.
+struct tsc_calibration
+{
+    bool   invariant   = false;
+    double frequency   = 0.0;
+    double ns_per_tick = 1.0;
+
+    static const tsc_calibration& get()
+    {
+        static tsc_calibration _instance = calibrate();
+        return _instance;
+    }
+
+    static bool is_invariant()
+    {
+#if defined(_UNIX) && (defined(__x86_64__) || defined(__i386__))
+        unsigned int _eax = 0, _ebx = 0, _ecx = 0, _edx = 0;
+        // leaf 0x80000007, EDX bit 8: invariant TSC
+        if(__get_cpuid_max(0x80000000, nullptr) < 0x80000007)
+            return false;
+        __get_cpuid(0x80000007, &_eax, &_ebx, &_ecx, &_edx);
+        return ((_edx & (1u << 8)) != 0);
+#elif defined(_UNIX) && defined(__aarch64__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static tsc_calibration calibrate(int64_t _window = 5000000, int _nsamples = 5)
+    {
+        tsc_calibration _ret{};
+        if(!is_invariant() || get_cycle_counter() == 0)
+            return _ret;
+
+#if defined(_UNIX) && defined(__aarch64__)
+        uint64_t _freq = 0;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(_freq));
+        _ret.frequency = static_cast<double>(_freq);
+#else
+        auto _now = []() {
+            return get_clock_now<int64_t, std::nano>(CLOCK_MONOTONIC_RAW);
+        };
+
+        std::vector<double> _samples;
+        for(int i = 0; i < _nsamples; ++i)
+        {
+            auto _t0 = _now();
+            auto _c0 = get_cycle_counter();
+            auto _t1 = _t0;
+            while(_t1 - _t0 < _window)
+                _t1 = _now();
+            auto _c1 = get_cycle_counter();
+            if(_c1 > _c0)
+                _samples.push_back(static_cast<double>(_c1 - _c0) /
+                                   (static_cast<double>(_t1 - _t0) / std::nano::den));
+        }
+        if(_samples.empty())
+            return _ret;
+        std::sort(_samples.begin(), _samples.end());
+        _ret.frequency = _samples.at(_samples.size() / 2);
+#endif
+        if(_ret.frequency > 0.0)
+        {
+            _ret.invariant   = true;
+            _ret.ns_per_tick = std::nano::den / _ret.frequency;
+        }
+        return _ret;
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+// the cycle counter when it is invariant, otherwise CLOCK_MONOTONIC_RAW in nanoseconds.
+// Convert the difference of two values to nanoseconds with
+// tsc_calibration::get().ns_per_tick (which is one for the fallback)
+inline int64_t
+get_clock_tsc_now()
+{
+    static bool _invariant = tsc_calibration::get().invariant;
+    return (_invariant) ? static_cast<int64_t>(get_cycle_counter())
+                        : get_clock_now<int64_t, std::nano>(CLOCK_MONOTONIC_RAW);
+}
+
 //--------------------------------------------------------------------------------------//
 
 }  // namespace tim
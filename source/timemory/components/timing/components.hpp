@@ -38,6 +38,7 @@
 #include "timemory/units.hpp"
 
 #include "timemory/components/timing/backends.hpp"
+#include "timemory/sampling/profiler.hpp"
 #include "timemory/components/timing/types.hpp"
 
 #include <utility>
@@ -238,6 +239,164 @@ struct monotonic_raw_clock : public base<monotonic_raw_clock>
     }
 };
 
+//--------------------------------------------------------------------------------------//
+// wall-clock timer which reads the cycle counter (rdtscp on x86, cntvct_el0 on aarch64)
+// instead of calling clock_gettime. The counter is converted to nanoseconds with the
+// frequency calibrated against CLOCK_MONOTONIC_RAW at startup. Falls back to
+// CLOCK_MONOTONIC_RAW when the counter is not invariant.
+struct tsc_clock : public base<tsc_clock>
+{
+    using ratio_t    = std::nano;
+    using value_type = int64_t;
+    using base_type  = base<tsc_clock, value_type>;
+
+    static std::string label() { return "tsc_clock"; }
+    static std::string description()
+    {
+        return "Wall-clock timer using the invariant cycle counter (calibrated against "
+               "CLOCK_MONOTONIC_RAW)";
+    }
+    /// the raw counter value (use \ref to_nanoseconds for a difference of two values)
+    static value_type record() { return tim::get_clock_tsc_now(); }
+    static value_type to_nanoseconds(value_type _ticks)
+    {
+        return static_cast<value_type>(_ticks * tsc_calibration::get().ns_per_tick);
+    }
+    static bool is_invariant() { return tsc_calibration::get().invariant; }
+    double      get_display() const
+    {
+        auto val = (is_transient) ? accum : value;
+        return static_cast<double>(val / static_cast<double>(ratio_t::den) *
+                                   base_type::get_unit());
+    }
+    double get() const { return get_display(); }
+    void   start()
+    {
+        set_started();
+        value = record();
+    }
+    void stop()
+    {
+        value = to_nanoseconds(record() - value);
+        accum += value;
+        set_stopped();
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+// statistical profile of the thread CPU-time. Instead of measuring each region, a
+// per-thread CLOCK_THREAD_CPUTIME_ID timer periodically samples the stack of open
+// regions (and optionally the native call-stack). The samples are converted into
+// the call-graph at finalization: each node has value = samples * period and
+// laps = samples.
+struct sampling_cpu_clock : public base<sampling_cpu_clock>
+{
+    using ratio_t       = std::nano;
+    using value_type    = int64_t;
+    using base_type     = base<sampling_cpu_clock, value_type>;
+    using profiler_type = sampling::profiler;
+
+    static std::string label() { return "sampling_cpu_clock"; }
+    static std::string description()
+    {
+        return "Statistical call-stack profile of thread CPU-time from per-thread "
+               "sampling timers";
+    }
+    static value_type record() { return 0; }
+    double            get_display() const
+    {
+        auto val = (is_transient) ? accum : value;
+        return static_cast<double>(val / static_cast<double>(ratio_t::den) *
+                                   base_type::get_unit());
+    }
+    double get() const { return get_display(); }
+    void   start() {}
+    void   stop() {}
+
+    /// replaces the insertion into the call-graph: the region is pushed onto the
+    /// sampled region stack and the sampling timer of the thread is armed
+    template <typename StorageT = storage_type>
+    void insert_node(scope::config, int64_t _hash)
+    {
+        if(is_on_stack)
+            return;
+        static thread_local bool _started = [] {
+            auto _storage = static_cast<StorageT*>(get_storage());
+            if(_storage)
+                _storage->insert_init();
+            return profiler_type::start();
+        }();
+        consume_parameters(_started);
+        is_on_stack = true;
+        profiler_type::push(_hash);
+    }
+
+    void pop_node()
+    {
+        if(!is_on_stack)
+            return;
+        is_on_stack = false;
+        profiler_type::pop();
+    }
+
+    /// stops sampling on all threads and adds the aggregated samples to the
+    /// (merged) call-graph of the master thread
+    template <typename StorageT>
+    static void global_finalize(StorageT* _storage)
+    {
+        profiler_type::stop_all();
+        if(!_storage)
+            return;
+
+        auto _data = profiler_type::get();
+        if(_data.empty())
+            return;
+
+        if(profiler_type::dropped() > 0 && settings::verbose() >= 0)
+            fprintf(stderr, "[%s]> %lu samples were dropped. Increase %s\n",
+                    label().c_str(), (unsigned long) profiler_type::dropped(),
+                    "TIMEMORY_SAMPLING_BUFFER or reduce TIMEMORY_SAMPLING_FREQUENCY");
+
+        using secondary_t = typename StorageT::template secondary_data_t<this_type>;
+        using iterator    = typename StorageT::iterator;
+        using key_type    = typename profiler_type::key_type;
+
+        // samples are exclusive to the innermost entry of the call-stack so sum the
+        // samples for every prefix of the call-stack to obtain inclusive values.
+        // Every prefix sorts before the call-stacks which extend it
+        std::map<key_type, uint64_t> _inclusive{};
+        for(const auto& itr : _data)
+        {
+            for(size_t i = 1; i <= itr.first.size(); ++i)
+                _inclusive[key_type(itr.first.begin(), itr.first.begin() + i)] +=
+                    itr.second;
+        }
+
+        _storage->insert_init();
+        auto                         _period = profiler_type::period();
+        std::map<key_type, iterator> _nodes{};
+        for(const auto& itr : _inclusive)
+        {
+            auto _parent = _storage->data().head();
+            if(itr.first.size() > 1)
+            {
+                auto pitr = _nodes.find(key_type(itr.first.begin(), itr.first.end() - 1));
+                if(pitr == _nodes.end())
+                    continue;
+                _parent = pitr->second;
+            }
+            this_type _obj{};
+            _obj.value  = static_cast<value_type>(itr.second) * _period;
+            _obj.accum  = _obj.value;
+            _obj.laps   = static_cast<int64_t>(itr.second);
+            auto _label = get_hash_identifier(itr.first.back());
+            auto _node  = _storage->append(secondary_t{ _parent, _label, _obj });
+            if(_node)
+                _nodes.emplace(itr.first, _node);
+        }
+    }
+};
+
 //--------------------------------------------------------------------------------------//
 // this clock measures the CPU time within the current thread (excludes sibling/child
 // threads)
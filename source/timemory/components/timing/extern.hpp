@@ -67,6 +67,8 @@ TIMEMORY_EXTERN_TEMPLATE(struct base<user_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<cpu_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<monotonic_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<monotonic_raw_clock>)
+TIMEMORY_EXTERN_TEMPLATE(struct base<tsc_clock>)
+TIMEMORY_EXTERN_TEMPLATE(struct base<sampling_cpu_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<thread_cpu_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<process_cpu_clock>)
 TIMEMORY_EXTERN_TEMPLATE(struct base<cpu_util, std::pair<int64_t, int64_t>>)
@@ -84,6 +86,8 @@ TIMEMORY_EXTERN_OPERATIONS(component::user_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::cpu_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::monotonic_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::monotonic_raw_clock, true)
+TIMEMORY_EXTERN_OPERATIONS(component::tsc_clock, true)
+TIMEMORY_EXTERN_OPERATIONS(component::sampling_cpu_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::thread_cpu_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::process_cpu_clock, true)
 TIMEMORY_EXTERN_OPERATIONS(component::cpu_util, true)
@@ -99,6 +103,8 @@ TIMEMORY_EXTERN_STORAGE(component::cpu_clock, cpu_clock)
 TIMEMORY_EXTERN_STORAGE(component::cpu_util, cpu_util)
 TIMEMORY_EXTERN_STORAGE(component::monotonic_clock, monotonic_clock)
 TIMEMORY_EXTERN_STORAGE(component::monotonic_raw_clock, monotonic_raw_clock)
+TIMEMORY_EXTERN_STORAGE(component::tsc_clock, tsc_clock)
+TIMEMORY_EXTERN_STORAGE(component::sampling_cpu_clock, sampling_cpu_clock)
 TIMEMORY_EXTERN_STORAGE(component::thread_cpu_clock, thread_cpu_clock)
 TIMEMORY_EXTERN_STORAGE(component::thread_cpu_util, thread_cpu_util)
 TIMEMORY_EXTERN_STORAGE(component::process_cpu_clock, process_cpu_clock)
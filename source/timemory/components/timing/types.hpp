@@ -42,6 +42,8 @@ TIMEMORY_DECLARE_COMPONENT(user_clock)
 TIMEMORY_DECLARE_COMPONENT(cpu_clock)
 TIMEMORY_DECLARE_COMPONENT(monotonic_clock)
 TIMEMORY_DECLARE_COMPONENT(monotonic_raw_clock)
+TIMEMORY_DECLARE_COMPONENT(tsc_clock)
+TIMEMORY_DECLARE_COMPONENT(sampling_cpu_clock)
 TIMEMORY_DECLARE_COMPONENT(thread_cpu_clock)
 TIMEMORY_DECLARE_COMPONENT(process_cpu_clock)
 TIMEMORY_DECLARE_COMPONENT(cpu_util)
@@ -64,6 +66,8 @@ TIMEMORY_STATISTICS_TYPE(component::user_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::cpu_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::monotonic_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::monotonic_raw_clock, double)
+TIMEMORY_STATISTICS_TYPE(component::tsc_clock, double)
+TIMEMORY_STATISTICS_TYPE(component::sampling_cpu_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::thread_cpu_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::process_cpu_clock, double)
 TIMEMORY_STATISTICS_TYPE(component::cpu_util, double)
@@ -78,6 +82,8 @@ TIMEMORY_STATISTICS_TYPE(component::thread_cpu_util, double)
 //
 TIMEMORY_DEFINE_CONCRETE_TRAIT(thread_scope_only, component::thread_cpu_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(thread_scope_only, component::thread_cpu_util, true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(thread_scope_only, component::sampling_cpu_clock,
+                               true_type)
 //
 //--------------------------------------------------------------------------------------//
 //
@@ -92,6 +98,9 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::cpu_clock, true_ty
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::monotonic_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::monotonic_raw_clock,
                                true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::tsc_clock, true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::sampling_cpu_clock,
+                               true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::thread_cpu_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(is_timing_category, component::process_cpu_clock,
                                true_type)
@@ -109,6 +118,9 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::cpu_clock, true_typ
 TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::monotonic_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::monotonic_raw_clock,
                                true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::tsc_clock, true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::sampling_cpu_clock,
+                               true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::thread_cpu_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(uses_timing_units, component::process_cpu_clock, true_type)
 //
@@ -135,6 +147,7 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::cpu_clock, true_t
 TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::monotonic_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::monotonic_raw_clock,
                                true_type)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::tsc_clock, true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::thread_cpu_clock,
                                true_type)
 TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::process_cpu_clock,
@@ -142,6 +155,18 @@ TIMEMORY_DEFINE_CONCRETE_TRAIT(supports_flamegraph, component::process_cpu_clock
 //
 //--------------------------------------------------------------------------------------//
 //
+//                              IS AVAILABLE
+//
+//--------------------------------------------------------------------------------------//
+//
+//  per-thread CPU-time timers with SIGEV_THREAD_ID delivery are Linux-specific
+//
+#if !defined(_LINUX)
+TIMEMORY_DEFINE_CONCRETE_TRAIT(is_available, component::sampling_cpu_clock, false_type)
+#endif
+//
+//--------------------------------------------------------------------------------------//
+//
 //                                  DERIVATION
 //
 //--------------------------------------------------------------------------------------//
@@ -204,6 +229,11 @@ TIMEMORY_PROPERTY_SPECIALIZATION(monotonic_clock, MONOTONIC_CLOCK, "monotonic_cl
 TIMEMORY_PROPERTY_SPECIALIZATION(monotonic_raw_clock, MONOTONIC_RAW_CLOCK,
                                  "monotonic_raw_clock", "")
 
+TIMEMORY_PROPERTY_SPECIALIZATION(tsc_clock, TSC_CLOCK, "tsc_clock", "cycle_clock")
+
+TIMEMORY_PROPERTY_SPECIALIZATION(sampling_cpu_clock, SAMPLING_CPU_CLOCK,
+                                 "sampling_cpu_clock", "sampling_clock")
+
 TIMEMORY_PROPERTY_SPECIALIZATION(thread_cpu_clock, THREAD_CPU_CLOCK, "thread_cpu_clock",
                                  "")
 TIMEMORY_PROPERTY_SPECIALIZATION(process_cpu_clock, PROCESS_CPU_CLOCK,
@@ -60,7 +60,7 @@
 /// \brief The number of enumerated components defined by timemory
 //
 #if !defined(TIMEMORY_NATIVE_COMPONENT_ENUM_SIZE)
-#    define TIMEMORY_NATIVE_COMPONENT_ENUM_SIZE 64
+#    define TIMEMORY_NATIVE_COMPONENT_ENUM_SIZE 66
 #endif
 //
 /// \enum TIMEMORY_NATIVE_COMPONENT
@@ -114,11 +114,13 @@ enum TIMEMORY_NATIVE_COMPONENT
     PROCESS_CPU_CLOCK,
     PROCESS_CPU_UTIL,
     READ_BYTES,
+    SAMPLING_CPU_CLOCK,
     SYS_CLOCK,
     TAU_MARKER,
     THREAD_CPU_CLOCK,
     THREAD_CPU_UTIL,
     TRIP_COUNT,
+    TSC_CLOCK,
     USER_CLOCK,
     USER_GLOBAL_BUNDLE,
     USER_LIST_BUNDLE,
@@ -0,0 +1,340 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file timemory/ert/cache.hpp
+ * \headerfile timemory/ert/cache.hpp "timemory/ert/cache.hpp"
+ * Provides a persistent cache of the ERT results so that the ceilings of the roofline
+ * are only measured once per node type and configuration
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/dmp.hpp"
+#include "timemory/backends/process.hpp"
+#include "timemory/backends/topology.hpp"
+#include "timemory/ert/configuration.hpp"
+#include "timemory/ert/data.hpp"
+#include "timemory/hash/types.hpp"
+#include "timemory/mpl/policy.hpp"
+#include "timemory/settings/declaration.hpp"
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/utility.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(_UNIX)
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#if defined(_MACOS)
+#    include <sys/sysctl.h>
+#    include <sys/types.h>
+#endif
+
+namespace tim
+{
+namespace ert
+{
+namespace cache
+{
+//--------------------------------------------------------------------------------------//
+//
+inline std::string
+get_hostname()
+{
+#if defined(_UNIX)
+    char _buff[256];
+    if(gethostname(_buff, sizeof(_buff)) == 0)
+    {
+        _buff[sizeof(_buff) - 1] = '\0';
+        return std::string(_buff);
+    }
+#elif defined(_WINDOWS)
+    if(std::getenv("COMPUTERNAME"))
+        return std::string(std::getenv("COMPUTERNAME"));
+#endif
+    return "unknown";
+}
+
+//--------------------------------------------------------------------------------------//
+/// the model of the CPU, e.g. the "model name" field of /proc/cpuinfo
+///
+inline std::string
+get_cpu_model()
+{
+#if defined(_LINUX)
+    std::ifstream ifs("/proc/cpuinfo");
+    std::string   _line{};
+    std::string   _fallback{};
+    while(ifs && std::getline(ifs, _line))
+    {
+        auto _pos = _line.find(':');
+        if(_pos == std::string::npos || _pos == 0)
+            continue;
+        auto _field = _line.substr(0, _line.find_last_not_of(" \t", _pos - 1) + 1);
+        auto _value = _line.substr(std::min(_pos + 2, _line.length()));
+        // x86 reports "model name", POWER reports "cpu", ARM only reports the part
+        if(_field == "model name")
+            return _value;
+        if(_fallback.empty() && (_field == "cpu" || _field == "CPU part"))
+            _fallback = _value;
+    }
+    if(!_fallback.empty())
+        return _fallback;
+#elif defined(_MACOS)
+    char   _buff[256];
+    size_t _size = sizeof(_buff);
+    if(sysctlbyname("machdep.cpu.brand_string", _buff, &_size, nullptr, 0) == 0)
+        return std::string(_buff);
+#endif
+    return "unknown";
+}
+
+//--------------------------------------------------------------------------------------//
+/// the directory of the cache files: TIMEMORY_ERT_CACHE_DIR or
+/// ${XDG_CACHE_HOME:-${HOME}/.cache}/timemory/ert
+///
+inline std::string
+get_directory()
+{
+    auto _dir = settings::ert_cache_dir();
+    if(!_dir.empty())
+        return _dir;
+    if(std::getenv("XDG_CACHE_HOME"))
+        return std::string(std::getenv("XDG_CACHE_HOME")) + "/timemory/ert";
+    if(std::getenv("HOME"))
+        return std::string(std::getenv("HOME")) + "/.cache/timemory/ert";
+    return "";
+}
+
+//--------------------------------------------------------------------------------------//
+/// the node and the process: the results are only reused on the same host with the
+/// same CPU, the same number of CPUs available to the process, the same version of
+/// timemory, and the same rank and number of ranks
+///
+inline std::string
+get_system_key()
+{
+    std::stringstream ss;
+    ss << "host=" << get_hostname() << ";cpu=" << get_cpu_model()
+       << ";ncpu=" << topology::get_cpus().size() << "/"
+       << std::thread::hardware_concurrency() << ";version=" << TIMEMORY_VERSION_STRING
+       << ";rank=" << dmp::rank() << "/" << dmp::size();
+    return ss.str();
+}
+
+//--------------------------------------------------------------------------------------//
+/// the ERT parameters of a configuration
+///
+template <typename DeviceT, typename Tp, typename CounterT>
+std::string
+get_config_key(configuration<DeviceT, Tp, CounterT>& _config)
+{
+    std::stringstream ss;
+    ss << "type=" << demangle<Tp>() << ",device=" << DeviceT::name()
+       << ",counter=" << demangle<CounterT>() << ",threads=" << _config.num_threads()
+       << ",streams=" << _config.num_streams()
+       << ",min-working-size=" << _config.min_working_size()
+       << ",max-data-size=" << _config.max_data_size()
+       << ",alignment=" << _config.alignment() << ",grid-size=" << _config.grid_size()
+       << ",block-size=" << _config.block_size() << ",vec=" << TIMEMORY_VEC
+       << ",skip-ops=" << settings::ert_skip_ops()
+       << ",pin-threads=" << settings::ert_pin_threads()
+       << ",cache-sweep=" << settings::ert_cache_sweep();
+    return ss.str();
+}
+
+//--------------------------------------------------------------------------------------//
+/// create the directory only if it does not exist so that saving an entry does not
+/// launch "mkdir -p" every time
+///
+inline bool
+make_directory(const std::string& _dir)
+{
+#if defined(_UNIX)
+    struct stat _st;
+    if(stat(_dir.c_str(), &_st) == 0)
+        return S_ISDIR(_st.st_mode);
+#endif
+    return (makedir(_dir) == 0);
+}
+
+//--------------------------------------------------------------------------------------//
+/// the file is named by the (FNV-1a) hash of the key, which does not depend on the
+/// standard library, and the key is stored in the file to guard against collisions
+///
+inline std::string
+get_filename(const std::string& _key)
+{
+    auto _dir = get_directory();
+    if(_dir.empty())
+        return "";
+    std::stringstream ss;
+    ss << _dir << "/ert-" << std::hex << std::setw(16) << std::setfill('0')
+       << static_cast<uint64_t>(get_hash_id(_key)) << ".json";
+    return ss.str();
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline int64_t
+get_timestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+}
+
+//--------------------------------------------------------------------------------------//
+/// reads the results of a previous run into \param _data if the cache is enabled and
+/// a cache file with the same key exists and is not older than
+/// TIMEMORY_ERT_CACHE_MAX_AGE hours
+///
+template <typename Counter>
+bool
+load(const std::string& _key, exec_data<Counter>& _data)
+{
+    if(!settings::ert_cache())
+        return false;
+
+    auto _fname = get_filename(_key);
+    if(_fname.empty())
+        return false;
+
+    std::ifstream ifs(_fname.c_str());
+    if(!ifs)
+        return false;
+
+    using policy_type = policy::input_archive_t<Counter>;
+
+    std::string        _file_key{};
+    int64_t            _timestamp = 0;
+    exec_data<Counter> _tmp{};
+    try
+    {
+        auto ia = policy_type::get(ifs);
+        ia->setNextName("ert_cache");
+        ia->startNode();
+        (*ia)(cereal::make_nvp("key", _file_key),
+              cereal::make_nvp("timestamp", _timestamp));
+        if(_file_key != _key)
+            return false;
+        (*ia)(cereal::make_nvp("roofline", _tmp));
+        ia->finishNode();
+    } catch(std::exception& e)
+    {
+        if(settings::verbose() > 0 || settings::debug())
+            fprintf(stderr, "[ert::cache]> Error reading '%s': %s\n", _fname.c_str(),
+                    e.what());
+        return false;
+    }
+
+    auto   _max_age = settings::ert_cache_max_age();
+    double _age     = (get_timestamp() - _timestamp) / 3600.0;
+    if(_max_age > 0.0 && _age > _max_age)
+    {
+        if(settings::verbose() > 0 || settings::debug())
+            printf("[ert::cache]> Ignoring '%s' (%.1f hours old)\n", _fname.c_str(),
+                   _age);
+        return false;
+    }
+
+    if(settings::verbose() > 0 || settings::debug())
+        printf("[ert::cache]> Reusing the ERT results in '%s'\n", _fname.c_str());
+
+    _data = std::move(_tmp);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+/// writes the results to the cache file of \param _key. The file is written to a
+/// temporary file and renamed so that concurrent jobs never read a partial file
+///
+template <typename Counter>
+bool
+save(const std::string& _key, const exec_data<Counter>& _data)
+{
+    if(!settings::ert_cache())
+        return false;
+
+    auto _fname = get_filename(_key);
+    if(_fname.empty())
+        return false;
+
+    if(!make_directory(get_directory()))
+        return false;
+
+    std::stringstream _tmpname;
+    _tmpname << _fname << "." << process::get_id() << ".tmp";
+
+    std::ofstream ofs(_tmpname.str().c_str());
+    if(!ofs)
+    {
+        if(settings::verbose() > 0 || settings::debug())
+            fprintf(stderr, "[ert::cache]> Error opening '%s'\n",
+                    _tmpname.str().c_str());
+        return false;
+    }
+
+    {
+        // ensure json write final block during destruction before the file is closed
+        using policy_type = policy::output_archive_t<Counter>;
+        auto oa           = policy_type::get(ofs);
+        oa->setNextName("ert_cache");
+        oa->startNode();
+        (*oa)(cereal::make_nvp("key", _key),
+              cereal::make_nvp("timestamp", get_timestamp()),
+              cereal::make_nvp("roofline", _data));
+        oa->finishNode();
+    }
+    ofs << std::endl;
+    ofs.close();
+
+    if(std::rename(_tmpname.str().c_str(), _fname.c_str()) != 0)
+    {
+        std::remove(_tmpname.str().c_str());
+        return false;
+    }
+
+    if(settings::verbose() > 0 || settings::debug())
+        printf("[ert::cache]> Saved the ERT results to '%s'\n", _fname.c_str());
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace cache
+}  // namespace ert
+}  // namespace tim
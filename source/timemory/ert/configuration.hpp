@@ -31,6 +31,7 @@
 #pragma once
 
 #include "timemory/backends/device.hpp"
+#include "timemory/backends/topology.hpp"
 #include "timemory/components/cuda/backends.hpp"
 #include "timemory/components/timing/components.hpp"
 #include "timemory/defines.h"
@@ -38,6 +39,7 @@
 #include "timemory/ert/counter.hpp"
 #include "timemory/ert/data.hpp"
 #include "timemory/ert/kernels.hpp"
+#include "timemory/ert/sweep.hpp"
 #include "timemory/ert/types.hpp"
 #include "timemory/settings/declaration.hpp"
 
@@ -232,6 +234,11 @@ struct configuration
             for(const auto& itr : _skip_ops)
                 _counter.add_skip_ops(itr);
 
+            // pin the threads so the bandwidth does not depend on the placement by the OS
+            static constexpr bool is_gpu = device::is_gpu<DeviceT>::value;
+            if(!is_gpu && settings::ert_pin_threads())
+                _counter.cpus = topology::get_order();
+
             auto dtype = demangle(typeid(Tp).name());
 
             printf(
@@ -377,6 +384,47 @@ public:
         // run the kernels
         ops_main<VEC / 2, VEC, 2 * VEC, 4 * VEC>(_counter, fma_func, store_func);
         ops_main<TIMEMORY_USER_ERT_FLOPS>(_counter, fma_func, store_func);
+
+        // explicitly vectorized kernels for the widest instruction set of the CPU,
+        // e.g. "avx512_add" and "avx512_fma". The compiler does not reliably vectorize
+        // the kernels above so these provide the compute peak
+        simd::dispatch<Tp>([&](auto _isa) {
+            using isa_type      = decltype(_isa);
+            constexpr size_t NV = simd::vec<isa_type, Tp>::width;
+
+            _counter.label = std::string(isa_type::name()) + "_add";
+            ops_main<1>(_counter, simd::add<isa_type>{}, store_func);
+
+            _counter.label = std::string(isa_type::name()) + "_fma";
+            ops_main<NV, 4 * NV, 16 * NV, 64 * NV>(_counter, simd::fma<isa_type>{},
+                                                   store_func);
+        });
+
+        // the labels above are the ceilings of the whole node. When the threads are
+        // pinned and there are multiple sockets, the bandwidth of each socket is
+        // measured with the threads restricted to it, e.g. "scalar_add_socket1"
+        auto _sockets = topology::get_sockets();
+        if(_sockets.size() > 1 && !_counter.cpus.empty())
+        {
+            auto _cpus     = _counter.cpus;
+            auto _nthreads = _counter.params.nthreads;
+            for(auto itr : _sockets)
+            {
+                _counter.cpus = topology::get_order(itr);
+                _counter.params.nthreads =
+                    std::min<uint64_t>(_nthreads, _counter.cpus.size());
+                _counter.label = "scalar_add_socket" + std::to_string(itr);
+                ops_main<1>(_counter, add_func, store_func);
+            }
+            _counter.cpus            = _cpus;
+            _counter.params.nthreads = _nthreads;
+        }
+
+        // the bandwidth and latency of each level of the memory hierarchy. These do
+        // not depend on the data type so they are only measured for the first type
+        if(settings::ert_cache_sweep() && _counter.data &&
+           _counter.data->get_ceilings().empty())
+            sweep::cache_main(_counter);
     }
 };
 
@@ -78,6 +78,7 @@ public:
     using data_ptr_t    = std::shared_ptr<ert_data_t>;
     using ull           = unsigned long long;
     using skip_ops_t    = std::unordered_set<size_t>;
+    using cpu_list_t    = std::vector<int64_t>;
 
 public:
     //----------------------------------------------------------------------------------//
@@ -278,6 +279,14 @@ public:
 
     bool skip(size_t _Nops) { return (skip_ops.count(_Nops) > 0); }
 
+    //----------------------------------------------------------------------------------//
+    //  The CPU which the thread is pinned to (negative if the threads are not pinned)
+    //
+    int64_t get_cpu(uint64_t tid) const
+    {
+        return (cpus.empty()) ? -1 : cpus.at(tid % cpus.size());
+    }
+
 public:
     //----------------------------------------------------------------------------------//
     //  public data members, modify as needed
@@ -290,6 +299,7 @@ public:
     data_ptr_t  data                        = std::make_shared<ert_data_t>();
     std::string label                       = "";
     skip_ops_t  skip_ops                    = skip_ops_t();
+    cpu_list_t  cpus                        = cpu_list_t();
 
 protected:
     callback_type configure_callback = [](uint64_t, this_type&) {};
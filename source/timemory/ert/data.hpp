@@ -46,6 +46,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iomanip>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
@@ -121,6 +122,47 @@ struct exec_params
     }
 };
 
+//--------------------------------------------------------------------------------------//
+//  bandwidth and latency ceilings of a level of the memory hierarchy
+//
+struct cache_ceiling
+{
+    std::string level           = "";  // "L1", "L2", "L3", or "DRAM"
+    uint64_t    size            = 0;   // size of the level in bytes
+    uint64_t    working_set     = 0;   // per-thread working set of the measurement
+    uint64_t    nthreads        = 1;
+    double      read_bandwidth  = 0.0;  // bytes per second
+    double      write_bandwidth = 0.0;  // bytes per second
+    double      copy_bandwidth  = 0.0;  // bytes per second
+    double      triad_bandwidth = 0.0;  // bytes per second
+    double      latency         = 0.0;  // nanoseconds per dependent load
+
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        ar(cereal::make_nvp("level", level), cereal::make_nvp("size", size),
+           cereal::make_nvp("working-set", working_set),
+           cereal::make_nvp("nthreads", nthreads),
+           cereal::make_nvp("read-bandwidth", read_bandwidth),
+           cereal::make_nvp("write-bandwidth", write_bandwidth),
+           cereal::make_nvp("copy-bandwidth", copy_bandwidth),
+           cereal::make_nvp("triad-bandwidth", triad_bandwidth),
+           cereal::make_nvp("latency", latency));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const cache_ceiling& obj)
+    {
+        std::stringstream ss;
+        ss << std::setw(4) << obj.level << " (size = " << obj.size
+           << ", working_set = " << obj.working_set << ", nthreads = " << obj.nthreads
+           << "): read = " << obj.read_bandwidth << ", write = " << obj.write_bandwidth
+           << ", copy = " << obj.copy_bandwidth << ", triad = " << obj.triad_bandwidth
+           << " bytes/sec, latency = " << obj.latency << " nsec";
+        os << ss.str();
+        return os;
+    }
+};
+
 //--------------------------------------------------------------------------------------//
 //  execution data -- reuse this for multiple types
 //
@@ -135,6 +177,7 @@ public:
     using size_type      = typename value_array::size_type;
     using iterator       = typename value_array::iterator;
     using const_iterator = typename value_array::const_iterator;
+    using ceiling_array  = std::vector<cache_ceiling>;
 
     //----------------------------------------------------------------------------------//
     //
@@ -156,6 +199,12 @@ public:
     iterator       end() { return m_values.end(); }
     const_iterator end() const { return m_values.end(); }
 
+    //----------------------------------------------------------------------------------//
+    //  per-level ceilings of the memory hierarchy, see timemory/ert/sweep.hpp
+    //
+    void                 set_ceilings(const ceiling_array& _v) { m_ceilings = _v; }
+    const ceiling_array& get_ceilings() const { return m_ceilings; }
+
 public:
     //----------------------------------------------------------------------------------//
     //
@@ -178,6 +227,8 @@ public:
 
         for(const auto& itr : rhs.m_values)
             m_values.push_back(itr);
+        for(const auto& itr : rhs.m_ceilings)
+            m_ceilings.push_back(itr);
         return *this;
     }
 
@@ -198,6 +249,8 @@ public:
             obj.write<5>(ss, itr, ", ", 12);
             obj.write<6>(ss, itr, "\n", 12);
         }
+        for(const auto& itr : obj.m_ceilings)
+            ss << std::setw(24) << "ceiling" << ": " << itr << "\n";
         os << ss.str();
         return os;
     }
@@ -220,6 +273,8 @@ public:
             ar.finishNode();
         }
         ar.finishNode();
+
+        ar(cereal::make_nvp("ceilings", m_ceilings));
     }
 
     //----------------------------------------------------------------------------------//
@@ -241,13 +296,23 @@ public:
             ar.finishNode();
         }
         ar.finishNode();
+
+        // not present in the output of older versions
+        try
+        {
+            ar(cereal::make_nvp("ceilings", m_ceilings));
+        } catch(std::exception&)
+        {
+            m_ceilings.clear();
+        }
     }
 
 protected:
-    labels_type m_labels = { { "label", "working-set", "trials", "total-bytes",
-                               "total-ops", "ops-per-set", "counter", "device", "dtype",
-                               "exec-params" } };
-    value_array m_values;
+    labels_type   m_labels = { { "label", "working-set", "trials", "total-bytes",
+                                 "total-ops", "ops-per-set", "counter", "device", "dtype",
+                                 "exec-params" } };
+    value_array   m_values;
+    ceiling_array m_ceilings;
 
 private:
     //----------------------------------------------------------------------------------//
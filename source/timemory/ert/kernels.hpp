@@ -32,9 +32,12 @@
 
 #include "timemory/backends/device.hpp"
 #include "timemory/backends/dmp.hpp"
+#include "timemory/backends/thread_pool.hpp"
+#include "timemory/backends/topology.hpp"
 #include "timemory/components/cuda/backends.hpp"
 #include "timemory/ert/counter.hpp"
 #include "timemory/ert/data.hpp"
+#include "timemory/ert/simd.hpp"
 #include "timemory/mpl/apply.hpp"
 #include "timemory/settings/declaration.hpp"
 #include "timemory/utility/macros.hpp"
@@ -61,7 +64,8 @@ namespace ert
 //--------------------------------------------------------------------------------------//
 
 template <size_t Nrep, typename DeviceT, typename Intp, typename Tp, typename OpsFuncT,
-          typename StoreFuncT, device::enable_if_cpu_t<DeviceT> = 0>
+          typename StoreFuncT, device::enable_if_cpu_t<DeviceT> = 0,
+          enable_if_t<!(simd::is_op<decay_t<OpsFuncT>>::value)> = 0>
 void
 ops_kernel(Intp ntrials, Intp nsize, Tp* A, OpsFuncT&& ops_func, StoreFuncT&& store_func)
 {
@@ -83,6 +87,24 @@ ops_kernel(Intp ntrials, Intp nsize, Tp* A, OpsFuncT&& ops_func, StoreFuncT&& st
     }
 }
 
+//--------------------------------------------------------------------------------------//
+//
+//      CPU -- multiple trial -- explicitly vectorized
+//
+//--------------------------------------------------------------------------------------//
+
+template <size_t Nrep, typename DeviceT, typename Intp, typename Tp, typename OpsFuncT,
+          typename StoreFuncT, device::enable_if_cpu_t<DeviceT> = 0,
+          enable_if_t<(simd::is_op<decay_t<OpsFuncT>>::value)> = 0>
+void
+ops_kernel(Intp ntrials, Intp nsize, Tp* A, OpsFuncT&&, StoreFuncT&&)
+{
+    // the operation and the store are part of the kernel for the instruction set
+    using op_type  = decay_t<OpsFuncT>;
+    using isa_type = typename op_type::isa_type;
+    simd::kernel<Nrep, op_type>(isa_type{}, ntrials, nsize, A);
+}
+
 //--------------------------------------------------------------------------------------//
 //
 //      GPU -- multiple trial
@@ -158,7 +180,6 @@ ops_main(counter<DeviceT, Tp, CounterT>& _counter, OpsFuncT&& ops_func,
         return;
 
     using stream_list_t   = std::vector<cuda::stream_t>;
-    using thread_list_t   = std::vector<std::thread>;
     using device_params_t = device::params<DeviceT>;
     using Intp            = int32_t;
     using ull             = long long unsigned;
@@ -191,6 +212,9 @@ ops_main(counter<DeviceT, Tp, CounterT>& _counter, OpsFuncT&& ops_func,
         using opmutex_t = std::mutex;
         using oplock_t  = std::unique_lock<opmutex_t>;
         static opmutex_t opmutex;
+        // pin the thread before the buffer is allocated so that the first-touch during
+        // the initialization places the buffer in the NUMA node of the thread
+        topology::scoped_pin _pin(_counter.get_cpu(tid));
         {
             oplock_t _lock(opmutex);
             // execute the callback
@@ -341,11 +365,10 @@ ops_main(counter<DeviceT, Tp, CounterT>& _counter, OpsFuncT&& ops_func,
         thread_barrier fbarrier(_counter.params.nthreads);
         thread_barrier lbarrier(_counter.params.nthreads);
 
-        // list of threads
-        thread_list_t threads;
-        // create the threads
-        for(uint64_t i = 0; i < _counter.params.nthreads; ++i)
-            threads.push_back(std::thread(_opfunc, i, &fbarrier, &lbarrier));
+        // the kernels synchronize with each other so every thread must run at once
+        threading::thread_pool::instance().run_concurrent(
+            _counter.params.nthreads,
+            [&](uint64_t i) { _opfunc(i, &fbarrier, &lbarrier); });
 
         /*
         uint64_t n = _counter.params.working_set_min;
@@ -359,10 +382,6 @@ ops_main(counter<DeviceT, Tp, CounterT>& _counter, OpsFuncT&& ops_func,
             lbarrier.notify_wait();
             n = ((1.1 * n) == n) ? (n + 1) : (1.1 * n);
         }*/
-
-        // wait for threads to finish
-        for(auto& itr : threads)
-            itr.join();
     }
     else
     {
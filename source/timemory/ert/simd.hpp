@@ -0,0 +1,367 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file timemory/ert/simd.hpp
+ * \headerfile timemory/ert/simd.hpp "timemory/ert/simd.hpp"
+ * Provides explicitly vectorized CPU kernels for ERT and the runtime selection of the
+ * instruction set
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if(defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) &&                   \
+    !defined(__CUDACC__) && !defined(TIMEMORY_ERT_DISABLE_SIMD)
+#    define TIMEMORY_ERT_SIMD_X86
+#    include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(TIMEMORY_ERT_DISABLE_SIMD)
+#    define TIMEMORY_ERT_SIMD_NEON
+#    include <arm_neon.h>
+#endif
+
+// the kernels are compiled for every instruction set and selected at runtime so the
+// target of each kernel is set independently of the flags of the translation unit
+#if defined(TIMEMORY_ERT_SIMD_X86)
+#    define TIMEMORY_ERT_SSE2 __attribute__((target("sse2")))
+#    define TIMEMORY_ERT_AVX2 __attribute__((target("avx2,fma")))
+#    define TIMEMORY_ERT_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#if defined(__clang__)
+#    define TIMEMORY_ERT_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && (__GNUC__ >= 8)
+#    define TIMEMORY_ERT_UNROLL _Pragma("GCC unroll 16")
+#else
+#    define TIMEMORY_ERT_UNROLL
+#endif
+
+namespace tim
+{
+namespace ert
+{
+namespace simd
+{
+//--------------------------------------------------------------------------------------//
+//
+//      instruction sets
+//
+//--------------------------------------------------------------------------------------//
+
+struct none
+{
+    static const char* name() { return "none"; }
+};
+
+struct sse2
+{
+    static const char* name() { return "sse2"; }
+};
+
+struct avx2
+{
+    static const char* name() { return "avx2"; }
+};
+
+struct avx512
+{
+    static const char* name() { return "avx512"; }
+};
+
+struct neon
+{
+    static const char* name() { return "neon"; }
+};
+
+//--------------------------------------------------------------------------------------//
+/// vector type and operations of the instruction set \param IsaT for \param Tp
+///
+template <typename IsaT, typename Tp>
+struct vec
+{
+    static constexpr bool value = false;
+};
+
+template <typename IsaT, typename Tp>
+using is_supported = std::integral_constant<bool, vec<IsaT, Tp>::value>;
+
+//--------------------------------------------------------------------------------------//
+/// number of independent vectors which are updated in each iteration. Consecutive
+/// operations on the same vector are dependent so the kernel must interleave at least
+/// latency x throughput (e.g. 4 cycles x 2 FMA units) vectors to reach the peak
+///
+static constexpr size_t num_chains = 8;
+
+//--------------------------------------------------------------------------------------//
+//
+//      operations
+//
+//--------------------------------------------------------------------------------------//
+/// a = a * b + c (two operations)
+///
+template <typename IsaT>
+struct fma
+{
+    using isa_type = IsaT;
+
+    static constexpr size_t ops = 2;
+
+    template <typename Tp>
+    static void scalar(Tp& a, const Tp& b, const Tp& c)
+    {
+        a = a * b + c;
+    }
+};
+
+/// a = b + c (one operation)
+///
+template <typename IsaT>
+struct add
+{
+    using isa_type = IsaT;
+
+    static constexpr size_t ops = 1;
+
+    template <typename Tp>
+    static void scalar(Tp& a, const Tp& b, const Tp& c)
+    {
+        a = b + c;
+    }
+};
+
+template <typename Tp>
+struct is_op : std::false_type
+{};
+
+template <typename IsaT>
+struct is_op<fma<IsaT>> : std::true_type
+{};
+
+template <typename IsaT>
+struct is_op<add<IsaT>> : std::true_type
+{};
+
+//--------------------------------------------------------------------------------------//
+//
+//      x86: SSE2 (baseline of x86-64, no FMA), AVX2 + FMA, AVX-512
+//
+//--------------------------------------------------------------------------------------//
+
+#if defined(TIMEMORY_ERT_SIMD_X86)
+
+#    define TIMEMORY_ERT_SIMD_VEC(ISA, TARGET, TYPE, VTYPE, WIDTH, PFX, SFX, FMA)        \
+        template <>                                                                      \
+        struct vec<ISA, TYPE>                                                            \
+        {                                                                                \
+            static constexpr bool   value = true;                                        \
+            static constexpr size_t width = WIDTH;                                       \
+            using type                    = VTYPE;                                       \
+            TARGET static type load(const TYPE* p) { return PFX##_loadu_##SFX(p); }      \
+            TARGET static void store(TYPE* p, type v) { PFX##_storeu_##SFX(p, v); }      \
+            TARGET static type set1(TYPE v) { return PFX##_set1_##SFX(v); }              \
+            TARGET static type add(type b, type c) { return PFX##_add_##SFX(b, c); }     \
+            TARGET static type fma(type a, type b, type c) { return FMA; }               \
+        };
+
+TIMEMORY_ERT_SIMD_VEC(sse2, TIMEMORY_ERT_SSE2, float, __m128, 4, _mm, ps,
+                      _mm_add_ps(_mm_mul_ps(a, b), c))
+TIMEMORY_ERT_SIMD_VEC(sse2, TIMEMORY_ERT_SSE2, double, __m128d, 2, _mm, pd,
+                      _mm_add_pd(_mm_mul_pd(a, b), c))
+TIMEMORY_ERT_SIMD_VEC(avx2, TIMEMORY_ERT_AVX2, float, __m256, 8, _mm256, ps,
+                      _mm256_fmadd_ps(a, b, c))
+TIMEMORY_ERT_SIMD_VEC(avx2, TIMEMORY_ERT_AVX2, double, __m256d, 4, _mm256, pd,
+                      _mm256_fmadd_pd(a, b, c))
+TIMEMORY_ERT_SIMD_VEC(avx512, TIMEMORY_ERT_AVX512, float, __m512, 16, _mm512, ps,
+                      _mm512_fmadd_ps(a, b, c))
+TIMEMORY_ERT_SIMD_VEC(avx512, TIMEMORY_ERT_AVX512, double, __m512d, 8, _mm512, pd,
+                      _mm512_fmadd_pd(a, b, c))
+
+#    undef TIMEMORY_ERT_SIMD_VEC
+
+#endif
+
+//--------------------------------------------------------------------------------------//
+//
+//      aarch64: NEON (always available)
+//
+//--------------------------------------------------------------------------------------//
+
+#if defined(TIMEMORY_ERT_SIMD_NEON)
+
+template <>
+struct vec<neon, float>
+{
+    static constexpr bool   value = true;
+    static constexpr size_t width = 4;
+    using type                    = float32x4_t;
+    static type load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, type v) { vst1q_f32(p, v); }
+    static type set1(float v) { return vdupq_n_f32(v); }
+    static type add(type b, type c) { return vaddq_f32(b, c); }
+    static type fma(type a, type b, type c) { return vfmaq_f32(c, a, b); }
+};
+
+template <>
+struct vec<neon, double>
+{
+    static constexpr bool   value = true;
+    static constexpr size_t width = 2;
+    using type                    = float64x2_t;
+    static type load(const double* p) { return vld1q_f64(p); }
+    static void store(double* p, type v) { vst1q_f64(p, v); }
+    static type set1(double v) { return vdupq_n_f64(v); }
+    static type add(type b, type c) { return vaddq_f64(b, c); }
+    static type fma(type a, type b, type c) { return vfmaq_f64(c, a, b); }
+};
+
+#endif
+
+//--------------------------------------------------------------------------------------//
+//
+//      kernels
+//
+//--------------------------------------------------------------------------------------//
+/// Same computation as the scalar ops_kernel: for every element, \param Nrep
+/// operations (halved for FMA) are applied to a value initialized to 0.8 and the result
+/// is stored in the element. The elements are processed in blocks of num_chains
+/// vectors and the remainder is processed with scalar operations
+///
+#define TIMEMORY_ERT_SIMD_KERNEL(ISA, TARGET)                                            \
+    template <size_t Nrep, typename OpT, typename Intp, typename Tp>                     \
+    TARGET void kernel(ISA, Intp ntrials, Intp nsize, Tp* A)                             \
+    {                                                                                    \
+        using vec_t = vec<ISA, Tp>;                                                      \
+        using type  = typename vec_t::type;                                              \
+                                                                                         \
+        constexpr bool   is_fma  = std::is_same<OpT, fma<ISA>>::value;                   \
+        constexpr size_t NUM_REP = Nrep / OpT::ops + Nrep % OpT::ops;                    \
+        constexpr Intp   WIDTH   = vec_t::width;                                         \
+        constexpr Intp   BLOCK   = WIDTH * num_chains;                                   \
+        const Intp       nvec    = nsize - (nsize % BLOCK);                              \
+                                                                                         \
+        Tp alpha = static_cast<Tp>(0.5);                                                 \
+        for(Intp j = 0; j < ntrials; ++j)                                                \
+        {                                                                                \
+            type _alpha = vec_t::set1(alpha);                                            \
+            for(Intp i = 0; i < nvec; i += BLOCK)                                        \
+            {                                                                            \
+                type _a[num_chains];                                                     \
+                type _beta[num_chains];                                                  \
+                TIMEMORY_ERT_UNROLL                                                      \
+                for(size_t k = 0; k < num_chains; ++k)                                   \
+                {                                                                        \
+                    _a[k]    = vec_t::load(A + i + k * WIDTH);                           \
+                    _beta[k] = vec_t::set1(static_cast<Tp>(0.8));                        \
+                }                                                                        \
+                for(size_t r = 0; r < NUM_REP; ++r)                                      \
+                {                                                                        \
+                    TIMEMORY_ERT_UNROLL                                                  \
+                    for(size_t k = 0; k < num_chains; ++k)                               \
+                        _beta[k] = (is_fma) ? vec_t::fma(_beta[k], _a[k], _alpha)        \
+                                            : vec_t::add(_a[k], _alpha);                 \
+                }                                                                        \
+                TIMEMORY_ERT_UNROLL                                                      \
+                for(size_t k = 0; k < num_chains; ++k)                                   \
+                    vec_t::store(A + i + k * WIDTH, _beta[k]);                           \
+            }                                                                            \
+            for(Intp i = nvec; i < nsize; ++i)                                           \
+            {                                                                            \
+                Tp beta = static_cast<Tp>(0.8);                                          \
+                for(size_t r = 0; r < NUM_REP; ++r)                                      \
+                    OpT::scalar(beta, A[i], alpha);                                      \
+                A[i] = beta;                                                             \
+            }                                                                            \
+            alpha *= static_cast<Tp>(1.0 - 1.0e-8);                                      \
+        }                                                                                \
+    }
+
+#if defined(TIMEMORY_ERT_SIMD_X86)
+TIMEMORY_ERT_SIMD_KERNEL(sse2, TIMEMORY_ERT_SSE2)
+TIMEMORY_ERT_SIMD_KERNEL(avx2, TIMEMORY_ERT_AVX2)
+TIMEMORY_ERT_SIMD_KERNEL(avx512, TIMEMORY_ERT_AVX512)
+#endif
+
+#if defined(TIMEMORY_ERT_SIMD_NEON)
+TIMEMORY_ERT_SIMD_KERNEL(neon, )
+#endif
+
+#undef TIMEMORY_ERT_SIMD_KERNEL
+
+//--------------------------------------------------------------------------------------//
+//
+//      runtime selection
+//
+//--------------------------------------------------------------------------------------//
+
+namespace impl
+{
+template <typename IsaT, typename FuncT>
+bool
+invoke(std::true_type, FuncT&& _func)
+{
+    std::forward<FuncT>(_func)(IsaT{});
+    return true;
+}
+
+template <typename IsaT, typename FuncT>
+bool
+invoke(std::false_type, FuncT&&)
+{
+    return false;
+}
+}  // namespace impl
+
+//--------------------------------------------------------------------------------------//
+/// invokes \param _func with the widest instruction set which is supported by the CPU
+/// and provides vectors of \param Tp. Returns false if there is no such instruction set
+///
+template <typename Tp, typename FuncT>
+bool
+dispatch(FuncT&& _func)
+{
+#if defined(TIMEMORY_ERT_SIMD_X86)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return impl::invoke<avx512>(is_supported<avx512, Tp>{},
+                                    std::forward<FuncT>(_func));
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return impl::invoke<avx2>(is_supported<avx2, Tp>{}, std::forward<FuncT>(_func));
+    if(__builtin_cpu_supports("sse2"))
+        return impl::invoke<sse2>(is_supported<sse2, Tp>{}, std::forward<FuncT>(_func));
+#elif defined(TIMEMORY_ERT_SIMD_NEON)
+    return impl::invoke<neon>(is_supported<neon, Tp>{}, std::forward<FuncT>(_func));
+#endif
+    (void) _func;
+    return false;
+}
+
+}  // namespace simd
+}  // namespace ert
+}  // namespace tim
@@ -0,0 +1,565 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \file timemory/ert/sweep.hpp
+ * \headerfile timemory/ert/sweep.hpp "timemory/ert/sweep.hpp"
+ * Provides the read, write, copy, triad, and pointer-chasing kernels which measure
+ * the bandwidth and latency of each level of the memory hierarchy for ERT
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/device.hpp"
+#include "timemory/backends/dmp.hpp"
+#include "timemory/backends/thread_pool.hpp"
+#include "timemory/backends/topology.hpp"
+#include "timemory/ert/aligned_allocator.hpp"
+#include "timemory/ert/barrier.hpp"
+#include "timemory/ert/cache_size.hpp"
+#include "timemory/ert/counter.hpp"
+#include "timemory/ert/data.hpp"
+#include "timemory/settings/declaration.hpp"
+#include "timemory/utility/macros.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace tim
+{
+namespace ert
+{
+namespace sweep
+{
+//--------------------------------------------------------------------------------------//
+/// prevents the compiler from eliding or merging the stores of successive trials
+///
+inline void
+clobber()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      Kernels
+//
+//--------------------------------------------------------------------------------------//
+/// read-only: independent partial sums so that the loads are not serialized by the
+/// latency of the add
+///
+template <typename Tp>
+Tp
+read_kernel(const Tp* a, uint64_t n)
+{
+    std::array<Tp, 8> _sum{};
+    uint64_t          i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        for(uint64_t j = 0; j < 8; ++j)
+            _sum[j] += a[i + j];
+    }
+    for(; i < n; ++i)
+        _sum[0] += a[i];
+    return std::accumulate(_sum.begin(), _sum.end(), Tp{ 0 });
+}
+
+/// write-only
+template <typename Tp>
+void
+write_kernel(Tp* a, uint64_t n, Tp value)
+{
+    for(uint64_t i = 0; i < n; ++i)
+        a[i] = value;
+}
+
+/// copy: b = a
+template <typename Tp>
+void
+copy_kernel(Tp* b, const Tp* a, uint64_t n)
+{
+    for(uint64_t i = 0; i < n; ++i)
+        b[i] = a[i];
+}
+
+/// triad: a = b + s * c
+template <typename Tp>
+void
+triad_kernel(Tp* a, const Tp* b, const Tp* c, Tp s, uint64_t n)
+{
+    for(uint64_t i = 0; i < n; ++i)
+        a[i] = b[i] + s * c[i];
+}
+
+//--------------------------------------------------------------------------------------//
+/// node of the pointer-chasing chain, one per cache line
+///
+struct alignas(64) chase_node
+{
+    chase_node* next = nullptr;
+    char        pad[64 - sizeof(chase_node*)];
+};
+
+/// links the nodes into a single random cycle (Sattolo's algorithm) so that the
+/// hardware prefetchers cannot predict the next cache line
+inline void
+make_chain(chase_node* nodes, uint64_t n)
+{
+    std::vector<uint64_t> _order(n);
+    std::iota(_order.begin(), _order.end(), 0);
+    std::mt19937_64 _rng(n);
+    for(uint64_t i = n - 1; i > 0; --i)
+    {
+        std::uniform_int_distribution<uint64_t> _dist(0, i - 1);
+        std::swap(_order.at(i), _order.at(_dist(_rng)));
+    }
+    for(uint64_t i = 0; i < n; ++i)
+        nodes[_order.at(i)].next = &nodes[_order.at((i + 1) % n)];
+}
+
+/// latency: every load depends on the previous one
+inline chase_node*
+latency_kernel(chase_node* p, uint64_t nsteps)
+{
+    for(uint64_t i = 0; i < nsteps; ++i)
+        p = p->next;
+    return p;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      Working sets
+//
+//--------------------------------------------------------------------------------------//
+/// the size of a level of the memory hierarchy and the share of each thread: L1 and
+/// L2 are assumed to be private, L3 is shared by the threads on a socket
+///
+struct level_info
+{
+    std::string name  = "";
+    uint64_t    size  = 0;
+    uint64_t    share = 0;
+};
+
+using level_list_t = std::vector<level_info>;
+
+/// the largest number of the \param _nthreads threads on one socket when thread i is
+/// pinned to _cpus[i % _cpus.size()] (see counter::get_cpu). Threads which are not
+/// pinned are assumed to be spread evenly over the sockets
+inline uint64_t
+get_threads_per_socket(uint64_t _nthreads, const topology::int_list_t& _cpus)
+{
+    _nthreads = std::max<uint64_t>(_nthreads, 1);
+    if(_cpus.empty())
+    {
+        uint64_t _nsock = std::max<uint64_t>(topology::get_sockets().size(), 1);
+        return (_nthreads + _nsock - 1) / _nsock;
+    }
+
+    std::map<int64_t, int64_t> _sockets{};
+    for(const auto& itr : topology::get_cpus())
+        _sockets[itr.cpu] = itr.socket;
+
+    std::map<int64_t, uint64_t> _count{};
+    uint64_t                    _ret = 1;
+    for(uint64_t i = 0; i < _nthreads; ++i)
+    {
+        auto _cpu    = _cpus.at(i % _cpus.size());
+        auto _socket = (_sockets.count(_cpu) > 0) ? _sockets.at(_cpu) : 0;
+        _ret         = std::max<uint64_t>(_ret, ++_count[_socket]);
+    }
+    return _ret;
+}
+
+/// the levels for the sizes of the L1, L2, and L3 caches in \param _sizes (zero if
+/// unknown) when \param _nthreads threads are pinned to \param _cpus. The L3 share is
+/// that of the socket with the most threads
+inline level_list_t
+get_levels(const std::array<uint64_t, 3>& _sizes, uint64_t _nthreads,
+           uint64_t _memory_max, const topology::int_list_t& _cpus = {})
+{
+    _nthreads         = std::max<uint64_t>(_nthreads, 1);
+    uint64_t _nshared = get_threads_per_socket(_nthreads, _cpus);
+
+    level_list_t _ret{};
+    for(size_t i = 0; i < _sizes.size(); ++i)
+    {
+        uint64_t _size  = _sizes.at(i);
+        uint64_t _share = (i < 2) ? _size : (_size / _nshared);
+        // skip levels which are not larger than the previous level per thread
+        if(_size == 0 || (!_ret.empty() && _share <= _ret.back().share))
+            continue;
+        _ret.emplace_back(level_info{ "L" + std::to_string(i + 1), _size, _share });
+    }
+
+    uint64_t _prev = (_ret.empty()) ? 0 : _ret.back().share;
+    uint64_t _dram = std::max<uint64_t>(_memory_max / _nthreads, 4 * _prev);
+    _ret.emplace_back(level_info{ "DRAM", _memory_max, _dram });
+    return _ret;
+}
+
+/// the levels of this system, see above
+inline level_list_t
+get_levels(uint64_t _nthreads, uint64_t _memory_max,
+           const topology::int_list_t& _cpus = {})
+{
+    std::array<uint64_t, 3> _sizes{};
+    for(size_t i = 0; i < _sizes.size(); ++i)
+    {
+        try
+        {
+            _sizes.at(i) = cache_size::get(i + 1);
+        } catch(std::exception&)
+        {
+            _sizes.at(i) = 0;
+        }
+    }
+    return get_levels(_sizes, _nthreads, _memory_max, _cpus);
+}
+
+/// working sets (bytes per thread) below and above the boundary of each level. The
+/// last one, in DRAM, is limited by exec_params::memory_max
+inline std::vector<uint64_t>
+get_working_sets(const level_list_t& _levels)
+{
+    std::vector<uint64_t> _ret{};
+    for(size_t i = 0; i < _levels.size(); ++i)
+    {
+        if(i + 1 == _levels.size())
+        {
+            _ret.emplace_back(_levels.at(i).share);
+            break;
+        }
+        for(double _frac : { 0.25, 0.5, 0.75, 1.5 })
+            _ret.emplace_back(_frac * _levels.at(i).share);
+    }
+    std::sort(_ret.begin(), _ret.end());
+    _ret.erase(std::unique(_ret.begin(), _ret.end()), _ret.end());
+    return _ret;
+}
+
+/// the level whose bandwidth or latency a working set measures or -1 if the working
+/// set straddles two levels: the working set must fit comfortably in the level and
+/// be large enough that the previous level does not contribute
+inline int64_t
+classify(const level_list_t& _levels, uint64_t _working_set)
+{
+    uint64_t _prev = 0;
+    for(size_t i = 0; i < _levels.size(); ++i)
+    {
+        const auto& _level = _levels.at(i);
+        bool        _last  = (i + 1 == _levels.size());
+        if(_working_set >= 2 * _prev && (_last || _working_set <= 0.8 * _level.share))
+            return static_cast<int64_t>(i);
+        if(_working_set <= _level.share)
+            return -1;
+        _prev = _level.share;
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//      Drivers
+//
+//--------------------------------------------------------------------------------------//
+/// the kernels of the bandwidth sweep and the number of arrays each one streams
+///
+enum class kernel_id : int
+{
+    read = 0,
+    write,
+    copy,
+    triad,
+    count
+};
+
+static constexpr int num_kernels = static_cast<int>(kernel_id::count);
+
+//--------------------------------------------------------------------------------------//
+/// runs the read, write, copy, and triad kernels on \param _counter.params.nthreads
+/// threads (pinned like ops_main) for each working set and returns the aggregate
+/// bandwidth in bytes per second, indexed by [working set][kernel]
+///
+template <typename DeviceT, typename Tp, typename CounterT,
+          device::enable_if_cpu_t<DeviceT> = 0>
+std::vector<std::array<double, num_kernels>>
+bandwidth_main(counter<DeviceT, Tp, CounterT>&  _counter,
+               const std::vector<uint64_t>& _working_sets)
+{
+    using clock_type = std::chrono::steady_clock;
+    using result_t   = std::array<double, num_kernels>;
+
+    constexpr uint64_t nrepeat      = 3;
+    constexpr uint64_t target_bytes = 64 * (1 << 20);
+
+    const uint64_t nthreads = std::max<uint64_t>(_counter.params.nthreads, 1);
+    const uint64_t max_ws =
+        *std::max_element(_working_sets.begin(), _working_sets.end()) + 64;
+
+    std::vector<result_t> _result(_working_sets.size(), result_t{});
+
+    auto _bwfunc = [&](uint64_t tid, thread_barrier* fbarrier, thread_barrier* lbarrier) {
+        // pin before the first-touch of the buffer, see ops_main
+        topology::scoped_pin _pin(_counter.get_cpu(tid));
+
+        const uint64_t _nelem = (max_ws + sizeof(Tp) - 1) / sizeof(Tp);
+        Tp*            _buf   = allocate_aligned<Tp, DeviceT>(_nelem, 64);
+        write_kernel(_buf, _nelem, Tp{ 1 });
+        volatile Tp _sink = Tp{ 0 };
+
+        for(size_t w = 0; w < _working_sets.size(); ++w)
+        {
+            const uint64_t _ws      = _working_sets.at(w);
+            const uint64_t _ntrials = std::max<uint64_t>(target_bytes / _ws, 1);
+            for(int k = 0; k < num_kernels; ++k)
+            {
+                auto     _kernel = static_cast<kernel_id>(k);
+                uint64_t _narray = (_kernel == kernel_id::copy)    ? 2
+                                   : (_kernel == kernel_id::triad) ? 3
+                                                                   : 1;
+                uint64_t _n      = _ws / _narray / sizeof(Tp);
+                Tp*      _a      = _buf;
+                Tp*      _b      = _buf + _n;
+                Tp*      _c      = _buf + 2 * _n;
+                double   _best   = std::numeric_limits<double>::max();
+
+                for(uint64_t r = 0; r < nrepeat; ++r)
+                {
+                    if(fbarrier)
+                        fbarrier->spin_wait();
+
+                    auto _beg = clock_type::now();
+                    for(uint64_t t = 0; t < _ntrials; ++t)
+                    {
+                        switch(_kernel)
+                        {
+                            case kernel_id::read: _sink = read_kernel(_a, _n); break;
+                            case kernel_id::write:
+                                write_kernel(_a, _n, static_cast<Tp>(t));
+                                break;
+                            case kernel_id::copy: copy_kernel(_b, _a, _n); break;
+                            case kernel_id::triad:
+                                triad_kernel(_a, _b, _c, Tp{ 3 }, _n);
+                                break;
+                            case kernel_id::count: break;
+                        }
+                        clobber();
+                    }
+
+                    if(lbarrier)
+                        lbarrier->spin_wait();
+                    auto _end = clock_type::now();
+
+                    _best = std::min<double>(
+                        _best, std::chrono::duration<double>(_end - _beg).count());
+                }
+
+                if(tid == 0 && _best > 0.0)
+                {
+                    double _bytes = _ntrials * _narray * _n * sizeof(Tp);
+                    _result.at(w).at(k) = nthreads * _bytes / _best;
+                }
+            }
+        }
+
+        _sink = _sink + _buf[0];
+        free_aligned<Tp, DeviceT>(_buf);
+    };
+
+    if(nthreads > 1)
+    {
+        thread_barrier fbarrier(nthreads);
+        thread_barrier lbarrier(nthreads);
+
+        threading::thread_pool::instance().run_concurrent(
+            nthreads, [&](uint64_t i) { _bwfunc(i, &fbarrier, &lbarrier); });
+    }
+    else
+    {
+        _bwfunc(0, nullptr, nullptr);
+    }
+
+    return _result;
+}
+
+//--------------------------------------------------------------------------------------//
+/// chases the pointers of a random cycle spanning each working set on a single thread
+/// and returns the nanoseconds per load
+///
+template <typename DeviceT, typename Tp, typename CounterT,
+          device::enable_if_cpu_t<DeviceT> = 0>
+std::vector<double>
+latency_main(counter<DeviceT, Tp, CounterT>& _counter,
+             const std::vector<uint64_t>&    _working_sets)
+{
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr uint64_t nsteps = (1 << 21);
+
+    topology::scoped_pin _pin(_counter.get_cpu(0));
+
+    std::vector<double> _result(_working_sets.size(), 0.0);
+    for(size_t w = 0; w < _working_sets.size(); ++w)
+    {
+        uint64_t    _n     = std::max<uint64_t>(_working_sets.at(w) / 64, 2);
+        chase_node* _nodes = allocate_aligned<chase_node, DeviceT>(_n, 64);
+        make_chain(_nodes, _n);
+
+        // warm-up pass which also loads the working set into the caches
+        chase_node* _p = latency_kernel(_nodes, _n);
+
+        auto _beg = clock_type::now();
+        _p        = latency_kernel(_p, nsteps);
+        auto _end = clock_type::now();
+
+        _result.at(w) = std::chrono::duration<double, std::nano>(_end - _beg).count() /
+                        static_cast<double>(nsteps);
+
+        // make the final node observable so the chase cannot be removed
+        chase_node* volatile _sink = _p;
+        consume_parameters(_sink);
+        free_aligned<chase_node, DeviceT>(_nodes);
+    }
+    return _result;
+}
+
+//--------------------------------------------------------------------------------------//
+///
+///     Measures the read, write, copy, and triad bandwidth and the latency of each
+///     level of the memory hierarchy (L1, L2, L3, DRAM) and stores the ceilings in
+///     the exec_data of \param _counter, i.e. the "ceilings" of the roofline JSON.
+///     The bandwidth of a level is the maximum of the working sets which fit in the
+///     level, the latency is that of the largest of those working sets
+///
+template <typename DeviceT, typename Tp, typename CounterT,
+          device::enable_if_cpu_t<DeviceT> = 0>
+void
+cache_main(counter<DeviceT, Tp, CounterT>& _counter)
+{
+    using ull = long long unsigned;
+
+    // guard against multiple threads trying to call ERT for some reason
+    static std::mutex            _mtx;
+    std::unique_lock<std::mutex> _lock(_mtx);
+
+    if(!_counter.data)
+        return;
+
+    if(settings::verbose() > 0 || settings::debug())
+        printf("[%s] Executing cache bandwidth and latency sweep...\n", __FUNCTION__);
+
+    const uint64_t nthreads = std::max<uint64_t>(_counter.params.nthreads, 1);
+
+    auto _bw_lvls = get_levels(nthreads, _counter.params.memory_max, _counter.cpus);
+    auto _lt_lvls = get_levels(1, _counter.params.memory_max, _counter.cpus);
+    auto _bw_ws   = get_working_sets(_bw_lvls);
+    auto _lt_ws   = get_working_sets(_lt_lvls);
+
+    dmp::barrier();  // synchronize MPI processes
+
+    auto _bw = bandwidth_main(_counter, _bw_ws);
+    auto _lt = latency_main(_counter, _lt_ws);
+
+    dmp::barrier();  // synchronize MPI processes
+
+    std::vector<cache_ceiling> _ceilings(_bw_lvls.size());
+    for(size_t i = 0; i < _bw_lvls.size(); ++i)
+    {
+        _ceilings.at(i).level    = _bw_lvls.at(i).name;
+        _ceilings.at(i).size     = _bw_lvls.at(i).size;
+        _ceilings.at(i).nthreads = nthreads;
+    }
+
+    for(size_t w = 0; w < _bw_ws.size(); ++w)
+    {
+        auto _idx = classify(_bw_lvls, _bw_ws.at(w));
+        if(settings::verbose() > 1 || settings::debug())
+        {
+            printf("[%s]> working set = %llu, level = %s, read = %g, write = %g, copy "
+                   "= %g, triad = %g bytes/sec\n",
+                   __FUNCTION__, (ull) _bw_ws.at(w),
+                   (_idx < 0) ? "-" : _bw_lvls.at(_idx).name.c_str(), _bw.at(w).at(0),
+                   _bw.at(w).at(1), _bw.at(w).at(2), _bw.at(w).at(3));
+        }
+        if(_idx < 0)
+            continue;
+        auto& _ceil           = _ceilings.at(_idx);
+        _ceil.working_set     = std::max<uint64_t>(_ceil.working_set, _bw_ws.at(w));
+        _ceil.read_bandwidth  = std::max(_ceil.read_bandwidth, _bw.at(w).at(0));
+        _ceil.write_bandwidth = std::max(_ceil.write_bandwidth, _bw.at(w).at(1));
+        _ceil.copy_bandwidth  = std::max(_ceil.copy_bandwidth, _bw.at(w).at(2));
+        _ceil.triad_bandwidth = std::max(_ceil.triad_bandwidth, _bw.at(w).at(3));
+    }
+
+    // the working sets increase so the last one of a level is the largest
+    for(size_t w = 0; w < _lt_ws.size(); ++w)
+    {
+        auto _idx = classify(_lt_lvls, _lt_ws.at(w));
+        if(settings::verbose() > 1 || settings::debug())
+        {
+            printf("[%s]> working set = %llu, level = %s, latency = %g nsec\n",
+                   __FUNCTION__, (ull) _lt_ws.at(w),
+                   (_idx < 0) ? "-" : _lt_lvls.at(_idx).name.c_str(), _lt.at(w));
+        }
+        if(_idx < 0)
+            continue;
+        for(auto& itr : _ceilings)
+        {
+            if(itr.level == _lt_lvls.at(_idx).name)
+                itr.latency = _lt.at(w);
+        }
+    }
+
+    // remove the levels without a measurement
+    _ceilings.erase(std::remove_if(_ceilings.begin(), _ceilings.end(),
+                                   [](const cache_ceiling& itr) {
+                                       return itr.working_set == 0;
+                                   }),
+                    _ceilings.end());
+
+    _counter.data->set_ceilings(_ceilings);
+}
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace sweep
+}  // namespace ert
+}  // namespace tim
@@ -94,7 +94,17 @@ public:
         friend class source_location;
         result_type m_result = result_type("", 0);
 
-        template <typename... ArgsT, enable_if_t<(sizeof...(ArgsT) > 0), int> = 0>
+        template <typename... ArgsT>
+        struct is_string_arg : std::false_type
+        {};
+
+        template <typename ArgT>
+        struct is_string_arg<ArgT> : std::is_same<decay_t<ArgT>, std::string>
+        {};
+
+        template <typename... ArgsT, enable_if_t<(sizeof...(ArgsT) > 0 &&
+                                                  !is_string_arg<ArgsT...>::value),
+                                                 int> = 0>
         captured& set(const source_location& obj, ArgsT&&... _args)
         {
             switch(obj.m_mode)
@@ -129,6 +139,34 @@ public:
             m_result = result_type(obj.m_prefix, add_hash_id(obj.m_prefix));
             return *this;
         }
+
+        //  a single runtime string is the common case: the hash is streamed from the
+        //  hash of the prefix so the label is only rebuilt when the string changes
+        template <typename ArgT, enable_if_t<is_string_arg<ArgT>::value, int> = 0>
+        captured& set(const source_location& obj, ArgT&& _arg)
+        {
+            const char* _str = _arg.c_str();
+            size_t      _len = _arg.length();
+            auto        _hash =
+                (obj.m_mode == mode::blank)
+                    ? hash::fnv1a(_str, _len)
+                    : ((_len == 0) ? get_hash_id(obj.m_prefix)
+                                   : hash::fnv1a_append(obj.m_prefix_hash, _str, _len));
+
+            if(_hash == get_hash() && !get_id().empty())
+                return *this;
+
+            if(obj.m_mode == mode::blank)
+                m_result = result_type(_arg, add_hash_id(_arg));
+            else if(_len == 0)
+                m_result = result_type(obj.m_prefix, add_hash_id(obj.m_prefix));
+            else
+            {
+                auto _tmp = join_type::join("/", obj.m_prefix.c_str(), _arg);
+                m_result  = result_type(_tmp, add_hash_id(_tmp));
+            }
+            return *this;
+        }
     };
 
 public:
@@ -258,7 +296,11 @@ public:
 protected:
     //----------------------------------------------------------------------------------//
     //
-    void compute_data(const char* _func) { m_prefix = _func; }
+    void compute_data(const char* _func)
+    {
+        m_prefix      = _func;
+        m_prefix_hash = hash::fnv1a_append(get_hash_id(m_prefix), "/");
+    }
 
     //----------------------------------------------------------------------------------//
     //
@@ -290,6 +332,7 @@ protected:
             else
                 m_prefix = join_type::join("", _func, ":", _line);
         }
+        m_prefix_hash = hash::fnv1a_append(get_hash_id(m_prefix), "/");
     }
 
 public:
@@ -313,9 +356,10 @@ public:
     const captured& get_captured(const char*, const char*) { return m_captured; }
 
 private:
-    mode        m_mode;
-    std::string m_prefix = "";
-    captured    m_captured;
+    mode             m_mode;
+    std::string      m_prefix      = "";
+    hash_result_type m_prefix_hash = 0;
+    captured         m_captured;
 
 private:
     std::string _join(const char* _arg)
@@ -36,6 +36,7 @@
 #include "timemory/hash/types.hpp"
 
 #include <cstdint>
+#include <cstdio>
 #include <iomanip>
 #include <iosfwd>
 #include <sstream>
@@ -50,21 +51,19 @@ namespace tim
 //
 //--------------------------------------------------------------------------------------//
 //
-TIMEMORY_HASH_LINKAGE(graph_hash_map_ptr_t)
+TIMEMORY_HASH_LINKAGE(const graph_hash_map_ptr_t&)
 get_hash_ids()
 {
-    static thread_local auto _inst =
-        get_shared_ptr_pair_instance<graph_hash_map_t, TIMEMORY_API>();
+    static auto _inst = std::make_shared<graph_hash_map_t>();
     return _inst;
 }
 //
 //--------------------------------------------------------------------------------------//
 //
-TIMEMORY_HASH_LINKAGE(graph_hash_alias_ptr_t)
+TIMEMORY_HASH_LINKAGE(const graph_hash_alias_ptr_t&)
 get_hash_aliases()
 {
-    static thread_local auto _inst =
-        get_shared_ptr_pair_instance<graph_hash_alias_t, TIMEMORY_API>();
+    static auto _inst = std::make_shared<graph_hash_alias_t>();
     return _inst;
 }
 //
@@ -74,12 +73,8 @@ TIMEMORY_HASH_LINKAGE(hash_result_type)
 add_hash_id(graph_hash_map_ptr_t& _hash_map, const std::string& prefix)
 {
     hash_result_type _hash_id = get_hash_id(prefix);
-    if(_hash_map && _hash_map->find(_hash_id) == _hash_map->end())
-    {
-        (*_hash_map)[_hash_id] = prefix;
-        if(_hash_map->bucket_count() < _hash_map->size())
-            _hash_map->rehash(_hash_map->size() + 10);
-    }
+    if(_hash_map)
+        _hash_map->emplace(_hash_id, prefix);
     return _hash_id;
 }
 //
@@ -88,23 +83,47 @@ add_hash_id(graph_hash_map_ptr_t& _hash_map, const std::string& prefix)
 TIMEMORY_HASH_LINKAGE(hash_result_type)
 add_hash_id(const std::string& prefix)
 {
-    static thread_local auto _hash_map = get_hash_ids();
+    static auto _hash_map = get_hash_ids();
     return add_hash_id(_hash_map, prefix);
 }
 //
 //--------------------------------------------------------------------------------------//
 //
+TIMEMORY_HASH_LINKAGE(hash_result_type)
+add_hash_id(graph_hash_map_ptr_t& _hash_map, hash_result_type _hash_id,
+            const char* prefix)
+{
+    if(!_hash_map)
+        return _hash_id;
+    auto itr = _hash_map->emplace(_hash_id, prefix).first;
+    if(itr->second != prefix)
+    {
+        fprintf(stderr,
+                "[timemory]> Warning! hash collision: '%s' and '%s' have the same hash "
+                "(%llu). Measurements of '%s' will be reported as '%s'\n",
+                itr->second.c_str(), prefix, (unsigned long long) _hash_id, prefix,
+                itr->second.c_str());
+    }
+    return _hash_id;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+TIMEMORY_HASH_LINKAGE(hash_result_type)
+add_hash_id(hash_result_type _hash_id, const char* prefix)
+{
+    static auto _hash_map = get_hash_ids();
+    return add_hash_id(_hash_map, _hash_id, prefix);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
 TIMEMORY_HASH_LINKAGE(void)
 add_hash_id(graph_hash_map_ptr_t _hash_map, graph_hash_alias_ptr_t _hash_alias,
             hash_result_type _hash_id, hash_result_type _alias_hash_id)
 {
-    if(_hash_alias->find(_alias_hash_id) == _hash_alias->end() &&
-       _hash_map->find(_hash_id) != _hash_map->end())
-    {
-        (*_hash_alias)[_alias_hash_id] = _hash_id;
-        if(_hash_alias->bucket_count() < _hash_alias->size())
-            _hash_alias->rehash(_hash_alias->size() + 10);
-    }
+    if(_hash_map->find(_hash_id) != _hash_map->end())
+        _hash_alias->emplace(_alias_hash_id, _hash_id);
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -0,0 +1,338 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/hash/registry.hpp
+ * \brief Concurrent, insert-only map used for the process-wide hash-id and
+ * hash-alias tables
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace tim
+{
+namespace hash
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::hash::registry
+/// \brief A read-mostly map which is shared by all threads. Entries are never modified
+/// or removed once inserted so lookups are lock-free: each of the \param ShardsN
+/// shards publishes an open-addressing table of pointers to immutable nodes and
+/// lookups only perform acquire loads. Insertions lock the mutex of a single shard.
+/// When a table exceeds half-full, a table with twice the capacity is published and
+/// the previous table is retained (but no longer written to) until the registry is
+/// destroyed so that concurrent readers never observe freed memory. Iteration is
+/// weakly consistent: entries inserted during iteration may or may not be visited.
+///
+template <typename KeyT, typename MappedT, size_t ShardsN = 16,
+          typename HashT = std::hash<KeyT>>
+class registry
+{
+    static_assert(ShardsN > 0, "registry requires at least one shard");
+
+public:
+    using this_type   = registry<KeyT, MappedT, ShardsN, HashT>;
+    using key_type    = KeyT;
+    using mapped_type = MappedT;
+    using value_type  = std::pair<const KeyT, MappedT>;
+    using size_type   = size_t;
+    using hasher      = HashT;
+    using mutex_type  = std::mutex;
+    using lock_type   = std::unique_lock<mutex_type>;
+
+    static constexpr size_t initial_capacity = 64;
+
+private:
+    struct table_type
+    {
+        explicit table_type(size_t _n)
+        : mask(_n - 1)
+        , slots(new std::atomic<value_type*>[_n])
+        {
+            for(size_t i = 0; i < _n; ++i)
+                slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        size_t capacity() const { return mask + 1; }
+
+        size_t                                      mask = 0;
+        std::unique_ptr<std::atomic<value_type*>[]> slots;
+    };
+
+    struct shard_type
+    {
+        shard_type()
+        : table(new table_type(initial_capacity))
+        {
+            tables.emplace_back(table.load(std::memory_order_relaxed));
+        }
+
+        mutable mutex_type                       mutex;
+        std::atomic<table_type*>                 table;
+        std::atomic<size_t>                      size{ 0 };
+        std::vector<std::unique_ptr<table_type>> tables;
+        std::vector<std::unique_ptr<value_type>> nodes;
+    };
+
+public:
+    //----------------------------------------------------------------------------------//
+    //  iterates over a snapshot of the table of each shard
+    //
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = typename this_type::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const value_type*;
+        using reference         = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return *m_node; }
+        pointer   operator->() const { return m_node; }
+
+        const_iterator& operator++()
+        {
+            ++m_slot;
+            advance();
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto _tmp = *this;
+            ++(*this);
+            return _tmp;
+        }
+
+        bool operator==(const const_iterator& rhs) const { return m_node == rhs.m_node; }
+        bool operator!=(const const_iterator& rhs) const { return m_node != rhs.m_node; }
+
+    private:
+        friend class registry;
+
+        const_iterator(const this_type* _obj, size_t _shard, const table_type* _table,
+                       size_t _slot, const value_type* _node = nullptr)
+        : m_obj(_obj)
+        , m_shard(_shard)
+        , m_table(_table)
+        , m_slot(_slot)
+        , m_node(_node)
+        {
+            if(!m_node)
+                advance();
+        }
+
+        void advance()
+        {
+            m_node = nullptr;
+            while(m_obj && m_shard < ShardsN)
+            {
+                if(!m_table)
+                    m_table = m_obj->m_shards[m_shard].table.load(
+                        std::memory_order_acquire);
+                for(; m_slot < m_table->capacity(); ++m_slot)
+                {
+                    m_node = m_table->slots[m_slot].load(std::memory_order_acquire);
+                    if(m_node)
+                        return;
+                }
+                ++m_shard;
+                m_table = nullptr;
+                m_slot  = 0;
+            }
+        }
+
+        const this_type*  m_obj   = nullptr;
+        size_t            m_shard = ShardsN;
+        const table_type* m_table = nullptr;
+        size_t            m_slot  = 0;
+        const value_type* m_node  = nullptr;
+    };
+
+    using iterator = const_iterator;
+
+public:
+    registry()  = default;
+    ~registry() = default;
+
+    registry(const registry&) = delete;
+    registry(registry&&)      = delete;
+
+    registry& operator=(const registry&) = delete;
+    registry& operator=(registry&&) = delete;
+
+    //----------------------------------------------------------------------------------//
+    //  lock-free lookups
+    //
+    const_iterator find(const key_type& _key) const
+    {
+        auto        _hash  = hasher{}(_key);
+        auto        _shard = _hash % ShardsN;
+        const auto* _table = m_shards[_shard].table.load(std::memory_order_acquire);
+        for(size_t i = (_hash / ShardsN) & _table->mask;; i = (i + 1) & _table->mask)
+        {
+            const auto* _node = _table->slots[i].load(std::memory_order_acquire);
+            if(!_node)
+                return end();
+            if(_node->first == _key)
+                return const_iterator(this, _shard, _table, i, _node);
+        }
+    }
+
+    size_type count(const key_type& _key) const { return (find(_key) != end()) ? 1 : 0; }
+
+    const mapped_type& at(const key_type& _key) const
+    {
+        auto itr = find(_key);
+        if(itr == end())
+            throw std::out_of_range("tim::hash::registry::at :: key not found");
+        return itr->second;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0, nullptr, 0); }
+    const_iterator end() const { return const_iterator{}; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_type size() const
+    {
+        size_type _n = 0;
+        for(const auto& itr : m_shards)
+            _n += itr.size.load(std::memory_order_relaxed);
+        return _n;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    //----------------------------------------------------------------------------------//
+    //  insertions: existing entries are never replaced
+    //
+    template <typename... Args>
+    std::pair<const_iterator, bool> emplace(const key_type& _key, Args&&... _args)
+    {
+        auto itr = find(_key);
+        if(itr != end())
+            return { itr, false };
+
+        auto       _hash  = hasher{}(_key);
+        auto&      _shard = m_shards[_hash % ShardsN];
+        lock_type  _lk(_shard.mutex);
+        auto*      _table = _shard.table.load(std::memory_order_relaxed);
+        const auto _start = _hash / ShardsN;
+
+        // check again in case another thread inserted the key before the lock
+        for(size_t i = _start & _table->mask;; i = (i + 1) & _table->mask)
+        {
+            const auto* _node = _table->slots[i].load(std::memory_order_relaxed);
+            if(!_node)
+                break;
+            if(_node->first == _key)
+                return { const_iterator(this, _hash % ShardsN, _table, i, _node), false };
+        }
+
+        if(2 * (_shard.size.load(std::memory_order_relaxed) + 1) > _table->capacity())
+            _table = grow(_shard, 2 * _table->capacity());
+
+        _shard.nodes.emplace_back(new value_type(
+            std::piecewise_construct, std::forward_as_tuple(_key),
+            std::forward_as_tuple(std::forward<Args>(_args)...)));
+        auto* _node = _shard.nodes.back().get();
+        auto  _slot = place(_table, _start, _node);
+        _shard.size.fetch_add(1, std::memory_order_relaxed);
+        return { const_iterator(this, _hash % ShardsN, _table, _slot, _node), true };
+    }
+
+    std::pair<const_iterator, bool> insert(const value_type& _value)
+    {
+        return emplace(_value.first, _value.second);
+    }
+
+    /// pre-size the tables for \param _n entries
+    void reserve(size_type _n)
+    {
+        size_t _capacity = initial_capacity;
+        while(_capacity < 2 * (_n / ShardsN + 1))
+            _capacity *= 2;
+        for(auto& itr : m_shards)
+        {
+            lock_type _lk(itr.mutex);
+            if(itr.table.load(std::memory_order_relaxed)->capacity() < _capacity)
+                grow(itr, _capacity);
+        }
+    }
+
+private:
+    static size_t place(table_type* _table, size_t _start, value_type* _node)
+    {
+        for(size_t i = _start & _table->mask;; i = (i + 1) & _table->mask)
+        {
+            if(!_table->slots[i].load(std::memory_order_relaxed))
+            {
+                _table->slots[i].store(_node, std::memory_order_release);
+                return i;
+            }
+        }
+    }
+
+    // requires the lock of the shard to be held
+    static table_type* grow(shard_type& _shard, size_t _capacity)
+    {
+        auto* _prev  = _shard.table.load(std::memory_order_relaxed);
+        auto* _table = new table_type(_capacity);
+        _shard.tables.emplace_back(_table);
+        for(size_t i = 0; i < _prev->capacity(); ++i)
+        {
+            auto* _node = _prev->slots[i].load(std::memory_order_relaxed);
+            if(_node)
+                place(_table, hasher{}(_node->first) / ShardsN, _node);
+        }
+        _shard.table.store(_table, std::memory_order_release);
+        return _table;
+    }
+
+private:
+    std::array<shard_type, ShardsN> m_shards;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace hash
+}  // namespace tim
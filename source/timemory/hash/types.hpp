@@ -31,7 +31,10 @@
 
 #include "timemory/api.hpp"
 #include "timemory/hash/macros.hpp"
+#include "timemory/hash/registry.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -47,8 +50,8 @@ namespace tim
 //--------------------------------------------------------------------------------------//
 //
 using hash_result_type          = size_t;
-using graph_hash_map_t          = std::unordered_map<hash_result_type, std::string>;
-using graph_hash_alias_t        = std::unordered_map<hash_result_type, hash_result_type>;
+using graph_hash_map_t          = hash::registry<hash_result_type, std::string>;
+using graph_hash_alias_t        = hash::registry<hash_result_type, hash_result_type>;
 using graph_hash_map_ptr_t      = std::shared_ptr<graph_hash_map_t>;
 using graph_hash_map_ptr_pair_t = std::pair<graph_hash_map_ptr_t, graph_hash_map_ptr_t>;
 using graph_hash_alias_ptr_t    = std::shared_ptr<graph_hash_alias_t>;
@@ -58,23 +61,90 @@ using graph_hash_alias_ptr_t    = std::shared_ptr<graph_hash_alias_t>;
 //
 //--------------------------------------------------------------------------------------//
 //
+/// the process-wide map of hash to label. All threads share the same instance
 TIMEMORY_HASH_DLL
-graph_hash_map_ptr_t
+const graph_hash_map_ptr_t&
 get_hash_ids();
 //
 //--------------------------------------------------------------------------------------//
 //
+/// the process-wide map of alias hash to hash. All threads share the same instance
 TIMEMORY_HASH_DLL
-graph_hash_alias_ptr_t
+const graph_hash_alias_ptr_t&
 get_hash_aliases();
 //
 //--------------------------------------------------------------------------------------//
 //
-template <typename Tp>
-hash_result_type
-get_hash_id(Tp&& prefix)
+namespace hash
+{
+//
+/// FNV-1a offset basis and prime for the width of \ref tim::hash_result_type
+template <size_t N = sizeof(hash_result_type)>
+struct fnv1a_params;
+//
+template <>
+struct fnv1a_params<8>
+{
+    static constexpr uint64_t offset = 14695981039346656037ULL;
+    static constexpr uint64_t prime  = 1099511628211ULL;
+};
+//
+template <>
+struct fnv1a_params<4>
+{
+    static constexpr uint32_t offset = 2166136261U;
+    static constexpr uint32_t prime  = 16777619U;
+};
+//
+/// continue the FNV-1a hash \param _value with a null-terminated string
+constexpr hash_result_type
+fnv1a_append(hash_result_type _value, const char* _str)
+{
+    while(_str && *_str != '\0')
+        _value = (_value ^ static_cast<unsigned char>(*_str++)) * fnv1a_params<>::prime;
+    return _value;
+}
+//
+/// continue the FNV-1a hash \param _value with \param _len characters
+constexpr hash_result_type
+fnv1a_append(hash_result_type _value, const char* _str, size_t _len)
+{
+    for(size_t i = 0; i < _len; ++i)
+        _value = (_value ^ static_cast<unsigned char>(_str[i])) * fnv1a_params<>::prime;
+    return _value;
+}
+//
+/// FNV-1a hash of a null-terminated string
+constexpr hash_result_type
+fnv1a(const char* _str)
+{
+    return fnv1a_append(fnv1a_params<>::offset, _str);
+}
+//
+/// FNV-1a hash of \param _len characters
+constexpr hash_result_type
+fnv1a(const char* _str, size_t _len)
+{
+    return fnv1a_append(fnv1a_params<>::offset, _str, _len);
+}
+//
+}  // namespace hash
+//
+//--------------------------------------------------------------------------------------//
+//
+/// the hash of a label. This is a constant expression when the label is a string
+/// literal (see TIMEMORY_HASH_LITERAL) and has the same value as the hash of the label
+/// at runtime
+constexpr hash_result_type
+get_hash_id(const char* prefix)
 {
-    return std::hash<std::string>()(std::forward<Tp>(prefix));
+    return hash::fnv1a(prefix);
+}
+//
+inline hash_result_type
+get_hash_id(const std::string& prefix)
+{
+    return hash::fnv1a(prefix.c_str(), prefix.length());
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -91,6 +161,22 @@ add_hash_id(const std::string& prefix);
 //
 //--------------------------------------------------------------------------------------//
 //
+/// register the label for a precomputed (e.g. compile-time) hash. If the hash is
+/// already registered for a different label, the collision is reported and the
+/// existing label is retained
+TIMEMORY_HASH_DLL
+hash_result_type
+add_hash_id(graph_hash_map_ptr_t& _hash_map, hash_result_type _hash_id,
+            const char* prefix);
+//
+//--------------------------------------------------------------------------------------//
+//
+TIMEMORY_HASH_DLL
+hash_result_type
+add_hash_id(hash_result_type _hash_id, const char* prefix);
+//
+//--------------------------------------------------------------------------------------//
+//
 TIMEMORY_HASH_DLL
 void
 add_hash_id(graph_hash_map_ptr_t _hash_map, graph_hash_alias_ptr_t _hash_alias,
@@ -77,6 +77,8 @@ public:
     using finalizer_pair_t = std::pair<std::string, finalizer_func_t>;
     using finalizer_list_t = std::deque<finalizer_pair_t>;
     using finalizer_void_t = std::multimap<void*, finalizer_func_t>;
+    using output_func_t    = std::function<void()>;
+    using output_list_t    = std::deque<std::pair<output_func_t, output_func_t>>;
     using filemap_t        = std::map<string_t, std::map<string_t, std::set<string_t>>>;
 
 public:
@@ -115,6 +117,12 @@ public:
         add_file_output("json", _label, _file);
     }
 
+    /// \fn add_output
+    /// \brief Defer the output of a component until the end of \ref finalize. The first
+    /// function of all the entries is invoked concurrently on TIMEMORY_OUTPUT_THREADS
+    /// threads and then the second function of each entry is invoked in order
+    void add_output(output_func_t _write, output_func_t _finish);
+
     /// \fn set_write_metadata
     /// \brief Set to 0 for yes if other output, -1 for never, or 1 for yes
     void    set_write_metadata(short v) { m_write_metadata = v; }
@@ -234,6 +242,7 @@ protected:
 protected:
     // protected functions
     string_t get_prefix() const;
+    void     write_output();
 
 private:
     /// notifies that it is finalizing
@@ -258,6 +267,7 @@ private:
     finalizer_list_t       m_worker_finalizers  = {};
     finalizer_void_t       m_pointer_fini       = {};
     filemap_t              m_output_files       = {};
+    output_list_t          m_output_queue       = {};
 
 private:
     struct persistent_data
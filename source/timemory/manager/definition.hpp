@@ -30,6 +30,7 @@
 #pragma once
 
 #include "timemory/backends/process.hpp"
+#include "timemory/backends/thread_pool.hpp"
 #include "timemory/manager/declaration.hpp"
 #include "timemory/manager/macros.hpp"
 #include "timemory/manager/types.hpp"
@@ -252,6 +253,9 @@ manager::finalize()
     // finalize masters second
     _finalize(m_master_finalizers);
 
+    // the outputs deferred by the storage of the components
+    write_output();
+
     if(f_debug())
         PRINT_HERE("%s [master: %i/%i, worker: %i/%i, other: %i]", "finalizing",
                    (int) m_master_cleanup.size(), (int) m_master_finalizers.size(),
@@ -469,12 +473,65 @@ TIMEMORY_MANAGER_LINKAGE(void)
 manager::add_file_output(const string_t& _category, const string_t& _label,
                          const string_t& _file)
 {
+    // files are added concurrently when the output is deferred
+    auto_lock_t _lk(m_mutex);
     m_output_files[_category][_label].insert(_file);
 }
 //
 //----------------------------------------------------------------------------------//
 //
 TIMEMORY_MANAGER_LINKAGE(void)
+manager::add_output(output_func_t _write, output_func_t _finish)
+{
+    auto_lock_t _lk(m_mutex);
+    m_output_queue.emplace_back(std::move(_write), std::move(_finish));
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(void)
+manager::write_output()
+{
+    output_list_t _queue{};
+    {
+        auto_lock_t _lk(m_mutex);
+        std::swap(_queue, m_output_queue);
+    }
+
+    if(_queue.empty())
+        return;
+
+    size_t _nthreads = settings::output_threads();
+    if(_nthreads == 0)
+        _nthreads = std::thread::hardware_concurrency();
+    _nthreads = std::max<size_t>(std::min<size_t>(_nthreads, _queue.size()), 1);
+
+    if(f_debug())
+        PRINT_HERE("writing %i outputs with %i threads", (int) _queue.size(),
+                   (int) _nthreads);
+
+    // each task formats and writes the next available output
+    threading::thread_pool::instance().parallel_for(
+        _queue.size(),
+        [&_queue](size_t i) {
+            try
+            {
+                _queue.at(i).first();
+            } catch(std::exception& e)
+            {
+                fprintf(stderr, "[manager]> Exception writing output: %s\n", e.what());
+            }
+        },
+        _nthreads);
+
+    // stdout and plotting in the order the outputs were added
+    for(auto& itr : _queue)
+        itr.second();
+}
+//
+//----------------------------------------------------------------------------------//
+//
+TIMEMORY_MANAGER_LINKAGE(void)
 manager::remove_cleanup(const std::string& _key)
 {
     auto _remove_functor = [&](finalizer_list_t& _functors) {
@@ -468,6 +468,14 @@ template <typename T>
 struct flat_storage : false_type
 {};
 
+//--------------------------------------------------------------------------------------//
+/// trait the configures the storage call-graph of the type to allocate the nodes from
+/// a chunked arena (tim::graph_arena_allocator) instead of individual heap allocations
+///
+template <typename T>
+struct graph_arena : false_type
+{};
+
 //--------------------------------------------------------------------------------------//
 /// trait the configures type to not report the accumulated value (useful if meaningless)
 ///
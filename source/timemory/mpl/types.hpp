@@ -190,6 +190,9 @@ struct pretty_json;
 template <typename T>
 struct flat_storage;
 
+template <typename T>
+struct graph_arena;
+
 template <typename T>
 struct report_sum;
 
@@ -38,6 +38,7 @@
 
 #include <functional>
 #include <iosfwd>
+#include <vector>
 
 namespace std
 {
@@ -432,9 +433,13 @@ struct merge<Type, true>
     using storage_type             = impl::storage<Type, has_data>;
     using singleton_t              = typename storage_type::singleton_type;
     using graph_t                  = typename storage_type::graph_type;
+    using graph_data_t             = typename storage_type::graph_data_t;
     using result_type              = typename storage_type::result_array_t;
+    using storage_array_t          = std::vector<storage_type*>;
 
     merge(storage_type& lhs, storage_type& rhs);
+    merge(storage_type& lhs, graph_data_t& rhs);
+    merge(storage_type& lhs, storage_array_t& rhs);
     merge(result_type& lhs, const result_type& rhs);
 };
 //
@@ -473,7 +478,18 @@ struct TIMEMORY_OPERATIONS_DLL print
     print(const std::string& _label, bool _forced_json)
     : json_forced(_forced_json)
     , label(_label)
-    {}
+    {
+        // skip all the formatting and only write the binary data
+        if(settings::binary_only_output())
+        {
+            cout_output   = false;
+            json_output   = false;
+            text_output   = false;
+            plot_output   = false;
+            flame_output  = false;
+            binary_output = file_output;
+        }
+    }
 
     virtual void setup()        = 0;
     virtual void execute()      = 0;
@@ -482,6 +498,12 @@ struct TIMEMORY_OPERATIONS_DLL print
     virtual void update_data()  = 0;
     virtual void print_custom() = 0;
 
+    /// formats and writes the output files. Invoked concurrently with other components
+    /// when the output is deferred to the manager so the storage must not be accessed
+    virtual void write_output() = 0;
+    /// writes to stdout and generates the plots. Always invoked serially
+    virtual void finish_output() = 0;
+
     virtual void write(std::ostream& os, stream_type stream);
     virtual void print_cout(stream_type stream);
     virtual void print_text(const std::string& fname, stream_type stream);
@@ -490,6 +512,7 @@ struct TIMEMORY_OPERATIONS_DLL print
     auto get_label() const { return label; }
     auto get_text_output_name() const { return text_outfname; }
     auto get_json_output_name() const { return json_outfname; }
+    auto get_binary_output_name() const { return binary_outfname; }
     auto get_json_input_name() const { return json_inpfname; }
     auto get_text_diff_name() const { return text_diffname; }
     auto get_json_diff_name() const { return json_diffname; }
@@ -499,6 +522,7 @@ struct TIMEMORY_OPERATIONS_DLL print
     void set_file_output(bool v) { file_output = v; }
     void set_text_output(bool v) { text_output = v; }
     void set_json_output(bool v) { json_output = v; }
+    void set_binary_output(bool v) { binary_output = v; }
     void set_dart_output(bool v) { dart_output = v; }
     void set_plot_output(bool v) { plot_output = v; }
     void set_verbose(int32_t v) { verbose = v; }
@@ -519,6 +543,7 @@ protected:
     bool    cout_output    = settings::cout_output();
     bool    json_output    = (settings::json_output() || json_forced) && file_output;
     bool    text_output    = settings::text_output() && file_output;
+    bool    binary_output  = settings::binary_output() && file_output;
     bool    dart_output    = settings::dart_output();
     bool    plot_output    = settings::plot_output() && json_output;
     bool    flame_output   = settings::flamegraph_output() && file_output;
@@ -536,6 +561,7 @@ protected:
     std::string description       = "";
     std::string text_outfname     = "";
     std::string json_outfname     = "";
+    std::string binary_outfname   = "";
     std::string json_inpfname     = "";
     std::string text_diffname     = "";
     std::string json_diffname     = "";
@@ -580,64 +606,88 @@ struct print<Tp, true> : public base::print
 
     virtual void execute()
     {
-        if(!data)
+        if(!prepare())
             return;
 
+        write_output();
+        finish_output();
+    }
+
+    /// gathers the data (collective over the distributed memory ranks), runs the
+    /// dart and custom outputs, and returns whether this process writes the output
+    virtual bool prepare()
+    {
+        if(!data)
+            return false;
+
         if(update)
             update_data();
         else
             setup();
 
         if(node_init && node_rank > 0)
-            return;
+            return false;
+
+        if(dart_output)
+            print_dart();
+
+        print_custom();
+
+        return true;
+    }
+
+    virtual void write_output()
+    {
+        bool _diff = has_diff_output();
+
+        if((file_output && text_output) || cout_output)
+        {
+            write_stream(data_stream, node_results);
+            data_stream->set_banner(description);
+            if(_diff)
+            {
+                write_stream(diff_stream, node_delta);
+                diff_stream->set_banner(get_diff_banner(description));
+            }
+        }
 
         if(file_output)
         {
             if(json_output)
                 print_json(json_outfname, node_results, data_concurrency);
+            if(binary_output)
+                print_binary(binary_outfname, node_results, data_concurrency);
             if(text_output)
                 print_text(text_outfname, data_stream);
-            if(plot_output)
-                print_plot(json_outfname, "");
+            if(_diff && json_output)
+                print_json(json_diffname, node_delta, data_concurrency);
+            if(_diff && text_output)
+                print_text(text_diffname, diff_stream);
         }
+    }
+
+    virtual void finish_output()
+    {
+        bool _diff = has_diff_output();
+
+        if(file_output && plot_output)
+            print_plot(json_outfname, "");
 
         if(cout_output)
             print_cout(data_stream);
         else
             printf("\n");
 
-        if(dart_output)
-            print_dart();
-
-        if(!node_input.empty() && !node_delta.empty() && settings::diff_output())
+        if(_diff)
         {
-            if(file_output)
-            {
-                if(json_output)
-                    print_json(json_diffname, node_delta, data_concurrency);
-                if(text_output)
-                    print_text(text_diffname, diff_stream);
-                if(plot_output)
-                {
-                    std::stringstream ss;
-                    ss << "Difference vs. " << json_inpfname;
-                    if(input_concurrency != data_concurrency)
-                    {
-                        auto delta_conc = (data_concurrency - input_concurrency);
-                        ss << " with " << delta_conc << " "
-                           << ((delta_conc > 0) ? "more" : "less") << "threads";
-                    }
-                    print_plot(json_diffname, ss.str());
-                }
-            }
+            if(file_output && plot_output)
+                print_plot(json_diffname, get_diff_banner("Difference"));
 
             if(cout_output)
                 print_cout(diff_stream);
             else
                 printf("\n");
         }
-
-        print_custom();
     }
 
     virtual void update_data();
@@ -657,7 +707,10 @@ struct print<Tp, true> : public base::print
     }
 
     void write_stream(stream_type& stream, result_type& results);
+    std::string get_diff_banner(const std::string& _prefix) const;
     void print_json(const std::string& fname, result_type& results, int64_t concurrency);
+    void print_binary(const std::string& fname, result_type& results,
+                      int64_t concurrency);
     auto get_data() const { return data; }
     auto get_node_results() const { return node_results; }
     auto get_node_input() const { return node_input; }
@@ -669,6 +722,11 @@ struct print<Tp, true> : public base::print
     template <typename Archive>
     void print_metadata(false_type, Archive& ar, const Tp& obj);
 
+    bool has_diff_output() const
+    {
+        return !node_input.empty() && !node_delta.empty() && settings::diff_output();
+    }
+
     std::vector<result_node*> get_flattened(result_type& results)
     {
         std::vector<result_node*> flat;
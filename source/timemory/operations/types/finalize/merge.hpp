@@ -31,9 +31,15 @@
 
 //======================================================================================//
 //
+#include "timemory/backends/thread_pool.hpp"
+#include "timemory/backends/threading.hpp"
 #include "timemory/operations/declaration.hpp"
 #include "timemory/operations/macros.hpp"
 #include "timemory/operations/types.hpp"
+#include "timemory/settings/declaration.hpp"
+
+#include <algorithm>
+#include <vector>
 //
 //======================================================================================//
 
@@ -49,9 +55,6 @@ namespace finalize
 template <typename Type>
 merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
 {
-    using pre_order_iterator = typename graph_t::pre_order_iterator;
-    using sibling_iterator   = typename graph_t::sibling_iterator;
-
     // don't merge self
     if(&lhs == &rhs)
         return;
@@ -67,13 +70,14 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
     if(!l.owns_lock())
         l.lock();
 
+    // the hash ids and aliases are normally the process-wide registries
     auto _copy_hash_ids = [&]() {
-        for(const auto& itr : (*rhs.get_hash_ids()))
-            if(lhs.m_hash_ids->find(itr.first) == lhs.m_hash_ids->end())
-                (*lhs.m_hash_ids)[itr.first] = itr.second;
-        for(const auto& itr : (*rhs.get_hash_aliases()))
-            if(lhs.m_hash_aliases->find(itr.first) == lhs.m_hash_aliases->end())
-                (*lhs.m_hash_aliases)[itr.first] = itr.second;
+        if(lhs.m_hash_ids != rhs.get_hash_ids())
+            for(const auto& itr : (*rhs.get_hash_ids()))
+                lhs.m_hash_ids->insert(itr);
+        if(lhs.m_hash_aliases != rhs.get_hash_aliases())
+            for(const auto& itr : (*rhs.get_hash_aliases()))
+                lhs.m_hash_aliases->insert(itr);
     };
 
     // if self is not initialized but itr is, copy data
@@ -95,8 +99,27 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
     if(rhs.size() == 0 || !rhs.data().has_head())
         return;
 
+    merge<Type, true>{ lhs, rhs.data() };
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+merge<Type, true>::merge(storage_type& lhs, graph_data_t& rhs)
+{
+    using pre_order_iterator = typename graph_t::pre_order_iterator;
+    using sibling_iterator   = typename graph_t::sibling_iterator;
+
+    if(!rhs.has_head() || rhs.graph().size() <= 1)
+        return;
+
+    // create lock
+    auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+    if(!l.owns_lock())
+        l.lock();
+
     int64_t num_merged     = 0;
-    auto    inverse_insert = rhs.data().get_inverse_insert();
+    auto    inverse_insert = rhs.get_inverse_insert();
 
     for(auto entry : inverse_insert)
     {
@@ -109,7 +132,7 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
             {
                 if(settings::debug() || settings::verbose() > 2)
                     PRINT_HERE("[%s]> worker is merging %i records into %i records",
-                               Type::get_label().c_str(), (int) rhs.size(),
+                               Type::get_label().c_str(), (int) rhs.graph().size() - 1,
                                (int) lhs.size());
 
                 pre_order_iterator pos = master_entry;
@@ -157,14 +180,74 @@ merge<Type, true>::merge(storage_type& lhs, storage_type& rhs)
     {
         if(settings::debug() || settings::verbose() > 2)
             PRINT_HERE("[%s]> worker is not merged!", Type::get_label().c_str());
-        pre_order_iterator _nitr(rhs.data().head());
+        pre_order_iterator _nitr(rhs.head());
         ++_nitr;
         if(!lhs.graph().is_valid(_nitr))
-            _nitr = pre_order_iterator(rhs.data().head());
+            _nitr = pre_order_iterator(rhs.head());
         lhs.graph().append_child(lhs._data().head(), _nitr);
     }
 
-    rhs.data().clear();
+    rhs.clear();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+merge<Type, true>::merge(storage_type& lhs, storage_array_t& rhs)
+{
+    // the worker call-graphs are first combined with each other via a pairwise
+    // tree-reduction so that the master graph only merges the one combined graph
+    // instead of every worker graph. The equivalent nodes of different threads are
+    // combined so this is only done when the thread data is collapsed.
+    std::vector<graph_data_t*> _data;
+    for(auto& itr : rhs)
+    {
+        if(itr && itr != &lhs && itr->is_initialized() && itr->m_graph_data_instance &&
+           itr->m_graph_data_instance->has_head())
+        {
+            itr->stack_clear();
+            _data.emplace_back(itr->m_graph_data_instance);
+        }
+    }
+
+    size_t _nthreads = settings::merge_threads();
+    if(_nthreads == 0)
+        _nthreads = std::max<size_t>(threading::affinity::hw_concurrency(), 1);
+
+    bool _collapse =
+        settings::collapse_threads() && !trait::thread_scope_only<Type>::value;
+
+    if(_collapse && _nthreads > 1 && _data.size() > 2)
+    {
+        using pair_t = std::pair<graph_data_t*, graph_data_t*>;
+
+        for(size_t _stride = 1; _stride < _data.size(); _stride *= 2)
+        {
+            std::vector<pair_t> _pairs;
+            for(size_t i = 0; i + _stride < _data.size(); i += 2 * _stride)
+                _pairs.emplace_back(_data.at(i), _data.at(i + _stride));
+
+            // the calling thread participates in the combination of the pairs
+            auto _combine = [&_pairs](size_t i) {
+                _pairs.at(i).first->combine(*_pairs.at(i).second,
+                                            &storage_type::combine_nodes);
+            };
+            threading::thread_pool::instance().parallel_for(_pairs.size(), _combine,
+                                                            _nthreads);
+        }
+
+        if(settings::debug() || settings::verbose() > 2)
+            PRINT_HERE("[%s]> reduced %i worker graphs using %i threads",
+                       Type::get_label().c_str(), (int) _data.size(),
+                       (int) std::min(_nthreads, _data.size() / 2));
+    }
+
+    // the combined graph is merged and the hash-ids of every worker are copied
+    for(auto& itr : rhs)
+    {
+        if(itr)
+            merge<Type, true>{ lhs, *itr };
+    }
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -227,12 +310,12 @@ merge<Type, false>::merge(storage_type& lhs, storage_type& rhs)
     if(!l.owns_lock())
         l.lock();
 
-    for(const auto& itr : *rhs.get_hash_ids())
-        if(lhs.m_hash_ids->find(itr.first) == lhs.m_hash_ids->end())
-            (*lhs.m_hash_ids)[itr.first] = itr.second;
-    for(const auto& itr : (*rhs.get_hash_aliases()))
-        if(lhs.m_hash_aliases->find(itr.first) == lhs.m_hash_aliases->end())
-            (*lhs.m_hash_aliases)[itr.first] = itr.second;
+    if(lhs.m_hash_ids != rhs.get_hash_ids())
+        for(const auto& itr : *rhs.get_hash_ids())
+            lhs.m_hash_ids->insert(itr);
+    if(lhs.m_hash_aliases != rhs.get_hash_aliases())
+        for(const auto& itr : (*rhs.get_hash_aliases()))
+            lhs.m_hash_aliases->insert(itr);
 }
 //
 //--------------------------------------------------------------------------------------//
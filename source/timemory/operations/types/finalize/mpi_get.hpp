@@ -37,6 +37,8 @@
 //
 #include "timemory/operations/declaration.hpp"
 //
+#include "timemory/backends/thread_pool.hpp"
+//
 //======================================================================================//
 
 namespace tim
@@ -69,6 +71,13 @@ struct mpi_get<Type, true>
     // then it uses the adder to combine the data
     mpi_get(std::vector<Type>& dst, const Type& src,
             std::function<Type&(Type& lhs, const Type& rhs)>&& adder = this_type::plus);
+
+    // convert a result to and from a serialization for communication. The binary
+    // packing (true_type) is used unless the type requires json
+    static std::string serialize(std::true_type, const result_type&);
+    static std::string serialize(std::false_type, const result_type&);
+    static result_type deserialize(std::true_type, const std::string&);
+    static result_type deserialize(std::false_type, const std::string&);
 };
 //
 //--------------------------------------------------------------------------------------//
@@ -107,33 +116,65 @@ mpi_get<Type, true>::mpi_get(storage_type& data, distrib_type& results)
     int comm_rank = mpi::rank(comm);
     int comm_size = mpi::size(comm);
 
+    // the (rank, serialized result) pairs accumulated by a rank in the reduction tree.
+    // The serialized results are forwarded as-is and only deserialized by the root
+    using pack_type = std::vector<std::pair<int32_t, std::string>>;
+    using pack_output_t =
+        policy::output_archive<cereal::BinaryOutputArchive, api::native_tag>;
+    using pack_input_t =
+        policy::input_archive<cereal::BinaryInputArchive, api::native_tag>;
+
+    // types which require json (e.g. roofline) serialize data that the binary archives
+    // cannot load back so they are sent as json
+    using binary_type =
+        std::integral_constant<bool, !trait::requires_json<Type>::value>;
+
     //------------------------------------------------------------------------------//
     //  Used to convert a result to a serialization
     //
-    auto send_serialize = [&](const result_type& src) {
+    auto send_serialize = [](const result_type& src) {
+        return serialize(binary_type{}, src);
+    };
+
+    //------------------------------------------------------------------------------//
+    //  Used to convert the serialization to a result
+    //
+    auto recv_serialize = [&](const std::string& src) {
+        auto ret = deserialize(binary_type{}, src);
+        if(settings::debug())
+            printf("[RECV: %i]> data size: %lli\n", comm_rank,
+                   (long long int) ret.size());
+        return ret;
+    };
+
+    //------------------------------------------------------------------------------//
+    //  Used to pack the serialized results of one or more ranks into a single message
+    //
+    auto send_pack = [&](const pack_type& src) {
         std::stringstream ss;
         {
-            auto oa = policy::output_archive<cereal::MinimalJSONOutputArchive,
-                                             api::native_tag>::get(ss);
-            (*oa)(cereal::make_nvp("data", src));
+            auto oa = pack_output_t::get(ss);
+            (*oa)(static_cast<uint64_t>(src.size()));
+            for(const auto& itr : src)
+                (*oa)(itr.first, itr.second);
         }
         return ss.str();
     };
 
     //------------------------------------------------------------------------------//
-    //  Used to convert the serialization to a result
+    //  Used to unpack a message into the serialized results of one or more ranks
     //
-    auto recv_serialize = [&](const std::string& src) {
-        result_type       ret;
+    auto recv_unpack = [&](const std::string& src) {
+        pack_type         ret;
         std::stringstream ss;
         ss << src;
         {
-            auto ia =
-                policy::input_archive<cereal::JSONInputArchive, api::native_tag>::get(ss);
-            (*ia)(cereal::make_nvp("data", ret));
-            if(settings::debug())
-                printf("[RECV: %i]> data size: %lli\n", comm_rank,
-                       (long long int) ret.size());
+            auto     ia     = pack_input_t::get(ss);
+            uint64_t nranks = 0;
+            (*ia)(nranks);
+            ret.resize(nranks);
+            for(uint64_t i = 0; i < nranks; ++i)
+                (*ia)(ret.at(i).first, ret.at(i).second);
         }
         return ret;
     };
@@ -148,75 +189,91 @@ mpi_get<Type, true>::mpi_get(storage_type& data, distrib_type& results)
         return _sz;
     };
 
-    results = distrib_type(comm_size);
+    bool collapse = settings::collapse_processes();
+    auto ret      = data.get();
+    auto _merged  = (collapse) ? ret : result_type{};
+    auto _forward = pack_type{};
 
-    auto ret     = data.get();
-    auto str_ret = send_serialize(ret);
+    //
+    //  Binomial reduction tree: in each round, the ranks which are an odd multiple of
+    //  the stride send everything they have accumulated to (rank - stride) and exit.
+    //  When collapsing, the data is merged per-path on the way up so each message
+    //  and the work on the root rank stays proportional to one rank's call-graph.
+    //  Otherwise, the serialized results of the other ranks are forwarded unchanged
+    //
+    for(int stride = 1; stride < comm_size; stride *= 2)
+    {
+        if(comm_rank % (2 * stride) == stride)
+        {
+            if(settings::debug())
+                printf("[SEND: %i]> starting %i\n", comm_rank, comm_rank - stride);
+            _forward.emplace(_forward.begin(), comm_rank,
+                             send_serialize((collapse) ? _merged : ret));
+            mpi::send(send_pack(_forward), comm_rank - stride, 0, comm);
+            if(settings::debug())
+                printf("[SEND: %i]> completed %i\n", comm_rank, comm_rank - stride);
+            _forward.clear();
+            break;
+        }
+        else if(comm_rank % (2 * stride) == 0 && comm_rank + stride < comm_size)
+        {
+            std::string str;
+            if(settings::debug())
+                printf("[RECV: %i]> starting %i\n", comm_rank, comm_rank + stride);
+            mpi::recv(str, comm_rank + stride, 0, comm);
+            if(settings::debug())
+                printf("[RECV: %i]> completed %i\n", comm_rank, comm_rank + stride);
+            auto _recv = recv_unpack(str);
+            if(collapse)
+            {
+                for(auto& itr : _recv)
+                    operation::finalize::merge<Type, true>(_merged,
+                                                           recv_serialize(itr.second));
+            }
+            else
+            {
+                for(auto& itr : _recv)
+                    _forward.emplace_back(std::move(itr));
+            }
+        }
+    }
 
     if(comm_rank == 0)
     {
         //
-        //  The root rank receives data from all non-root ranks and reports all data
+        //  The root rank reports all data. The results of the other ranks are
+        //  deserialized concurrently
         //
-        for(int i = 1; i < comm_size; ++i)
+        results = distrib_type((collapse) ? 1 : comm_size);
+        if(collapse)
+            results.front() = std::move(_merged);
+        else
         {
-            std::string str;
-            if(settings::debug())
-                printf("[RECV: %i]> starting %i\n", comm_rank, i);
-            mpi::recv(str, i, 0, comm);
-            if(settings::debug())
-                printf("[RECV: %i]> completed %i\n", comm_rank, i);
-            results[i] = recv_serialize(str);
+            results.front() = std::move(ret);
+            threading::thread_pool::instance().parallel_for(
+                _forward.size(), [&](size_t i) {
+                    results.at(_forward.at(i).first) =
+                        recv_serialize(_forward.at(i).second);
+                });
         }
-        results[comm_rank] = ret;
     }
     else
     {
         //
-        //  The non-root rank sends its data to the root rank and only reports own data
+        //  The non-root rank only reports own data
         //
-        if(settings::debug())
-            printf("[SEND: %i]> starting\n", comm_rank);
-        mpi::send(str_ret, 0, 0, comm);
-        if(settings::debug())
-            printf("[SEND: %i]> completed\n", comm_rank);
         results = distrib_type(1, ret);
     }
 
-    // collapse into a single result
-    if(settings::collapse_processes() && comm_rank == 0)
+    // processes were collapsed into a single result during the reduction
+    if(collapse && comm_rank == 0)
     {
-        auto init_size = get_num_records(results);
-        if(settings::debug() || settings::verbose() > 3)
-        {
-            PRINT_HERE("[%s][pid=%i][rank=%i]> collapsing %i records from %i ranks",
-                       demangle<mpi_get<Type, true>>().c_str(), (int) process::get_id(),
-                       comm_rank, init_size, comm_size);
-        }
-
-        auto _collapsed = distrib_type{};
-        // so we can pop off back
-        std::reverse(results.begin(), results.end());
-        while(!results.empty())
-        {
-            if(_collapsed.empty())
-                _collapsed.emplace_back(results.back());
-            else
-                operation::finalize::merge<Type, true>(_collapsed.front(),
-                                                       results.back());
-            results.pop_back();
-        }
-
-        // assign results to collapsed entry
-        results = _collapsed;
-
         if(settings::debug() || settings::verbose() > 3)
         {
             auto fini_size = get_num_records(results);
-            PRINT_HERE("[%s][pid=%i][rank=%i]> collapsed %i records into %i records "
-                       "from %i ranks",
+            PRINT_HERE("[%s][pid=%i][rank=%i]> collapsed into %i records from %i ranks",
                        demangle<mpi_get<Type, true>>().c_str(), (int) process::get_id(),
-                       comm_rank, init_size, fini_size, comm_size);
+                       comm_rank, fini_size, comm_size);
         }
     }
     else if(settings::node_count() > 0 && comm_rank == 0)
@@ -361,19 +418,25 @@ mpi_get<Type, true>::mpi_get(std::vector<Type>& dst, const Type& inp,
     if(comm_rank == 0)
     {
         //
-        //  The root rank receives data from all non-root ranks and reports all data
+        //  The root rank receives data from all non-root ranks and reports all data.
+        //  The messages are deserialized by the thread pool while the next ones are
+        //  received
         //
+        std::vector<std::future<void>> _recv{};
         for(int i = 1; i < comm_size; ++i)
         {
-            std::string str;
+            auto str = std::make_shared<std::string>();
             if(settings::debug())
                 printf("[RECV: %i]> starting %i\n", comm_rank, i);
-            mpi::recv(str, i, 0, comm);
+            mpi::recv(*str, i, 0, comm);
             if(settings::debug())
                 printf("[RECV: %i]> completed %i\n", comm_rank, i);
-            dst.at(i) = recv_serialize(str);
+            _recv.emplace_back(threading::thread_pool::instance().submit(
+                [&dst, &recv_serialize, str, i]() { dst.at(i) = recv_serialize(*str); }));
         }
         dst.at(0) = inp;
+        for(auto& itr : _recv)
+            itr.get();
     }
     else
     {
@@ -513,6 +576,99 @@ mpi_get<Type, true>::mpi_get(std::vector<Type>& dst, const Type& inp,
 //
 //--------------------------------------------------------------------------------------//
 //
+template <typename Type>
+std::string
+mpi_get<Type, true>::serialize(std::true_type, const result_type& src)
+{
+    using output_type =
+        policy::output_archive<cereal::BinaryOutputArchive, api::native_tag>;
+
+    std::stringstream ss;
+    {
+        // the component is written into a separate length-prefixed block because
+        // components save more fields (e.g. repr_data, units) than they load and
+        // binary archives are positional
+        std::stringstream ds;
+        auto              oa = output_type::get(ss);
+        (*oa)(static_cast<uint64_t>(src.size()));
+        for(const auto& itr : src)
+        {
+            ds.str("");
+            {
+                auto da = output_type::get(ds);
+                (*da)(itr.data());
+            }
+            (*oa)(itr.hash(), itr.prefix(), itr.depth(), itr.rolling_hash(),
+                  itr.hierarchy(), itr.stats(), itr.tid(), itr.pid(), ds.str());
+        }
+    }
+    return ss.str();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+std::string
+mpi_get<Type, true>::serialize(std::false_type, const result_type& src)
+{
+    std::stringstream ss;
+    {
+        auto oa = policy::output_archive<cereal::MinimalJSONOutputArchive,
+                                         api::native_tag>::get(ss);
+        (*oa)(cereal::make_nvp("data", src));
+    }
+    return ss.str();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename mpi_get<Type, true>::result_type
+mpi_get<Type, true>::deserialize(std::true_type, const std::string& src)
+{
+    using input_type = policy::input_archive<cereal::BinaryInputArchive, api::native_tag>;
+
+    result_type       ret;
+    std::stringstream ss;
+    ss << src;
+    {
+        auto     ia     = input_type::get(ss);
+        uint64_t nnodes = 0;
+        (*ia)(nnodes);
+        ret.resize(nnodes);
+        for(auto& itr : ret)
+        {
+            std::string _data;
+            (*ia)(itr.hash(), itr.prefix(), itr.depth(), itr.rolling_hash(),
+                  itr.hierarchy(), itr.stats(), itr.tid(), itr.pid(), _data);
+            std::stringstream ds;
+            ds << _data;
+            auto da = input_type::get(ds);
+            (*da)(itr.data());
+        }
+    }
+    return ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+typename mpi_get<Type, true>::result_type
+mpi_get<Type, true>::deserialize(std::false_type, const std::string& src)
+{
+    result_type       ret;
+    std::stringstream ss;
+    ss << src;
+    {
+        auto ia =
+            policy::input_archive<cereal::JSONInputArchive, api::native_tag>::get(ss);
+        (*ia)(cereal::make_nvp("data", ret));
+    }
+    return ret;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
 }  // namespace finalize
 }  // namespace operation
 }  // namespace tim
@@ -50,6 +50,8 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -62,6 +64,31 @@ namespace finalize
 //
 //--------------------------------------------------------------------------------------//
 //
+/// \struct tim::operation::finalize::buffered_ofstream
+/// \brief Output file stream which writes to the file in large blocks
+///
+struct buffered_ofstream : public std::ofstream
+{
+    static constexpr size_t buffer_size = (1 << 20);
+
+    explicit buffered_ofstream(const std::string& _fname,
+                               std::ios::openmode _mode = std::ios::out)
+    : m_buffer(new char[buffer_size])
+    {
+        // the buffer must be set before the file is opened
+        rdbuf()->pubsetbuf(m_buffer.get(), buffer_size);
+        open(_fname.c_str(), _mode);
+    }
+
+    // flush before the buffer is released
+    ~buffered_ofstream() { close(); }
+
+private:
+    std::unique_ptr<char[]> m_buffer;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
 #if !(defined(TIMEMORY_USE_EXTERN) || defined(TIMEMORY_USE_OPERATIONS_EXTERN)) ||        \
     defined(TIMEMORY_OPERATIONS_SOURCE)
 //
@@ -107,13 +134,13 @@ base::print::print_text(const std::string& outfname, stream_type stream)
 {
     if(outfname.length() > 0 && stream)
     {
-        std::ofstream fout(outfname.c_str());
+        buffered_ofstream fout(outfname);
         if(fout)
         {
             printf("[%s]|%i> Outputting '%s'...\n", label.c_str(), node_rank,
                    outfname.c_str());
             write(fout, stream);
-            manager::instance()->add_text_output(label, outfname);
+            manager::master_instance()->add_text_output(label, outfname);
         }
         else
         {
@@ -178,8 +205,9 @@ print<Tp, true>::setup()
     auto fext       = (is_minimal_json || is_pretty_json) ? ".json" : ".xml";
     auto extensions = tim::delimit(settings::input_extensions(), ",; ");
 
-    json_outfname = settings::compose_output_filename(label, fext);
-    text_outfname = settings::compose_output_filename(label, ".txt");
+    json_outfname   = settings::compose_output_filename(label, fext);
+    text_outfname   = settings::compose_output_filename(label, ".txt");
+    binary_outfname = settings::compose_output_filename(label, ".tmb");
 
     if(settings::diff_output())
     {
@@ -203,26 +231,6 @@ print<Tp, true>::setup()
         printf("difference filenames: '%s' and '%s'\n", json_diffname.c_str(),
                text_diffname.c_str());
     }
-
-    if(!(file_output && text_output) && !cout_output)
-        return;
-
-    write_stream(data_stream, node_results);
-    data_stream->set_banner(description);
-
-    if(node_delta.size() > 0)
-    {
-        write_stream(diff_stream, node_delta);
-        std::stringstream ss;
-        ss << description << " vs. " << json_inpfname;
-        if(input_concurrency != data_concurrency)
-        {
-            auto delta_conc = (data_concurrency - input_concurrency);
-            ss << " with " << delta_conc << " " << ((delta_conc > 0) ? "more" : "less")
-               << "threads";
-        }
-        diff_stream->set_banner(ss.str());
-    }
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -240,10 +248,7 @@ print<Tp, true>::write_stream(stream_type& stream, result_type& result_array)
     using get_return_type = decltype(std::declval<const Tp>().get());
     using compute_type    = math::compute<get_return_type>;
 
-    auto_lock_t slk(type_mutex<decltype(std::cout)>(), std::defer_lock);
-    if(!slk.owns_lock())
-        slk.lock();
-
+    // the rows are written to a stream owned by this instance so no lock is required
     auto result = get_flattened(result_array);
     for(auto itr = result.begin(); itr != result.end(); ++itr)
     {
@@ -317,6 +322,23 @@ print<Tp, true>::write_stream(stream_type& stream, result_type& result_array)
 //--------------------------------------------------------------------------------------//
 //
 template <typename Tp>
+std::string
+print<Tp, true>::get_diff_banner(const std::string& _prefix) const
+{
+    std::stringstream ss;
+    ss << _prefix << " vs. " << json_inpfname;
+    if(input_concurrency != data_concurrency)
+    {
+        auto delta_conc = (data_concurrency - input_concurrency);
+        ss << " with " << delta_conc << " " << ((delta_conc > 0) ? "more" : "less")
+           << "threads";
+    }
+    return ss.str();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Tp>
 void
 print<Tp, true>::update_data()
 {
@@ -359,16 +381,6 @@ print<Tp, true>::update_data()
                 }
             }
         }
-        write_stream(diff_stream, node_delta);
-        std::stringstream ss;
-        ss << description << " vs. " << json_inpfname;
-        if(input_concurrency != data_concurrency)
-        {
-            auto delta_conc = (data_concurrency - input_concurrency);
-            ss << " with " << delta_conc << " " << ((delta_conc > 0) ? "more" : "less")
-               << "threads";
-        }
-        diff_stream->set_banner(ss.str());
     }
 
 #if defined(DEBUG)
@@ -444,13 +456,13 @@ print<Tp, true>::print_json(const std::string& outfname, result_type& results,
 
     if(outfname.length() > 0)
     {
-        std::ofstream ofs(outfname.c_str());
+        buffered_ofstream ofs(outfname);
         if(ofs)
         {
             auto fext = outfname.substr(outfname.find_last_of(".") + 1);
             if(fext.empty())
                 fext = "unknown";
-            manager::instance()->add_file_output(fext, label, outfname);
+            manager::master_instance()->add_file_output(fext, label, outfname);
             printf("[%s]|%i> Outputting '%s'...\n", label.c_str(), node_rank,
                    outfname.c_str());
 
@@ -495,6 +507,62 @@ print<Tp, true>::print_json(const std::string& outfname, result_type& results,
 //
 template <typename Tp>
 void
+print<Tp, true>::print_binary(const std::string& outfname, result_type& results,
+                              int64_t concurrency)
+{
+    using archive_type = cereal::StreamingBinaryOutputArchive;
+    using bool_type    = typename trait::array_serialization<Tp>::type;
+
+    if(outfname.length() > 0)
+    {
+        buffered_ofstream ofs(outfname, std::ios::out | std::ios::binary);
+        if(ofs)
+        {
+            manager::master_instance()->add_file_output("tmb", label, outfname);
+            printf("[%s]|%i> Outputting '%s'...\n", label.c_str(), node_rank,
+                   outfname.c_str());
+
+            // same layout as print_json so the file converts directly to JSON.
+            // the graph is streamed to the file in blocks as it is serialized
+            // and the final block is written during destruction
+            auto oa = std::make_shared<archive_type>(ofs);
+
+            oa->setNextName("timemory");
+            oa->startNode();
+
+            // node
+            {
+                (*oa)(cereal::make_nvp("num_ranks", results.size()));
+                oa->setNextName("ranks");
+                oa->startNode();
+                oa->makeArray();
+                for(uint64_t i = 0; i < results.size(); ++i)
+                {
+                    if(results.at(i).empty())
+                        continue;
+
+                    oa->startNode();
+
+                    (*oa)(cereal::make_nvp("rank", i));
+                    (*oa)(cereal::make_nvp("concurrency", concurrency));
+                    print_metadata(bool_type{}, *oa, results.at(i).front().data());
+                    Tp::extra_serialization(*oa, 1);
+                    save(*oa, results.at(i));
+
+                    oa->finishNode();
+                }
+                oa->finishNode();
+            }
+            oa->finishNode();
+        }
+        ofs.close();
+    }
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Tp>
+void
 print<Tp, true>::print_dart()
 {
     using strvector_t = std::vector<std::string>;
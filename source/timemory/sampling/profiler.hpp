@@ -0,0 +1,658 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * \file timemory/sampling/profiler.hpp
+ * \brief Statistical profiler which samples the region stack of each thread from a
+ * per-thread CPU-time timer. Unlike \ref tim::sampling::sampler, which delivers
+ * SIGALRM/SIGPROF from a process-wide itimer, each thread arms its own POSIX timer
+ * on CLOCK_THREAD_CPUTIME_ID so samples are proportional to the CPU-time of the
+ * thread and the signal is always delivered to the thread which consumed it.
+ */
+
+#pragma once
+
+#include "timemory/hash/declaration.hpp"
+#include "timemory/settings/declaration.hpp"
+#include "timemory/utility/utility.hpp"
+
+// C++ includes
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_LINUX)
+// C includes
+#    include <dlfcn.h>
+#    include <execinfo.h>
+#    include <signal.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#    include <unistd.h>
+
+#    if !defined(sigev_notify_thread_id)
+#        define sigev_notify_thread_id _sigev_un._tid
+#    endif
+#endif
+
+namespace tim
+{
+namespace sampling
+{
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::region_stack
+/// \brief The hashes of the regions which are currently open on the calling thread.
+/// It is a fixed-size thread-local array so that the signal handler can read it
+/// without locks or allocations
+///
+struct region_stack
+{
+    static constexpr size_t max_depth = 128;
+
+    static region_stack& instance()
+    {
+        static thread_local region_stack _instance{};
+        return _instance;
+    }
+
+    void push(hash_result_type _hash)
+    {
+        if(depth < max_depth)
+            data[depth] = _hash;
+        std::atomic_signal_fence(std::memory_order_release);
+        ++depth;
+        std::atomic_signal_fence(std::memory_order_release);
+    }
+
+    void pop()
+    {
+        if(depth > 0)
+            --depth;
+        std::atomic_signal_fence(std::memory_order_release);
+    }
+
+    size_t           depth = 0;
+    hash_result_type data[max_depth] = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \struct tim::sampling::sample
+/// \brief A single sample: the innermost regions (outermost first) and, optionally,
+/// the native return addresses below the innermost region (innermost first)
+///
+struct sample
+{
+    static constexpr size_t max_regions = 32;
+    static constexpr size_t max_frames  = 16;
+
+    size_t           nregions             = 0;
+    size_t           nframes              = 0;
+    hash_result_type regions[max_regions] = {};
+    void*            frames[max_frames]   = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::sampling::sample_buffer
+/// \brief Single-producer, single-consumer ring of samples. The producer is the
+/// signal handler of the owning thread, the consumer is whichever thread aggregates
+/// the samples (serialized by \ref tim::sampling::profiler). When the ring is full,
+/// new samples are dropped and counted instead of blocking in the signal handler
+///
+class sample_buffer
+{
+public:
+    explicit sample_buffer(size_t _n)
+    : m_mask(next_pow2(std::max<size_t>(_n, 2)) - 1)
+    , m_data(new sample[m_mask + 1])
+    {}
+
+    /// returns a slot to write into or nullptr if the ring is full (producer)
+    sample* acquire()
+    {
+        auto _head = m_head.load(std::memory_order_relaxed);
+        if(_head - m_tail.load(std::memory_order_acquire) > m_mask)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &m_data[_head & m_mask];
+    }
+
+    /// publishes the slot returned by acquire (producer)
+    void commit() { m_head.fetch_add(1, std::memory_order_release); }
+
+    /// invokes \param _func on every published sample and releases them (consumer)
+    template <typename FuncT>
+    size_t consume(FuncT&& _func)
+    {
+        auto _tail = m_tail.load(std::memory_order_relaxed);
+        auto _head = m_head.load(std::memory_order_acquire);
+        for(auto i = _tail; i != _head; ++i)
+            _func(m_data[i & m_mask]);
+        m_tail.store(_head, std::memory_order_release);
+        return _head - _tail;
+    }
+
+    size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+    size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static size_t next_pow2(size_t _n)
+    {
+        size_t _v = 1;
+        while(_v < _n)
+            _v <<= 1;
+        return _v;
+    }
+
+private:
+    size_t                     m_mask = 0;
+    std::unique_ptr<sample[]>  m_data;
+    std::atomic<size_t>        m_head{ 0 };
+    std::atomic<size_t>        m_tail{ 0 };
+    std::atomic<size_t>        m_dropped{ 0 };
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::sampling::profiler
+/// \brief Arms a CLOCK_THREAD_CPUTIME_ID timer on each thread which calls \ref start
+/// and records the region stack (see \ref push and \ref pop) of the thread in the
+/// signal handler. Samples are aggregated by call-stack into a map of the hashes of
+/// the call-stack (outermost first) to the number of samples. The sampling period
+/// is controlled by \ref tim::settings::sampling_frequency, the size of the
+/// per-thread ring by \ref tim::settings::sampling_buffer and the number of native
+/// frames recorded below the innermost region by
+/// \ref tim::settings::sampling_backtrace. Note that the kernel only expires
+/// CPU-time timers on the scheduler tick so the effective frequency is limited to
+/// CONFIG_HZ.
+///
+class profiler
+{
+public:
+    using key_type       = std::vector<hash_result_type>;
+    using data_type      = std::map<key_type, uint64_t>;
+    using mutex_type     = std::mutex;
+    using lock_type      = std::unique_lock<mutex_type>;
+    using frame_map_type = std::unordered_map<void*, hash_result_type>;
+
+    /// the real-time signal used for sampling
+    static int& signal_number()
+    {
+#if defined(_LINUX)
+        static int _instance = SIGRTMIN + 2;
+#else
+        static int _instance = 0;
+#endif
+        return _instance;
+    }
+
+    /// sampling period in nanoseconds of thread CPU-time
+    static int64_t period()
+    {
+        auto _freq = std::max<double>(settings::sampling_frequency(), 1.0e-3);
+        return std::max<int64_t>(static_cast<int64_t>(1.0e9 / _freq), 1000);
+    }
+
+    /// enter a region on the calling thread
+    static void push(hash_result_type _hash) { region_stack::instance().push(_hash); }
+
+    /// exit a region on the calling thread
+    static void pop()
+    {
+        region_stack::instance().pop();
+        // keep the ring from filling up in long-running threads
+        auto* _data = get_thread_data();
+        if(_data && 2 * _data->buffer.size() > _data->buffer.capacity())
+            try_drain();
+    }
+
+    /// arm the sampling timer of the calling thread. Returns false if the timer could
+    /// not be created or sampling has been stopped via \ref stop_all
+    static bool start();
+
+    /// disarm the sampling timer of the calling thread and aggregate its samples
+    static void stop();
+
+    /// disarm the sampling timers of all threads and aggregate their samples.
+    /// Subsequent calls to \ref start are ignored
+    static void stop_all();
+
+    /// aggregate the samples of all threads
+    static void drain()
+    {
+        lock_type _lk(get_mutex());
+        drain_locked();
+    }
+
+    /// aggregate the samples of all threads if no other thread is aggregating
+    static void try_drain()
+    {
+        lock_type _lk(get_mutex(), std::try_to_lock);
+        if(_lk.owns_lock())
+            drain_locked();
+    }
+
+    /// aggregate the pending samples and return the number of samples per call-stack
+    static data_type get()
+    {
+        lock_type _lk(get_mutex());
+        drain_locked();
+        return get_data();
+    }
+
+    /// total number of samples dropped because a ring was full
+    static size_t dropped()
+    {
+        lock_type _lk(get_mutex());
+        return get_dropped();
+    }
+
+    /// discard the aggregated samples
+    static void reset()
+    {
+        lock_type _lk(get_mutex());
+        drain_locked();
+        get_data().clear();
+        get_dropped() = 0;
+    }
+
+    static bool is_active() { return get_active().load(); }
+
+private:
+    struct thread_data
+    {
+        explicit thread_data(size_t _n)
+        : buffer(_n)
+        {}
+
+        ~thread_data();
+
+        // disarmed by the owning thread and by stop_all so only one deletes the timer
+        std::atomic<bool> armed{ false };
+        size_t            nframes  = 0;
+        size_t            reported = 0;
+        sample_buffer     buffer;
+#if defined(_LINUX)
+        timer_t timer = {};
+#endif
+    };
+
+    using thread_data_set = std::set<thread_data*>;
+
+    static mutex_type& get_mutex()
+    {
+        static mutex_type _instance{};
+        return _instance;
+    }
+
+    static data_type& get_data()
+    {
+        static data_type _instance{};
+        return _instance;
+    }
+
+    static size_t& get_dropped()
+    {
+        static size_t _instance = 0;
+        return _instance;
+    }
+
+    static thread_data_set& get_threads()
+    {
+        static thread_data_set _instance{};
+        return _instance;
+    }
+
+    static frame_map_type& get_frames()
+    {
+        static frame_map_type _instance{};
+        return _instance;
+    }
+
+    static std::atomic<bool>& get_active()
+    {
+        static std::atomic<bool> _instance{ true };
+        return _instance;
+    }
+
+    // raw pointer read by the signal handler
+    static thread_data*& get_thread_data()
+    {
+        static thread_local thread_data* _instance = nullptr;
+        return _instance;
+    }
+
+    // owns the data of the thread and releases it when the thread exits
+    static std::unique_ptr<thread_data>& get_thread_owner()
+    {
+        static thread_local std::unique_ptr<thread_data> _instance{};
+        return _instance;
+    }
+
+    static bool configure();
+#if defined(_LINUX)
+    static void execute(int, siginfo_t*, void*);
+#endif
+    static void disarm(thread_data*);
+    static void drain_locked();
+    static void drain_locked(thread_data*);
+    static hash_result_type resolve(void*);
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+#if defined(_LINUX)
+//
+//--------------------------------------------------------------------------------------//
+//
+inline profiler::thread_data::~thread_data()
+{
+    get_thread_data() = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    disarm(this);
+    lock_type _lk(get_mutex());
+    drain_locked(this);
+    get_threads().erase(this);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline bool
+profiler::configure()
+{
+    static bool _configured = []() {
+        struct sigaction _action;
+        memset(&_action, 0, sizeof(_action));
+        sigemptyset(&_action.sa_mask);
+        _action.sa_sigaction = &profiler::execute;
+        _action.sa_flags     = SA_SIGINFO | SA_RESTART;
+        return (sigaction(signal_number(), &_action, nullptr) == 0);
+    }();
+    return _configured;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline bool
+profiler::start()
+{
+    if(!get_active().load() || !configure())
+        return false;
+
+    auto& _owner = get_thread_owner();
+    if(!_owner)
+    {
+        _owner.reset(new thread_data(settings::sampling_buffer()));
+        lock_type _lk(get_mutex());
+        get_threads().insert(_owner.get());
+    }
+
+    if(_owner->armed.load())
+        return true;
+
+    // touch the thread-local region stack and load the unwinder before the timer
+    // is armed so that neither allocates inside the signal handler
+    (void) region_stack::instance();
+    _owner->nframes = std::min<size_t>(
+        std::max<int>(settings::sampling_backtrace(), 0), size_t{ sample::max_frames });
+    if(_owner->nframes > 0)
+    {
+        void* _frames[2];
+        (void) backtrace(_frames, 2);
+    }
+
+    struct sigevent _event;
+    memset(&_event, 0, sizeof(_event));
+    _event.sigev_notify           = SIGEV_THREAD_ID;
+    _event.sigev_signo            = signal_number();
+    _event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+
+    if(timer_create(CLOCK_THREAD_CPUTIME_ID, &_event, &_owner->timer) != 0)
+    {
+        if(settings::verbose() > 0 || settings::debug())
+            perror("[timemory]> tim::sampling::profiler::start :: timer_create");
+        return false;
+    }
+
+    auto              _period = period();
+    struct itimerspec _spec;
+    _spec.it_interval.tv_sec  = _period / 1000000000L;
+    _spec.it_interval.tv_nsec = _period % 1000000000L;
+    _spec.it_value            = _spec.it_interval;
+
+    get_thread_data() = _owner.get();
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    _owner->armed.store(true);
+
+    if(timer_settime(_owner->timer, 0, &_spec, nullptr) != 0)
+    {
+        if(settings::verbose() > 0 || settings::debug())
+            perror("[timemory]> tim::sampling::profiler::start :: timer_settime");
+        get_thread_data() = nullptr;
+        disarm(_owner.get());
+        return false;
+    }
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::stop()
+{
+    auto& _owner = get_thread_owner();
+    if(!_owner)
+        return;
+    get_thread_data() = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    disarm(_owner.get());
+    drain();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::stop_all()
+{
+    get_active().store(false);
+    lock_type _lk(get_mutex());
+    for(auto* itr : get_threads())
+        disarm(itr);
+    drain_locked();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::disarm(thread_data* _data)
+{
+    // timer_delete is thread-safe and guarantees no further expirations are queued
+    // but a pending signal may still be delivered so the ring must outlive this call
+    if(_data && _data->armed.exchange(false))
+        timer_delete(_data->timer);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::execute(int, siginfo_t*, void*)
+{
+    auto _errno = errno;
+    auto* _data = get_thread_data();
+    if(!_data)
+        return;
+
+    auto* _sample = _data->buffer.acquire();
+    if(_sample)
+    {
+        auto& _stack   = region_stack::instance();
+        auto  _depth =
+            std::min<size_t>(_stack.depth, size_t{ region_stack::max_depth });
+        auto  _nregion = std::min<size_t>(_depth, size_t{ sample::max_regions });
+        // keep the innermost regions when the stack is deeper than a sample
+        for(size_t i = 0; i < _nregion; ++i)
+            _sample->regions[i] = _stack.data[_depth - _nregion + i];
+        _sample->nregions = _nregion;
+        _sample->nframes  = 0;
+        if(_data->nframes > 0)
+        {
+            // skip this function and the signal trampoline
+            constexpr int _skip = 2;
+            void*         _frames[sample::max_frames + _skip];
+            auto          _n = backtrace(_frames, _data->nframes + _skip);
+            for(int i = _skip; i < _n; ++i)
+                _sample->frames[_sample->nframes++] = _frames[i];
+        }
+        _data->buffer.commit();
+    }
+    errno = _errno;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline hash_result_type
+profiler::resolve(void* _addr)
+{
+    auto& _frames = get_frames();
+    auto  itr     = _frames.find(_addr);
+    if(itr != _frames.end())
+        return itr->second;
+
+    std::string _name{};
+    Dl_info     _info;
+    if(dladdr(_addr, &_info) != 0 && _info.dli_sname)
+        _name = demangle(_info.dli_sname);
+    else
+    {
+        std::stringstream ss;
+        ss << "[" << _addr << "]";
+        _name = ss.str();
+    }
+    return (_frames[_addr] = add_hash_id(_name));
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::drain_locked(thread_data* _data)
+{
+    static auto _empty = add_hash_id("[no region]");
+    auto&       _agg   = get_data();
+    key_type    _key{};
+    _data->buffer.consume([&](const sample& _sample) {
+        _key.clear();
+        _key.reserve(_sample.nregions + _sample.nframes);
+        for(size_t i = 0; i < _sample.nregions; ++i)
+            _key.emplace_back(_sample.regions[i]);
+        // frames are innermost-first
+        for(size_t i = _sample.nframes; i > 0; --i)
+            _key.emplace_back(resolve(_sample.frames[i - 1]));
+        if(_key.empty())
+            _key.emplace_back(_empty);
+        _agg[_key] += 1;
+    });
+    auto _dropped = _data->buffer.dropped();
+    get_dropped() += _dropped - _data->reported;
+    _data->reported = _dropped;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+inline void
+profiler::drain_locked()
+{
+    for(auto* itr : get_threads())
+        drain_locked(itr);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+#else
+//
+//--------------------------------------------------------------------------------------//
+//
+inline profiler::thread_data::~thread_data() {}
+inline bool
+profiler::configure()
+{
+    return false;
+}
+inline bool
+profiler::start()
+{
+    return false;
+}
+inline void
+profiler::stop()
+{}
+inline void
+profiler::stop_all()
+{
+    get_active().store(false);
+}
+inline void
+profiler::disarm(thread_data*)
+{}
+inline void
+profiler::drain_locked(thread_data*)
+{}
+inline void
+profiler::drain_locked()
+{}
+inline hash_result_type
+profiler::resolve(void*)
+{
+    return 0;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+#endif
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace sampling
+}  // namespace tim
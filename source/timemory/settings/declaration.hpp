@@ -110,6 +110,19 @@ struct TIMEMORY_SETTINGS_DLL settings
                                     "Write text output files", true)
     TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, json_output, "TIMEMORY_JSON_OUTPUT",
                                     "Write json output files", true)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, binary_output, "TIMEMORY_BINARY_OUTPUT",
+        "Write streaming binary output files (.tmb, see timemory.util.binary)", false)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, binary_only_output, "TIMEMORY_BINARY_ONLY_OUTPUT",
+        "Skip formatting the text, json, and stdout output and only write the binary "
+        "output files",
+        false)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, output_threads, "TIMEMORY_OUTPUT_THREADS",
+        "Number of threads used to format and write the output of the components at "
+        "finalization (0 = hardware concurrency)",
+        1)
     TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, dart_output, "TIMEMORY_DART_OUTPUT",
                                     "Write dart measurements for CDash", false)
     TIMEMORY_MEMBER_STATIC_ACCESSOR(
@@ -126,6 +139,28 @@ struct TIMEMORY_SETTINGS_DLL settings
     TIMEMORY_MEMBER_STATIC_ACCESSOR(
         bool, flamegraph_output, "TIMEMORY_FLAMEGRAPH_OUTPUT",
         "Write a json output for flamegraph visualization (use chrome://tracing)", true)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, trace_output, "TIMEMORY_TRACE_OUTPUT",
+        "Record the begin/end of every measurement per thread and write a Chrome trace "
+        "event file (use chrome://tracing or ui.perfetto.dev)",
+        false)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, trace_buffer, "TIMEMORY_TRACE_BUFFER",
+        "Number of trace events per thread buffered before being streamed to disk",
+        16384)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, snapshot_interval, "TIMEMORY_SNAPSHOT_INTERVAL",
+        "Seconds between the snapshots of the call-graph (difference vs. the previous "
+        "snapshot) appended to the <LABEL>.snapshot.jsonl output files (0 = none)",
+        0.0)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        string_t, export_socket, "TIMEMORY_EXPORT_SOCKET",
+        "Path of a Unix domain socket which serves the current call-graphs to "
+        "timemory-query without finalizing ('%p' is replaced by the PID, empty = none)",
+        "")
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        string_t, export_components, "TIMEMORY_EXPORT_COMPONENTS",
+        "Labels of the components served by TIMEMORY_EXPORT_SOCKET (empty = all)", "")
 
     // general settings
     TIMEMORY_MEMBER_STATIC_ACCESSOR(int, verbose, "TIMEMORY_VERBOSE", "Verbosity level",
@@ -145,6 +180,19 @@ struct TIMEMORY_SETTINGS_DLL settings
         "Set the label hierarchy mode to default to timeline",
         ([]() -> bool& { return scope::get_fields()[scope::timeline::value]; }),
         ([](bool v) { scope::get_fields()[scope::timeline::value] = v; }))
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, timeline_buffer, "TIMEMORY_TIMELINE_BUFFER",
+        "Number of events per thread held in a ring buffer in the timeline scope "
+        "instead of creating a call-graph node for every invocation (0 = disabled)",
+        0)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, timeline_flush, "TIMEMORY_TIMELINE_FLUSH",
+        "Stream full timeline buffers to disk in the background, otherwise only the "
+        "most recent TIMEMORY_TIMELINE_BUFFER events per thread are retained",
+        true)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, timeline_compress,
+                                    "TIMEMORY_TIMELINE_COMPRESS",
+                                    "Delta + varint compress the timeline output", true)
     TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, collapse_threads, "TIMEMORY_COLLAPSE_THREADS",
                                     "Enable/disable combining thread-specific data", true)
     TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, collapse_processes,
@@ -247,10 +295,32 @@ struct TIMEMORY_SETTINGS_DLL settings
         " the master thread. Higher values tend to increase the finalization merge time",
         50)
 
+    /// number of threads used to reduce the worker-thread call-graphs during finalization
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, merge_threads, "TIMEMORY_MERGE_THREADS",
+        "Number of threads used to pairwise-reduce the worker-thread call-graphs before "
+        "they are merged into the master call-graph (0 = hardware concurrency, 1 = "
+        "serial merge)",
+        0)
+
+    /// worker threads hand off their call-graph to a background merger at this interval
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, merge_interval, "TIMEMORY_MERGE_INTERVAL",
+        "When > 0, worker threads hand off their completed call-graph to a background "
+        "merger every N times they return to the call-graph depth they were forked at",
+        0)
+
     /// enable thread affinity
     TIMEMORY_MEMBER_STATIC_ACCESSOR(bool, cpu_affinity, "TIMEMORY_CPU_AFFINITY",
                                     "Enable pinning threads to CPUs (Linux-only)", false)
 
+    /// number of workers of the internal thread pool
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, thread_pool_size, "TIMEMORY_THREAD_POOL_SIZE",
+        "Number of workers of the internal thread pool used by ERT, merging, output, and "
+        "MPI processing (0 = number of CPUs available to the process)",
+        0)
+
     /// target pid
     TIMEMORY_MEMBER_STATIC_REFERENCE(
         process::id_t, target_pid, "TIMEMORY_TARGET_PID",
@@ -276,6 +346,30 @@ struct TIMEMORY_SETTINGS_DLL settings
         "throttling",
         10000)
 
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, throttle_hysteresis, "TIMEMORY_THROTTLE_HYSTERESIS",
+        "Factor by which a re-enabled function must exceed the throttling criteria to "
+        "not be throttled again",
+        2.0)
+
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, throttle_budget, "TIMEMORY_THROTTLE_BUDGET",
+        "Percentage of the instrumented run-time allowed for instrumentation overhead "
+        "before throttling the functions with the largest relative overhead (0 = use "
+        "throttle_value)",
+        0.0)
+
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, throttle_interval, "TIMEMORY_THROTTLE_INTERVAL",
+        "Seconds between re-enabling throttled functions for re-evaluation (0 = never)",
+        10.0)
+
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, region_batch_size, "TIMEMORY_REGION_BATCH_SIZE",
+        "Number of completed records of a region id accumulated per-thread before being "
+        "inserted into storage (0 = insert every record)",
+        0)
+
     //==================================================================================//
     //
     //                          COMPONENTS SPECIFIC SETTINGS
@@ -545,6 +639,34 @@ struct TIMEMORY_SETTINGS_DLL settings
     TIMEMORY_MEMBER_STATIC_ACCESSOR(
         string_t, ert_skip_ops, "TIMEMORY_ERT_SKIP_OPS",
         "Skip these number of ops (i.e. ERT_FLOPS) when were set at compile time", "")
+    /// pin the ERT threads to the CPUs
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, ert_pin_threads, "TIMEMORY_ERT_PIN_THREADS",
+        "Pin the threads of ERT to the CPUs in the affinity mask of the process (in the "
+        "order of the affinity mode) and measure the bandwidth of each socket",
+        true)
+    /// measure the bandwidth and latency of each level of the memory hierarchy
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, ert_cache_sweep, "TIMEMORY_ERT_CACHE_SWEEP",
+        "Measure the read, write, copy, and triad bandwidth and the latency of each "
+        "level of the memory hierarchy (L1, L2, L3, DRAM) in the CPU roofline",
+        true)
+    /// reuse the ERT results of previous runs
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        bool, ert_cache, "TIMEMORY_ERT_CACHE",
+        "Reuse the ERT results of a previous run with the same host, CPU model, number "
+        "of CPUs, ERT parameters, and timemory version instead of re-running ERT",
+        true)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        string_t, ert_cache_dir, "TIMEMORY_ERT_CACHE_DIR",
+        "Directory of the cached ERT results (empty = "
+        "${XDG_CACHE_HOME:-${HOME}/.cache}/timemory/ert)",
+        "")
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, ert_cache_max_age, "TIMEMORY_ERT_CACHE_MAX_AGE",
+        "Hours after which the cached ERT results are stale and ERT is re-run "
+        "(0 = never stale)",
+        168.0)
 
     //----------------------------------------------------------------------------------//
     //      Craypat
@@ -555,6 +677,23 @@ struct TIMEMORY_SETTINGS_DLL settings
                                     "Configure the CrayPAT categories to collect",
                                     get_env<std::string>("PAT_RT_PERFCTR", ""))
 
+    //----------------------------------------------------------------------------------//
+    //      Sampling
+    //----------------------------------------------------------------------------------//
+
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        double, sampling_frequency, "TIMEMORY_SAMPLING_FREQUENCY",
+        "Number of samples per second of thread CPU-time taken by sampling_cpu_clock",
+        100.0)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        size_t, sampling_buffer, "TIMEMORY_SAMPLING_BUFFER",
+        "Number of samples per thread buffered before being aggregated", 1024)
+    TIMEMORY_MEMBER_STATIC_ACCESSOR(
+        int, sampling_backtrace, "TIMEMORY_SAMPLING_BACKTRACE",
+        "Number of native call-stack frames recorded in each sample below the innermost "
+        "region (0 records only the regions)",
+        0)
+
     //----------------------------------------------------------------------------------//
     //      Signals
     //----------------------------------------------------------------------------------//
@@ -752,16 +891,27 @@ settings::serialize(Archive& ar, const unsigned int)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_FILE_OUTPUT", file_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TEXT_OUTPUT", text_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_JSON_OUTPUT", json_output)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_BINARY_OUTPUT", binary_output)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_BINARY_ONLY_OUTPUT", binary_only_output)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_OUTPUT_THREADS", output_threads)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_DART_OUTPUT", dart_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TIME_OUTPUT", time_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_PLOT_OUTPUT", plot_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_DIFF_OUTPUT", diff_output)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_FLAMEGRAPH_OUTPUT", flamegraph_output)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TRACE_OUTPUT", trace_output)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TRACE_BUFFER", trace_buffer)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_SNAPSHOT_INTERVAL", snapshot_interval)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_EXPORT_SOCKET", export_socket)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_EXPORT_COMPONENTS", export_components)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_VERBOSE", verbose)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_DEBUG", debug)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_BANNER", banner)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_FLAT_PROFILE", flat_profile)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TIMELINE_PROFILE", timeline_profile)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TIMELINE_BUFFER", timeline_buffer)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TIMELINE_FLUSH", timeline_flush)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TIMELINE_COMPRESS", timeline_compress)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_COLLAPSE_THREADS", collapse_threads)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_COLLAPSE_PROCESSES", collapse_processes)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_MAX_DEPTH", max_depth)
@@ -791,12 +941,19 @@ settings::serialize(Archive& ar, const unsigned int)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_DART_COUNT", dart_count)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_DART_LABEL", dart_label)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_CPU_AFFINITY", cpu_affinity)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THREAD_POOL_SIZE", thread_pool_size)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_MAX_THREAD_BOOKMARKS", max_thread_bookmarks)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_MERGE_THREADS", merge_threads)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_MERGE_INTERVAL", merge_interval)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_TARGET_PID", target_pid)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_STACK_CLEARING", stack_clearing)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ADD_SECONDARY", add_secondary)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THROTTLE_COUNT", throttle_count)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THROTTLE_VALUE", throttle_value)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THROTTLE_HYSTERESIS", throttle_hysteresis)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THROTTLE_BUDGET", throttle_budget)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_THROTTLE_INTERVAL", throttle_interval)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_REGION_BATCH_SIZE", region_batch_size)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_PAPI_MULTIPLEXING", papi_multiplexing)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_PAPI_FAIL_ON_ERROR", papi_fail_on_error)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_PAPI_QUIET", papi_quiet)
@@ -841,6 +998,14 @@ settings::serialize(Archive& ar, const unsigned int)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_MAX_DATA_SIZE_GPU",
                                     ert_max_data_size_gpu)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_SKIP_OPS", ert_skip_ops)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_PIN_THREADS", ert_pin_threads)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_CACHE_SWEEP", ert_cache_sweep)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_CACHE", ert_cache)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_CACHE_DIR", ert_cache_dir)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ERT_CACHE_MAX_AGE", ert_cache_max_age)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_SAMPLING_FREQUENCY", sampling_frequency)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_SAMPLING_BUFFER", sampling_buffer)
+    TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_SAMPLING_BACKTRACE", sampling_backtrace)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ALLOW_SIGNAL_HANDLER", allow_signal_handler)
     TIMEMORY_SETTINGS_TRY_CATCH_NVP("TIMEMORY_ENABLE_SIGNAL_HANDLER",
                                     enable_signal_handler)
@@ -41,7 +41,10 @@
 #include "timemory/storage/graph.hpp"
 #include "timemory/storage/graph_data.hpp"
 #include "timemory/storage/macros.hpp"
+#include "timemory/storage/export.hpp"
 #include "timemory/storage/node.hpp"
+#include "timemory/storage/snapshot.hpp"
+#include "timemory/storage/timeline.hpp"
 #include "timemory/storage/types.hpp"
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/serializer.hpp"
@@ -325,7 +328,15 @@ public:
     using printer_t      = operation::finalize::print<Type, has_data_v>;
     using sample_array_t = std::vector<Type>;
     using graph_node_t   = graph_node;
-    using graph_data_t   = graph_data<graph_node_t>;
+    using graph_alloc_t  = conditional_t<trait::graph_arena<Type>::value,
+                                        graph_arena_allocator<tgraph_node<graph_node_t>>,
+                                        std::allocator<tgraph_node<graph_node_t>>>;
+    using graph_data_t   = graph_data<graph_node_t, graph_alloc_t>;
+    using merger_t       = graph_data_merger<graph_data_t>;
+    using timeline_t     = timeline_buffer<Type>;
+    using timeline_wr_t  = timeline_writer<Type>;
+    using trace_wr_t     = chrome_trace_writer<Type>;
+    using snapshot_t     = graph_snapshot<Type>;
     using graph_t        = typename graph_data_t::graph_t;
     using graph_type     = graph_t;
     using iterator       = typename graph_type::iterator;
@@ -411,6 +422,26 @@ public:
 
     void insert_init();
 
+    /// complete the timeline event of a component which was inserted in the timeline
+    /// scope while TIMEMORY_TIMELINE_BUFFER was enabled (no graph node was created)
+    bool timeline_stop(const Type* obj) { return (m_timeline) && m_timeline->stop(obj); }
+    const timeline_t* get_timeline() const { return m_timeline.get(); }
+    /// per-thread buffer of begin/end events written to the Chrome trace when
+    /// TIMEMORY_TRACE_OUTPUT is enabled
+    const timeline_t* get_trace() const { return m_trace.get(); }
+    /// queue the difference of the graph vs. the previous snapshot for the snapshot file
+    /// (see TIMEMORY_SNAPSHOT_INTERVAL). Must be called by the thread owning the graph
+    void write_snapshot();
+    /// block until the snapshots queued by all the threads have been written
+    void wait_snapshots()
+    {
+        if(m_snapshot_writer)
+            m_snapshot_writer->wait();
+    }
+    /// publish the graph to the slot served by the metrics server (see
+    /// TIMEMORY_EXPORT_SOCKET). Must be called by the thread owning the graph
+    void write_export();
+
     iterator insert(scope::config scope_data, const Type& obj, uint64_t hash_id);
 
     // append a value to the the graph
@@ -444,7 +475,15 @@ protected:
     string_t get_prefix(const uint64_t& _id);
 
 private:
+    static bool combine_nodes(graph_node_t& _lhs, const graph_node_t& _rhs);
+
     void check_consistency();
+    bool handoff();
+    bool timeline_init();
+    void timeline_finalize();
+    bool trace_init();
+    void trace_finalize();
+    void snapshot_finalize();
 
     template <typename Archive>
     void do_serialize(Archive& ar);
@@ -459,12 +498,25 @@ private:
     }
 
 private:
-    uint64_t                   m_timeline_counter    = 1;
-    mutable graph_data_t*      m_graph_data_instance = nullptr;
-    iterator_hash_map_t        m_node_ids;
-    std::unordered_set<Type*>  m_stack;
-    std::shared_ptr<printer_t> m_printer;
-    sample_array_t             m_samples;
+    uint64_t                         m_timeline_counter    = 1;
+    uint64_t                         m_sea_level_count     = 0;
+    uint64_t                         m_snapshot_generation = 0;
+    uint64_t                         m_snapshot_request    = 0;
+    uint64_t                         m_export_epoch        = 0;
+    mutable graph_data_t*            m_graph_data_instance = nullptr;
+    iterator                         m_flat_current        = nullptr;
+    iterator_hash_map_t              m_node_ids;
+    std::unordered_set<Type*>        m_stack;
+    std::shared_ptr<printer_t>       m_printer;
+    sample_array_t                   m_samples;
+    std::unique_ptr<merger_t>        m_merger;
+    std::unique_ptr<timeline_t>      m_timeline;
+    std::shared_ptr<timeline_wr_t>   m_timeline_writer;
+    std::unique_ptr<timeline_t>      m_trace;
+    std::shared_ptr<trace_wr_t>      m_trace_writer;
+    std::unique_ptr<snapshot_t>      m_snapshot;
+    std::shared_ptr<snapshot_writer> m_snapshot_writer;
+    std::shared_ptr<export_slot>     m_export_slot;
 };
 //
 //--------------------------------------------------------------------------------------//
@@ -476,6 +528,10 @@ storage<Type, true>::reset()
     // have the data graph erase all children of the head node
     if(m_graph_data_instance)
         m_graph_data_instance->reset();
+    // discard any call-graphs handed off by the worker threads
+    if(m_merger)
+        m_merger->release();
+    m_flat_current = nullptr;
     // erase all the cached iterators except for m_node_ids[0][0]
     for(auto& ditr : m_node_ids)
     {
@@ -500,6 +556,18 @@ typename storage<Type, true>::iterator
 storage<Type, true>::insert(scope::config scope_data, const Type& obj, uint64_t hash_id)
 {
     insert_init();
+
+    // record the begin of the event in the trace (completed in stack_pop)
+    if(trace_init())
+        m_trace->start(&obj, hash_id);
+
+    // record a fixed-size event instead of creating a unique node in the graph
+    if(scope_data.is_timeline() && timeline_init())
+    {
+        m_timeline->start(&obj, hash_id);
+        return iterator{ nullptr };
+    }
+
     auto hash_depth = scope_data.compute_depth(_data().depth());
     auto hash_value = scope_data.compute_hash(hash_id, hash_depth, m_timeline_counter);
     add_hash_id(hash_id, hash_value);
@@ -643,11 +711,10 @@ template <typename Type>
 typename storage<Type, true>::iterator
 storage<Type, true>::insert_flat(uint64_t hash_id, const Type& obj, uint64_t hash_depth)
 {
-    static thread_local auto _current = _data().head();
-    static thread_local bool _first   = true;
-    if(_first)
+    auto& _current = m_flat_current;
+    if(!_current)
     {
-        _first = false;
+        _current = _data().head();
         if(_current.begin())
             _current = _current.begin();
         else
@@ -660,13 +727,18 @@ storage<Type, true>::insert_flat(uint64_t hash_id, const Type& obj, uint64_t has
         }
     }
 
+    auto _cached = _data().find_child(_current, hash_id);
+    if(_cached)
+        return _cached;
+
     auto _existing = m_node_ids[hash_depth].find(hash_id);
     if(_existing != m_node_ids[hash_depth].end())
-        return m_node_ids[hash_depth].find(hash_id)->second;
+        return _existing->second;
 
     graph_node_t node(hash_id, obj, hash_depth, m_thread_idx);
     auto         itr                = _data().emplace_child(_current, node);
     m_node_ids[hash_depth][hash_id] = itr;
+    _data().cache_child(itr);
     return itr;
 }
 //
@@ -688,6 +760,7 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
         graph_node_t node(hash_id, obj, hash_depth, tid);
         auto         itr                = m_data->append_child(node);
         m_node_ids[hash_depth][hash_id] = itr;
+        m_data->cache_child(itr);
         return itr;
     }
 
@@ -697,6 +770,11 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
         return (m_data->current() = itr);
     };
 
+    // re-entering an existing call-path: single probe keyed by (current, hash_id)
+    auto _cached = m_data->find_child(m_data->current(), hash_id);
+    if(_cached)
+        return _update(_cached);
+
     if(m_node_ids[hash_depth].find(hash_id) != m_node_ids[hash_depth].end() &&
        m_node_ids[hash_depth].find(hash_id)->second->depth() == m_data->depth())
     {
@@ -710,6 +788,7 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
     auto _insert_child = [&]() {
         node.depth() = hash_depth;
         auto itr     = m_data->append_child(node);
+        m_data->cache_child(itr);
         auto ditr    = m_node_ids.find(hash_depth);
         if(ditr == m_node_ids.end())
             m_node_ids.insert({ hash_depth, id_hash_map_t{} });
@@ -731,7 +810,10 @@ storage<Type, true>::insert_hierarchy(uint64_t hash_id, const Type& obj,
         for(sibling_itr itr = fchild.begin(); itr != fchild.end(); ++itr)
         {
             if((hash_id) == itr->id())
+            {
+                m_data->cache_child(itr);
                 return _update(itr);
+            }
         }
     }
 
@@ -1108,7 +1190,7 @@ base::storage::base_instance()
     // if nullptr, try to get instance
     if(_ret == nullptr)
     {
-        // thread will copy the hash-table so use a lock here
+        // serialize the construction of the worker storage instances
         auto_lock_t lk(type_mutex<base::storage>());
         _ret = static_cast<base::storage*>(storage_type::instance());
     }
@@ -39,8 +39,11 @@
 #include "timemory/storage/declaration.hpp"
 #include "timemory/storage/types.hpp"
 
+#include <chrono>
 #include <fstream>
 #include <memory>
+#include <sstream>
+#include <vector>
 
 namespace tim
 {
@@ -197,25 +200,6 @@ storage<Type, true>::storage()
 
     component::state<Type>::has_storage() = true;
 
-    static std::atomic<int32_t> _skip_once(0);
-    if(_skip_once++ > 0)
-    {
-        // make sure all worker instances have a copy of the hash id and aliases
-        auto               _master       = singleton_t::master_instance();
-        graph_hash_map_t   _hash_ids     = *_master->get_hash_ids();
-        graph_hash_alias_t _hash_aliases = *_master->get_hash_aliases();
-        for(const auto& itr : _hash_ids)
-        {
-            if(m_hash_ids->find(itr.first) == m_hash_ids->end())
-                m_hash_ids->insert({ itr.first, itr.second });
-        }
-        for(const auto& itr : _hash_aliases)
-        {
-            if(m_hash_aliases->find(itr.first) == m_hash_aliases->end())
-                m_hash_aliases->insert({ itr.first, itr.second });
-        }
-    }
-
     get_shared_manager();
     m_printer = std::make_shared<printer_t>(Type::get_label(), this);
 }
@@ -230,6 +214,12 @@ storage<Type, true>::~storage()
     if(settings::debug())
         printf("[%s]> destructing @ %i...\n", m_label.c_str(), __LINE__);
 
+    if(m_timeline)
+        m_timeline->flush();
+
+    if(m_trace)
+        m_trace->flush();
+
     if(!m_is_master)
         singleton_t::master_instance()->merge(this);
 
@@ -248,6 +238,18 @@ storage<Type, true>::initialize()
     if(settings::debug())
         printf("[%s]> initializing...\n", m_label.c_str());
     m_initialized = true;
+    // does nothing if snapshots are disabled or the clock is already running
+    snapshot_clock::instance().start(settings::snapshot_interval());
+    // does nothing if there is no export socket or the server is already running
+    metrics_server::instance().start(settings::export_socket(),
+                                     settings::export_components());
+    // register the slot up front so a request before the first pop waits for it
+    if(metrics_server::instance().is_running() &&
+       metrics_server::instance().is_selected(Type::get_label()) && !m_export_slot)
+    {
+        m_export_slot = std::make_shared<export_slot>(Type::get_label(), m_thread_idx);
+        metrics_server::instance().add(m_export_slot);
+    }
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -459,20 +461,380 @@ storage<Type, true>::pop()
     // threads should insert a new dummy at the current master thread id and depth.
     // Be aware, this changes 'm_current' inside the data graph
     //
-    if(_data().at_sea_level() && _data().dummy_count() < settings::max_thread_bookmarks())
-        _data().add_dummy();
+    if(_data().at_sea_level())
+    {
+        // periodically hand off the completed call-graph to the background merger.
+        // The replacement graph is already forked at the current master position
+        auto _interval = settings::merge_interval();
+        if(!m_is_master && _interval > 0 && (++m_sea_level_count % _interval) == 0 &&
+           handoff())
+            return _data().current();
+        if(_data().dummy_count() < settings::max_thread_bookmarks())
+            _data().add_dummy();
+    }
     return itr;
 }
 //
 //--------------------------------------------------------------------------------------//
 //
 template <typename Type>
+bool
+storage<Type, true>::combine_nodes(graph_node_t& _lhs, const graph_node_t& _rhs)
+{
+    // the nodes of different threads are only reported as one node when the thread
+    // data is collapsed
+    if(_lhs.tid() != _rhs.tid() &&
+       (!settings::collapse_threads() || trait::thread_scope_only<Type>::value))
+        return false;
+    _lhs.obj() += _rhs.obj();
+    _lhs.obj().plus(_rhs.obj());
+    _lhs.stats() += _rhs.stats();
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+bool
+storage<Type, true>::handoff()
+{
+    using object_base_t = typename Type::base_type;
+
+    auto _master = singleton_t::master_instance();
+    if(m_is_master || !_master || _master == this || !m_graph_data_instance)
+        return false;
+
+    auto& _mdata    = _master->data();
+    auto  _mcurrent = _mdata.current();
+    if(!_mcurrent)
+        return false;
+
+    // report the data of the previous graph before it is handed off. The data of the
+    // handed off graphs is only merged into the master graph at finalization
+    if(m_snapshot)
+    {
+        write_snapshot();
+        m_snapshot->rebase({});
+    }
+
+    auto         _depth = _mcurrent->depth();
+    graph_node_t _node(_mcurrent->id(), object_base_t::dummy(), _depth, m_thread_idx);
+
+    std::unique_ptr<graph_data_t> _prev{ m_graph_data_instance };
+    m_graph_data_instance = new graph_data_t(_node, _depth, &_mdata);
+
+    // all the cached iterators refer to the previous graph
+    m_flat_current = nullptr;
+    m_node_ids.clear();
+    m_node_ids[0][0] = m_graph_data_instance->current();
+
+    {
+        auto_lock_t _lk(singleton_t::get_mutex());
+        if(!_master->m_merger)
+            _master->m_merger.reset(new merger_t{ &this_type::combine_nodes });
+    }
+    _master->m_merger->push(std::move(_prev));
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+bool
+storage<Type, true>::timeline_init()
+{
+    if(m_timeline)
+        return true;
+
+    if(!timeline_t::is_supported || settings::timeline_buffer() == 0 || is_finalizing())
+        return false;
+
+    auto _master = singleton_t::master_instance();
+    if(!_master)
+        _master = this;
+
+    {
+        // all the threads share the writer of the master instance
+        auto_lock_t _lk(singleton_t::get_mutex());
+        if(!_master->m_timeline_writer)
+        {
+            auto _label = Type::get_label();
+            auto _fname = settings::compose_output_filename(
+                _label + std::string(".timeline"), ".tmt");
+            _master->m_timeline_writer = std::make_shared<timeline_wr_t>(
+                _fname, _label, settings::timeline_compress());
+        }
+        m_timeline_writer = _master->m_timeline_writer;
+    }
+
+    // labels are resolved by the recording thread because the hash maps are
+    // thread-local
+    m_timeline.reset(new timeline_t(settings::timeline_buffer(), m_thread_idx,
+                                    settings::timeline_flush(), m_timeline_writer,
+                                    [this](uint64_t _id) { return get_prefix(_id); }));
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::timeline_finalize()
+{
+    if(m_timeline)
+        m_timeline->flush();
+
+    if(!m_is_master || !m_timeline_writer)
+        return;
+
+    auto _fname =
+        m_timeline_writer->close([&](uint64_t _id) { return get_prefix(_id); });
+    if(!_fname.empty())
+    {
+        printf("[%s]|%i> Outputting '%s'...\n", Type::get_label().c_str(),
+               (int) dmp::rank(), _fname.c_str());
+        manager::instance()->add_file_output("tmt", Type::get_label(), _fname);
+    }
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+bool
+storage<Type, true>::trace_init()
+{
+    if(m_trace)
+        return true;
+
+    if(!settings::trace_output() || is_finalizing())
+        return false;
+
+    auto _master = singleton_t::master_instance();
+    if(!_master)
+        _master = this;
+
+    {
+        // all the threads share the writer of the master instance
+        auto_lock_t _lk(singleton_t::get_mutex());
+        if(!_master->m_trace_writer)
+        {
+            auto _label = Type::get_label();
+            auto _fname = settings::compose_output_filename(
+                _label + std::string(".trace"), ".json");
+            _master->m_trace_writer = std::make_shared<trace_wr_t>(
+                _fname, _label, process::get_id(), dmp::rank());
+        }
+        m_trace_writer = _master->m_trace_writer;
+    }
+
+    // always stream the full buffers so that no events are lost
+    m_trace.reset(new timeline_t(settings::trace_buffer(), m_thread_idx, true,
+                                 m_trace_writer,
+                                 [this](uint64_t _id) { return get_prefix(_id); }));
+    return true;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::trace_finalize()
+{
+    if(m_trace)
+        m_trace->flush();
+
+    if(!m_is_master || !m_trace_writer)
+        return;
+
+    auto _fname = m_trace_writer->close([&](uint64_t _id) { return get_prefix(_id); });
+    if(!_fname.empty())
+    {
+        printf("[%s]|%i> Outputting '%s'...\n", Type::get_label().c_str(),
+               (int) dmp::rank(), _fname.c_str());
+        manager::instance()->add_file_output("trace", Type::get_label(), _fname);
+    }
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::write_snapshot()
+{
+    m_snapshot_generation = snapshot_clock::generation();
+    m_snapshot_request    = 0;
+
+    if(is_finalizing() || !m_graph_data_instance)
+        return;
+
+    if(!m_snapshot_writer)
+    {
+        auto _master = singleton_t::master_instance();
+        if(!_master)
+            _master = this;
+
+        // all the threads share the writer of the master instance
+        auto_lock_t _lk(singleton_t::get_mutex());
+        if(!_master->m_snapshot_writer)
+        {
+            auto _fname = settings::compose_output_filename(
+                Type::get_label() + std::string(".snapshot"), ".jsonl");
+            _master->m_snapshot_writer = std::make_shared<snapshot_writer>(_fname);
+        }
+        m_snapshot_writer = _master->m_snapshot_writer;
+    }
+
+    if(!m_snapshot)
+        m_snapshot.reset(new snapshot_t{});
+
+    // other threads merge into the graph of the master instance when they exit
+    auto_lock_t _lk(singleton_t::get_mutex(), std::defer_lock);
+    if(m_is_master)
+        _lk.lock();
+    auto _delta = m_snapshot->difference(get());
+    if(_lk.owns_lock())
+        _lk.unlock();
+
+    if(_delta.empty())
+        return;
+
+    using archive_type = cereal::MinimalJSONOutputArchive;
+    using policy_type  = policy::output_archive<archive_type, TIMEMORY_API>;
+    using clock_type   = std::chrono::system_clock;
+
+    auto _now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock_type::now().time_since_epoch())
+                    .count();
+
+    // serialized by the thread of the writer, one line per snapshot
+    auto _count = m_snapshot->count();
+    auto _rank  = m_node_rank;
+    auto _tid   = m_thread_idx;
+    m_snapshot_writer->push([_delta = std::move(_delta), _count, _now, _rank, _tid]() {
+        std::stringstream ss;
+        {
+            auto oa = policy_type::get(ss);
+            oa->setNextName("timemory");
+            oa->startNode();
+            (*oa)(cereal::make_nvp("snapshot", _count),
+                  cereal::make_nvp("timestamp", _now), cereal::make_nvp("rank", _rank),
+                  cereal::make_nvp("pid", process::get_id()),
+                  cereal::make_nvp("tid", _tid),
+                  cereal::make_nvp("type", Type::get_label()));
+            save(*oa, _delta);
+            oa->finishNode();
+        }
+        return ss.str();
+    });
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::write_export()
+{
+    m_export_epoch = metrics_server::epoch();
+
+    if(is_finalizing() || !m_graph_data_instance)
+        return;
+
+    static bool _selected = metrics_server::instance().is_selected(Type::get_label());
+    if(!_selected)
+        return;
+
+    if(!m_export_slot)
+    {
+        m_export_slot = std::make_shared<export_slot>(Type::get_label(), m_thread_idx);
+        metrics_server::instance().add(m_export_slot);
+    }
+
+    // other threads merge into the graph of the master instance when they exit
+    auto_lock_t _lk(singleton_t::get_mutex(), std::defer_lock);
+    if(m_is_master)
+        _lk.lock();
+    auto _data = std::make_shared<const result_array_t>(get());
+    if(_lk.owns_lock())
+        _lk.unlock();
+
+    using json_archive_t   = cereal::MinimalJSONOutputArchive;
+    using binary_archive_t = cereal::StreamingBinaryOutputArchive;
+    using json_policy_t    = policy::output_archive<json_archive_t, TIMEMORY_API>;
+    using binary_policy_t  = policy::output_archive<binary_archive_t, TIMEMORY_API>;
+
+    // serialized by the server thread when it is requested
+    auto _epoch = m_export_epoch;
+    auto _rank  = m_node_rank;
+    auto _tid   = m_thread_idx;
+    m_export_slot->publish(_epoch, [_data, _epoch, _rank, _tid](bool _binary) {
+        std::stringstream _ss{};
+        if(_binary)
+        {
+            // the final block of the streaming archive is written during destruction
+            auto oa = binary_policy_t::get(_ss);
+            (*oa)(cereal::make_nvp("type", Type::get_label()),
+                  cereal::make_nvp("epoch", _epoch), cereal::make_nvp("rank", _rank),
+                  cereal::make_nvp("tid", _tid));
+            save(*oa, *_data);
+        }
+        else
+        {
+            auto oa = json_policy_t::get(_ss);
+            (*oa)(cereal::make_nvp("type", Type::get_label()),
+                  cereal::make_nvp("epoch", _epoch), cereal::make_nvp("rank", _rank),
+                  cereal::make_nvp("tid", _tid));
+            save(*oa, *_data);
+        }
+        return _ss.str();
+    });
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
+void
+storage<Type, true>::snapshot_finalize()
+{
+    if(!m_is_master || !m_snapshot_writer)
+        return;
+
+    m_snapshot_writer->wait();
+    if(m_snapshot_writer->size() == 0)
+        return;
+
+    auto _fname = m_snapshot_writer->get_filename();
+    printf("[%s]|%i> Outputting '%s'...\n", Type::get_label().c_str(), (int) dmp::rank(),
+           _fname.c_str());
+    manager::instance()->add_file_output("jsonl", Type::get_label(), _fname);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename Type>
 void
 storage<Type, true>::stack_pop(Type* obj)
 {
+    if(m_trace)
+        m_trace->stop(obj);
+
     auto itr = m_stack.find(obj);
     if(itr != m_stack.end())
         m_stack.erase(itr);
+
+    // the clock only flags the next snapshot. It is taken once no component of this
+    // type is running on the thread so that reading the graph is not included in a
+    // measurement, or one interval later if the thread never leaves its outer region
+    auto _generation = snapshot_clock::generation();
+    if(_generation != m_snapshot_generation)
+    {
+        if(m_snapshot_request == 0)
+            m_snapshot_request = _generation;
+        if(m_stack.empty() || _generation > m_snapshot_request + 1)
+            write_snapshot();
+    }
+    // popped in every mode (unlike the graph) so flat storage publishes too
+    if(m_export_epoch != metrics_server::epoch())
+        write_export();
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -620,12 +982,20 @@ storage<Type, true>::merge()
     if(!m_is_master || !m_initialized)
         return;
 
+    // call-graphs handed off by the worker threads have already been combined
+    if(m_merger)
+    {
+        auto _staged = m_merger->release();
+        if(_staged)
+            operation::finalize::merge<Type, true>(*this, *_staged);
+    }
+
     auto m_children = singleton_t::children();
     if(m_children.size() == 0)
         return;
 
-    for(auto& itr : m_children)
-        merge(itr);
+    std::vector<this_type*> _children(m_children.begin(), m_children.end());
+    operation::finalize::merge<Type, true>(*this, _children);
 
     // create lock
     auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
@@ -645,8 +1015,24 @@ template <typename Type>
 void
 storage<Type, true>::merge(this_type* itr)
 {
-    if(itr)
+    if(!itr)
+        return;
+
+    if(settings::snapshot_interval() > 0 && !is_finalizing())
+    {
+        // the snapshots of itr report its data (including a thread which never took a
+        // snapshot) so the previous snapshot of this instance absorbs the merged data
+        auto_lock_t _lk(singleton_t::get_mutex());
+        itr->write_snapshot();
+        write_snapshot();
         operation::finalize::merge<Type, true>(*this, *itr);
+        if(m_snapshot)
+            m_snapshot->rebase(get());
+    }
+    else
+    {
+        operation::finalize::merge<Type, true>(*this, *itr);
+    }
 }
 //
 //--------------------------------------------------------------------------------------//
@@ -706,6 +1092,9 @@ storage<Type, true>::internal_print()
 
     if(!singleton_t::is_master(this))
     {
+        timeline_finalize();
+        trace_finalize();
+        snapshot_finalize();
         singleton_t::master_instance()->merge(this);
         finalize();
     }
@@ -713,6 +1102,9 @@ storage<Type, true>::internal_print()
     {
         merge();
         finalize();
+        timeline_finalize();
+        trace_finalize();
+        snapshot_finalize();
 
         if(!trait::runtime_enabled<Type>::get())
         {
@@ -740,7 +1132,19 @@ storage<Type, true>::internal_print()
         if(m_manager)
             m_manager->add_entries(this->size());
 
-        m_printer->execute();
+        if(m_manager && m_manager->is_finalizing() && settings::output_threads() != 1)
+        {
+            // the formatting and writing is deferred to the manager so that the output
+            // of all the components is generated concurrently
+            auto _printer = m_printer;
+            if(_printer->prepare())
+                m_manager->add_output([_printer]() { _printer->write_output(); },
+                                      [_printer]() { _printer->finish_output(); });
+        }
+        else
+        {
+            m_printer->execute();
+        }
 
         instance_count().store(0);
     }
@@ -748,6 +1152,9 @@ storage<Type, true>::internal_print()
     {
         if(singleton_t::is_master(this))
         {
+            timeline_finalize();
+            trace_finalize();
+            snapshot_finalize();
             instance_count().store(0);
         }
     }
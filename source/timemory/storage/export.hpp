@@ -0,0 +1,534 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/** \headerfile "timemory/storage/export.hpp"
+ * \brief Background thread which serves the current call-graphs of the storage
+ * instances over a Unix domain socket without finalizing (see timemory-query)
+ *
+ */
+
+#pragma once
+
+//--------------------------------------------------------------------------------------//
+
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_UNIX)
+#    include <poll.h>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#    if !defined(MSG_NOSIGNAL)
+#        define MSG_NOSIGNAL 0
+#    endif
+#endif
+
+//--------------------------------------------------------------------------------------//
+//
+namespace tim
+{
+//--------------------------------------------------------------------------------------//
+/// \class tim::export_slot
+/// \brief The most recent call-graph of a storage instance published for the metrics
+/// server. Only the thread which owns the storage publishes to the slot so the graph is
+/// never read concurrently with measurements. The thread only publishes a copy of the
+/// data and the server serializes it when it is requested so the measured thread never
+/// pays for the serialization. The payloads are cached until the next publication.
+///
+class export_slot
+{
+public:
+    using lock_t       = std::unique_lock<std::mutex>;
+    using payload_t    = std::shared_ptr<const std::string>;
+    using serializer_t = std::function<std::string(bool)>;
+    using function_t   = std::shared_ptr<const serializer_t>;
+
+    export_slot(std::string _label, int64_t _tid)
+    : m_tid(_tid)
+    , m_label(std::move(_label))
+    {}
+
+    export_slot(const export_slot&) = delete;
+    export_slot(export_slot&&)      = delete;
+
+    export_slot& operator=(const export_slot&) = delete;
+    export_slot& operator=(export_slot&&) = delete;
+
+    /// replace the published data with the data at \param _epoch. \param _func
+    /// serializes the data (in the binary format when it is passed true)
+    inline void publish(uint64_t _epoch, serializer_t&& _func);
+
+    /// the payload in the format of \param _binary, serialized by the calling thread
+    /// on the first request after a publication
+    inline payload_t get(bool _binary);
+
+    uint64_t           epoch() const { return m_epoch.load(std::memory_order_acquire); }
+    int64_t            tid() const { return m_tid; }
+    const std::string& label() const { return m_label; }
+
+private:
+    std::atomic<uint64_t> m_epoch{ 0 };
+    int64_t               m_tid   = 0;
+    std::string           m_label = {};
+    mutable std::mutex    m_mutex;
+    payload_t             m_json   = {};
+    payload_t             m_binary = {};
+    function_t            m_func   = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::metrics_server
+/// \brief Serves the call-graphs published to the export slots over a Unix domain
+/// socket. A client connects and sends a single line request:
+///
+///     json   [<LABEL> ...]
+///     binary [<LABEL> ...]
+///     list
+///
+/// and the response is written until the connection is closed. Every storage instance
+/// registers a slot when it is initialized while the server is running. A request for
+/// data advances the epoch, which storage instances compare when they pop a node, and
+/// waits (up to the timeout) for the selected slots to publish. Slots whose thread does
+/// not pop before the timeout are served with the data of their previous publication
+/// (if any).
+/// The binary response is the 8-character "TIMEMORY" magic, the number of payloads and
+/// then the size and bytes of each payload (all integers are native 64-bit).
+///
+class metrics_server
+{
+public:
+    using lock_t      = std::unique_lock<std::mutex>;
+    using slot_ptr_t  = std::shared_ptr<export_slot>;
+    using slot_list_t = std::vector<std::weak_ptr<export_slot>>;
+    using strset_t    = std::set<std::string>;
+    using duration_t  = std::chrono::milliseconds;
+
+    static metrics_server& instance()
+    {
+        static metrics_server _instance{};
+        return _instance;
+    }
+
+    /// the epoch is zero until data is requested
+    static uint64_t epoch() { return f_epoch().load(std::memory_order_relaxed); }
+
+    metrics_server() = default;
+    ~metrics_server() { stop(); }
+
+    metrics_server(const metrics_server&) = delete;
+    metrics_server(metrics_server&&)      = delete;
+
+    metrics_server& operator=(const metrics_server&) = delete;
+    metrics_server& operator=(metrics_server&&) = delete;
+
+    /// serve the components in the comma/space-delimited \param _components (empty =
+    /// all) on the socket at \param _path. Does nothing if the server is running or the
+    /// path is empty
+    inline bool start(std::string _path, const std::string& _components = {});
+    inline void stop();
+
+    bool is_running() const { return m_running.load(); }
+
+    /// whether the storage of \param _label should publish to a slot
+    bool is_selected(const std::string& _label) const
+    {
+        lock_t _lk(m_mutex);
+        return m_components.empty() || m_components.count(_label) > 0;
+    }
+
+    const std::string& get_path() const { return m_path; }
+
+    void set_timeout(duration_t _v) { m_timeout = _v; }
+
+    void add(const slot_ptr_t& _slot)
+    {
+        lock_t _lk(m_mutex);
+        m_slots.emplace_back(_slot);
+    }
+
+    void notify()
+    {
+        // synchronize with a request which is checking the slots before it waits
+        { lock_t _lk(m_mutex); }
+        m_cv.notify_all();
+    }
+
+private:
+    static std::atomic<uint64_t>& f_epoch()
+    {
+        static std::atomic<uint64_t> _instance{ 0 };
+        return _instance;
+    }
+
+    inline void                    run(int _fd);
+    inline void                    serve(int _fd);
+    inline std::vector<slot_ptr_t> collect(const strset_t& _labels);
+    inline static bool             send_all(int _fd, const void* _data, size_t _n);
+
+private:
+    std::atomic<bool>       m_stop{ false };
+    std::atomic<bool>       m_running{ false };
+    duration_t              m_timeout = duration_t{ 250 };
+    std::string             m_path    = {};
+    strset_t                m_components;
+    slot_list_t             m_slots;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cv;
+    std::thread             m_thread;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+void
+export_slot::publish(uint64_t _epoch, serializer_t&& _func)
+{
+    {
+        lock_t _lk(m_mutex);
+        m_func   = std::make_shared<const serializer_t>(std::move(_func));
+        m_json   = payload_t{};
+        m_binary = payload_t{};
+        m_epoch.store(_epoch, std::memory_order_release);
+    }
+    metrics_server::instance().notify();
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+export_slot::payload_t
+export_slot::get(bool _binary)
+{
+    lock_t _lk(m_mutex);
+    auto&  _payload = (_binary) ? m_binary : m_json;
+    if(_payload || !m_func)
+        return _payload;
+
+    // the owning thread may publish again while the data is serialized
+    auto _func = m_func;
+    _lk.unlock();
+    auto _data = std::make_shared<const std::string>((*_func)(_binary));
+    _lk.lock();
+    if(_func == m_func)
+        _payload = _data;
+    return _data;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+bool
+metrics_server::start(std::string _path, const std::string& _components)
+{
+#if defined(_UNIX)
+    if(_path.empty())
+        return false;
+
+    lock_t _lk(m_mutex);
+    if(m_thread.joinable())
+        return true;
+
+    auto _pos = _path.find("%p");
+    if(_pos != std::string::npos)
+        _path.replace(_pos, 2, std::to_string(getpid()));
+
+    sockaddr_un _addr{};
+    _addr.sun_family = AF_UNIX;
+    if(_path.length() >= sizeof(_addr.sun_path))
+    {
+        fprintf(stderr, "[metrics_server]> socket path is too long: '%s'\n",
+                _path.c_str());
+        return false;
+    }
+    strncpy(_addr.sun_path, _path.c_str(), sizeof(_addr.sun_path) - 1);
+
+    // remove a stale socket left by a previous process but never anything else
+    struct stat _st;
+    if(lstat(_path.c_str(), &_st) == 0)
+    {
+        if(!S_ISSOCK(_st.st_mode))
+        {
+            fprintf(stderr, "[metrics_server]> '%s' exists and is not a socket\n",
+                    _path.c_str());
+            return false;
+        }
+        unlink(_path.c_str());
+    }
+
+    int _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(_fd < 0)
+        return false;
+
+    if(bind(_fd, reinterpret_cast<sockaddr*>(&_addr), sizeof(_addr)) != 0 ||
+       listen(_fd, 8) != 0)
+    {
+        fprintf(stderr, "[metrics_server]> unable to listen on '%s': %s\n",
+                _path.c_str(), strerror(errno));
+        close(_fd);
+        return false;
+    }
+
+    auto _delim = _components;
+    std::replace(_delim.begin(), _delim.end(), ',', ' ');
+    std::stringstream _ss(_delim);
+    std::string       _label;
+    while(_ss >> _label)
+        m_components.insert(_label);
+
+    m_path = _path;
+    m_stop.store(false);
+    m_running.store(true);
+    m_thread = std::thread(&metrics_server::run, this, _fd);
+    return true;
+#else
+    consume_parameters(_path, _components);
+    return false;
+#endif
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+void
+metrics_server::stop()
+{
+    std::thread _thread{};
+    {
+        lock_t _lk(m_mutex);
+        m_stop.store(true);
+        std::swap(_thread, m_thread);
+    }
+    m_cv.notify_all();
+    if(_thread.joinable())
+    {
+        _thread.join();
+#if defined(_UNIX)
+        unlink(m_path.c_str());
+#endif
+    }
+    m_running.store(false);
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+void
+metrics_server::run(int _fd)
+{
+#if defined(_UNIX)
+    // poll with a timeout so that stop() does not have to interrupt accept()
+    pollfd _pfd{};
+    _pfd.fd     = _fd;
+    _pfd.events = POLLIN;
+    while(!m_stop.load())
+    {
+        if(poll(&_pfd, 1, 100) <= 0 || (_pfd.revents & POLLIN) == 0)
+            continue;
+        int _client = accept(_fd, nullptr, nullptr);
+        if(_client < 0)
+            continue;
+        serve(_client);
+        close(_client);
+    }
+    close(_fd);
+#else
+    consume_parameters(_fd);
+#endif
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+void
+metrics_server::serve(int _fd)
+{
+#if defined(_UNIX)
+    // a client which never completes the request does not block the server
+    timeval _tv{};
+    _tv.tv_sec = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &_tv, sizeof(_tv));
+#    if defined(SO_NOSIGPIPE)
+    int _nosigpipe = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_NOSIGPIPE, &_nosigpipe, sizeof(_nosigpipe));
+#    endif
+
+    std::string _request{};
+    char        _buff[256];
+    while(_request.find('\n') == std::string::npos && _request.length() < 4096)
+    {
+        auto _n = recv(_fd, _buff, sizeof(_buff), 0);
+        if(_n < 0 && errno == EINTR)
+            continue;
+        if(_n <= 0)
+            break;
+        _request.append(_buff, static_cast<size_t>(_n));
+    }
+
+    std::stringstream _ss(_request.substr(0, _request.find('\n')));
+    std::string       _format{};
+    std::string       _label{};
+    strset_t          _labels{};
+    _ss >> _format;
+    while(_ss >> _label)
+        _labels.insert(_label);
+
+    if(_format == "list")
+    {
+        strset_t _avail{};
+        for(const auto& itr : collect(_labels))
+            _avail.insert(itr->label());
+        std::string _msg{};
+        for(const auto& itr : _avail)
+            _msg += itr + "\n";
+        send_all(_fd, _msg.data(), _msg.length());
+        return;
+    }
+
+    if(_format != "json" && _format != "binary")
+    {
+        std::string _msg = "error: unknown request '" + _format +
+                           "' (expected 'json', 'binary', or 'list')\n";
+        send_all(_fd, _msg.data(), _msg.length());
+        return;
+    }
+
+    // flag every storage to publish when it next pops and wait for the selected ones
+    auto _epoch = f_epoch().fetch_add(1, std::memory_order_relaxed) + 1;
+    auto _slots = collect(_labels);
+    {
+        lock_t _lk(m_mutex);
+        m_cv.wait_for(_lk, m_timeout, [&]() {
+            return m_stop.load() ||
+                   std::all_of(_slots.begin(), _slots.end(),
+                               [_epoch](const slot_ptr_t& itr) {
+                                   return itr->epoch() >= _epoch;
+                               });
+        });
+    }
+
+    bool                                _binary = (_format == "binary");
+    std::vector<export_slot::payload_t> _data{};
+    for(const auto& itr : _slots)
+    {
+        auto _payload = itr->get(_binary);
+        if(_payload)
+            _data.emplace_back(std::move(_payload));
+    }
+
+    if(_binary)
+    {
+        uint64_t _count = _data.size();
+        if(!send_all(_fd, "TIMEMORY", 8) || !send_all(_fd, &_count, sizeof(_count)))
+            return;
+        for(const auto& itr : _data)
+        {
+            uint64_t _size = itr->length();
+            if(!send_all(_fd, &_size, sizeof(_size)) ||
+               !send_all(_fd, itr->data(), itr->length()))
+                return;
+        }
+    }
+    else
+    {
+        std::stringstream _header{};
+        _header << "{\"timemory\":{\"pid\":" << getpid() << ",\"epoch\":" << _epoch
+                << ",\"storage\":[";
+        std::string _msg = _header.str();
+        for(size_t i = 0; i < _data.size(); ++i)
+        {
+            if(i > 0)
+                _msg += ",";
+            _msg += *_data.at(i);
+        }
+        _msg += "]}}\n";
+        send_all(_fd, _msg.data(), _msg.length());
+    }
+#else
+    consume_parameters(_fd);
+#endif
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+std::vector<metrics_server::slot_ptr_t>
+metrics_server::collect(const strset_t& _labels)
+{
+    std::vector<slot_ptr_t> _slots{};
+    lock_t                  _lk(m_mutex);
+    // slots expire when the storage of a thread is destroyed after it merged
+    auto _end = std::remove_if(m_slots.begin(), m_slots.end(),
+                               [](const std::weak_ptr<export_slot>& itr) {
+                                   return itr.expired();
+                               });
+    m_slots.erase(_end, m_slots.end());
+    for(const auto& itr : m_slots)
+    {
+        auto _slot = itr.lock();
+        if(_slot && (_labels.empty() || _labels.count(_slot->label()) > 0))
+            _slots.emplace_back(std::move(_slot));
+    }
+    return _slots;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+bool
+metrics_server::send_all(int _fd, const void* _data, size_t _n)
+{
+#if defined(_UNIX)
+    const char* _ptr = static_cast<const char*>(_data);
+    while(_n > 0)
+    {
+        // the client may disconnect at any time and SIGPIPE would terminate the process
+        auto _ret = send(_fd, _ptr, _n, MSG_NOSIGNAL);
+        if(_ret < 0 && errno == EINTR)
+            continue;
+        if(_ret <= 0)
+            return false;
+        _ptr += _ret;
+        _n -= static_cast<size_t>(_ret);
+    }
+    return true;
+#else
+    consume_parameters(_fd, _data, _n);
+    return false;
+#endif
+}
+}  // namespace tim
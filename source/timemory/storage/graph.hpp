@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <deque>
@@ -323,6 +324,236 @@ private:
     mutable voidvec_t              m_allocations    = {};
 };
 
+//======================================================================================//
+//  graph allocator which hands out nodes from large contiguous chunks (an arena).
+//  Freed nodes are recycled through an intrusive free-list and the chunks are only
+//  released en bloc when the last allocator referencing the arena is destroyed.
+//  Copies of the allocator share the arena so nodes can be spliced between graphs
+//  which were constructed from the same allocator. Like the graph itself, the arena
+//  is not thread-safe and is intended to be owned by a single (thread-local) storage.
+//
+template <typename Tp>
+class graph_arena_allocator
+{
+public:
+    using value_type      = Tp;
+    using pointer         = Tp*;
+    using reference       = Tp&;
+    using const_pointer   = const Tp*;
+    using const_reference = const Tp&;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef graph_arena_allocator<U> other;
+    };
+
+    /// number of nodes in each chunk when not specified
+    static size_t default_chunk_size()
+    {
+        return std::max<size_t>(64, (16 * units::get_page_size()) / sizeof(slot_type));
+    }
+
+private:
+    union slot_type
+    {
+        slot_type* next;
+        alignas(Tp) char data[sizeof(Tp)];
+    };
+
+    struct arena
+    {
+        explicit arena(size_t _chunk_size)
+        : chunk_size(std::max<size_t>(_chunk_size, 1))
+        {}
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        Tp* allocate()
+        {
+            if(free_list)
+            {
+                auto* _slot = free_list;
+                free_list   = _slot->next;
+                ++live;
+                return reinterpret_cast<Tp*>(_slot->data);
+            }
+            if(chunks.empty() || chunk_offset == chunk_size)
+            {
+                chunks.emplace_back(new slot_type[chunk_size]);
+                chunk_offset = 0;
+            }
+            ++live;
+            return reinterpret_cast<Tp*>(chunks.back()[chunk_offset++].data);
+        }
+
+        void deallocate(Tp* ptr)
+        {
+            auto* _slot = reinterpret_cast<slot_type*>(ptr);
+            _slot->next = free_list;
+            free_list   = _slot;
+            --live;
+        }
+
+        // releases the chunks in which every slot is free and removes their slots
+        // from the free-list
+        void trim()
+        {
+            if(chunks.empty())
+                return;
+
+            using chunk_index_t = std::pair<const slot_type*, size_t>;
+            std::vector<chunk_index_t> _index{};
+            _index.reserve(chunks.size());
+            for(size_t i = 0; i < chunks.size(); ++i)
+                _index.emplace_back(chunks[i].get(), i);
+            std::less<const slot_type*> _less{};
+            std::sort(_index.begin(), _index.end(),
+                      [&](const chunk_index_t& _lhs, const chunk_index_t& _rhs) {
+                          return _less(_lhs.first, _rhs.first);
+                      });
+
+            auto _chunk_of = [&](const slot_type* _slot) {
+                auto itr = std::upper_bound(
+                    _index.begin(), _index.end(), _slot,
+                    [&](const slot_type* _lhs, const chunk_index_t& _rhs) {
+                        return _less(_lhs, _rhs.first);
+                    });
+                return std::prev(itr)->second;
+            };
+
+            // the slots of the last chunk past the offset were never handed out
+            std::vector<size_t> _nfree(chunks.size(), 0);
+            _nfree.back() = chunk_size - chunk_offset;
+            for(auto* itr = free_list; itr; itr = itr->next)
+                ++_nfree.at(_chunk_of(itr));
+
+            std::vector<bool> _release(chunks.size(), false);
+            bool              _any = false;
+            for(size_t i = 0; i < chunks.size(); ++i)
+                _any |= (_release.at(i) = (_nfree.at(i) == chunk_size));
+            if(!_any)
+                return;
+
+            slot_type*  _free_list = nullptr;
+            slot_type** _tail      = &_free_list;
+            for(auto* itr = free_list; itr; itr = itr->next)
+            {
+                if(_release.at(_chunk_of(itr)))
+                    continue;
+                *_tail = itr;
+                _tail  = &itr->next;
+            }
+            *_tail    = nullptr;
+            free_list = _free_list;
+
+            // the chunk which is handed out in order is gone so the next allocation
+            // which misses the free-list starts a new chunk
+            if(_release.back())
+                chunk_offset = chunk_size;
+
+            size_t _n = 0;
+            for(size_t i = 0; i < chunks.size(); ++i)
+            {
+                if(!_release.at(i))
+                    chunks.at(_n++) = std::move(chunks.at(i));
+            }
+            chunks.resize(_n);
+        }
+
+        size_t                                    chunk_size   = 0;
+        size_t                                    chunk_offset = 0;
+        size_t                                    live         = 0;
+        slot_type*                                free_list    = nullptr;
+        std::vector<std::unique_ptr<slot_type[]>> chunks       = {};
+    };
+
+    template <typename U>
+    friend class graph_arena_allocator;
+
+public:
+    explicit graph_arena_allocator(size_t _chunk_size = default_chunk_size())
+    : m_arena(std::make_shared<arena>(_chunk_size))
+    {}
+
+    graph_arena_allocator(const graph_arena_allocator&) = default;
+    graph_arena_allocator(graph_arena_allocator&&)      = default;
+    graph_arena_allocator& operator=(const graph_arena_allocator&) = default;
+    graph_arena_allocator& operator=(graph_arena_allocator&&) = default;
+
+    // rebinding creates a new arena since the slot size differs
+    template <typename U>
+    graph_arena_allocator(const graph_arena_allocator<U>& rhs)
+    : m_arena(std::make_shared<arena>(rhs.m_arena ? rhs.m_arena->chunk_size
+                                                  : default_chunk_size()))
+    {}
+
+    bool operator==(const graph_arena_allocator& rhs) const
+    {
+        return m_arena == rhs.m_arena;
+    }
+    bool operator!=(const graph_arena_allocator& rhs) const { return !(*this == rhs); }
+
+public:
+    Tp*       address(Tp& r) const { return &r; }
+    const Tp* address(const Tp& s) const { return &s; }
+
+    size_t max_size() const
+    {
+        return (static_cast<size_t>(0) - static_cast<size_t>(1)) / sizeof(Tp);
+    }
+
+    template <typename... ArgsT>
+    void construct(Tp* const p, ArgsT&&... args) const
+    {
+        ::new((void*) p) Tp(std::forward<ArgsT>(args)...);
+    }
+
+    void destroy(Tp* const p) const { p->~Tp(); }
+
+    Tp* allocate(const size_t n) const
+    {
+        if(n == 0)
+            return nullptr;
+        // the graph only ever allocates one node at a time
+        if(n > 1)
+            return static_cast<Tp*>(::operator new(n * sizeof(Tp)));
+        return m_arena->allocate();
+    }
+
+    Tp* allocate(const size_t n, const void* /* const hint */) const
+    {
+        return allocate(n);
+    }
+
+    void deallocate(Tp* const ptr, const size_t n) const
+    {
+        if(ptr == nullptr || n == 0)
+            return;
+        if(n > 1)
+            ::operator delete(ptr);
+        else
+            m_arena->deallocate(ptr);
+    }
+
+    /// release the chunks of the arena which no longer contain any nodes
+    void trim() const { m_arena->trim(); }
+
+    /// number of nodes currently allocated from the arena
+    size_t size() const { return m_arena->live; }
+    /// number of bytes reserved by the arena
+    size_t alloc_bytes() const
+    {
+        return m_arena->chunks.size() * m_arena->chunk_size * sizeof(slot_type);
+    }
+
+private:
+    std::shared_ptr<arena> m_arena;
+};
+
 //======================================================================================//
 
 template <typename T,
@@ -784,6 +1015,9 @@ public:
         // return m_alloc.alloc_bytes();
     }
 
+    /// the allocator used for the nodes of this graph
+    const AllocatorT& get_allocator() const { return m_alloc; }
+
 private:
     AllocatorT  m_alloc;
     inline void m_head_initialize();
@@ -831,12 +1065,13 @@ graph<T, AllocatorT>::graph(const T& x)
 
 template <typename T, typename AllocatorT>
 graph<T, AllocatorT>::graph(graph<T, AllocatorT>&& x)
+: m_alloc(x.m_alloc)
 {
     m_head_initialize();
     if(x.head->next_sibling != x.feet)
     {  // move graph if non-empty only
         head->next_sibling                 = x.head->next_sibling;
-        feet->prev_sibling                 = x.head->prev_sibling;
+        feet->prev_sibling                 = x.feet->prev_sibling;
         x.head->next_sibling->prev_sibling = head;
         x.feet->prev_sibling->next_sibling = feet;
         x.head->next_sibling               = x.feet;
@@ -907,10 +1142,17 @@ template <typename T, typename AllocatorT>
 graph<T, AllocatorT>&
 graph<T, AllocatorT>::operator=(graph<T, AllocatorT>&& x)
 {
-    if(this != &x)
+    if(this != &x && m_alloc != x.m_alloc)
+    {
+        // the nodes cannot be spliced when they were allocated from a different
+        // arena since that arena is released with the other graph
+        m_copy(x);
+        x.clear();
+    }
+    else if(this != &x)
     {
         head->next_sibling                 = x.head->next_sibling;
-        feet->prev_sibling                 = x.head->prev_sibling;
+        feet->prev_sibling                 = x.feet->prev_sibling;
         x.head->next_sibling->prev_sibling = head;
         x.feet->prev_sibling->next_sibling = feet;
         x.head->next_sibling               = x.feet;
@@ -976,10 +1218,14 @@ graph<T, AllocatorT>::erase_children(const iterator_base& it)
         return;
 
     graph_node* cur = it.node->first_child;
-
-    if(cur)
-        while(cur->next_sibling && cur->next_sibling != feet)
-            erase(pre_order_iterator(cur->next_sibling));
+    while(cur != nullptr && cur != feet)
+    {
+        graph_node* prev = cur;
+        cur              = cur->next_sibling;
+        erase_children(pre_order_iterator(prev));
+        m_alloc.destroy(prev);
+        m_alloc.deallocate(prev, 1);
+    }
 
     it.node->first_child = nullptr;
     it.node->last_child  = nullptr;
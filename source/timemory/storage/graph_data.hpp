@@ -38,29 +38,160 @@
 #include "timemory/storage/graph.hpp"
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 //--------------------------------------------------------------------------------------//
 //
 namespace tim
 {
+//--------------------------------------------------------------------------------------//
+//
+//  open-addressing table mapping (parent node, hash id) -> child iterator
+//
+//--------------------------------------------------------------------------------------//
+/// \class tim::graph_child_index
+/// \brief Flat, linearly-probed hash table which caches the child of a given parent
+/// node for a given hash id. Re-entering an existing call-path is a single probe
+/// instead of a per-depth map lookup followed by a scan of the children. The entries
+/// hold raw node pointers so the owner must call \ref clear whenever nodes are erased.
+///
+template <typename IterT>
+class graph_child_index
+{
+public:
+    using iterator  = IterT;
+    using size_type = size_t;
+
+    graph_child_index()  = default;
+    ~graph_child_index() = default;
+
+    graph_child_index(const graph_child_index&) = delete;
+    graph_child_index(graph_child_index&&)      = default;
+
+    graph_child_index& operator=(const graph_child_index&) = delete;
+    graph_child_index& operator=(graph_child_index&&) = default;
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_entries.size(); }
+    bool      empty() const { return m_size == 0; }
+
+    /// returns a null iterator if (parent, id) has not been cached
+    iterator find(const void* _parent, int64_t _id) const
+    {
+        if(m_size == 0 || _parent == nullptr)
+            return iterator{ nullptr };
+        const size_type _mask = m_entries.size() - 1;
+        for(size_type i = get_slot(_parent, _id) & _mask;; i = (i + 1) & _mask)
+        {
+            const auto& _entry = m_entries[i];
+            if(_entry.parent == nullptr)
+                return iterator{ nullptr };
+            if(_entry.parent == _parent && _entry.id == _id)
+                return _entry.child;
+        }
+    }
+
+    /// inserts or overwrites the cached child for (parent, id)
+    void insert(const void* _parent, int64_t _id, iterator _child)
+    {
+        if(_parent == nullptr)
+            return;
+        if(2 * (m_size + 1) > m_entries.size())
+            rehash((m_entries.empty()) ? min_capacity() : 2 * m_entries.size());
+        if(emplace(m_entries, _parent, _id, _child))
+            ++m_size;
+    }
+
+    void clear()
+    {
+        if(m_size == 0)
+            return;
+        std::fill(m_entries.begin(), m_entries.end(), entry_type{});
+        m_size = 0;
+    }
+
+private:
+    static constexpr size_type min_capacity() { return 64; }
+
+    struct entry_type
+    {
+        const void* parent = nullptr;
+        int64_t     id     = 0;
+        iterator    child  = iterator{ nullptr };
+    };
+
+    using entry_vector_t = std::vector<entry_type>;
+
+    static size_type get_slot(const void* _parent, int64_t _id)
+    {
+        // node addresses are at least 8-byte aligned so drop the low bits before
+        // mixing in the (already well-distributed) hash id
+        auto _val = (reinterpret_cast<uintptr_t>(_parent) >> 3) * 0x9E3779B97F4A7C15ULL;
+        _val ^= static_cast<uint64_t>(_id);
+        _val ^= (_val >> 32);
+        return static_cast<size_type>(_val);
+    }
+
+    static bool emplace(entry_vector_t& _entries, const void* _parent, int64_t _id,
+                        iterator _child)
+    {
+        const size_type _mask = _entries.size() - 1;
+        for(size_type i = get_slot(_parent, _id) & _mask;; i = (i + 1) & _mask)
+        {
+            auto& _entry = _entries[i];
+            if(_entry.parent == nullptr)
+            {
+                _entry = entry_type{ _parent, _id, _child };
+                return true;
+            }
+            if(_entry.parent == _parent && _entry.id == _id)
+            {
+                _entry.child = _child;
+                return false;
+            }
+        }
+    }
+
+    void rehash(size_type _capacity)
+    {
+        entry_vector_t _entries(_capacity);
+        for(const auto& itr : m_entries)
+        {
+            if(itr.parent != nullptr)
+                emplace(_entries, itr.parent, itr.id, itr.child);
+        }
+        std::swap(m_entries, _entries);
+    }
+
+private:
+    size_type      m_size    = 0;
+    entry_vector_t m_entries = {};
+};
+
 //--------------------------------------------------------------------------------------//
 //
 //  graph instance + current node + head node
 //
 //--------------------------------------------------------------------------------------//
 
-template <typename NodeT>
+template <typename NodeT, typename AllocatorT = std::allocator<tgraph_node<NodeT>>>
 class graph_data
 {
 public:
-    using this_type          = graph_data<NodeT>;
-    using graph_t            = tim::graph<NodeT>;
+    using this_type          = graph_data<NodeT, AllocatorT>;
+    using node_type          = NodeT;
+    using graph_t            = tim::graph<NodeT, AllocatorT>;
     using iterator           = typename graph_t::iterator;
     using const_iterator     = typename graph_t::const_iterator;
     using inverse_insert_t   = std::vector<std::pair<int64_t, iterator>>;
@@ -116,6 +247,8 @@ public:
         m_sea_level = 0;
         m_current   = nullptr;
         m_dummies.clear();
+        m_children.clear();
+        trim(m_graph.get_allocator(), 0);
     }
 
     inline void set_master(graph_data* _master)
@@ -148,6 +281,8 @@ public:
         m_graph.erase_children(m_head);
         m_depth   = 0;
         m_current = m_head;
+        m_children.clear();
+        trim(m_graph.get_allocator(), 0);
     }
 
     inline iterator pop_graph()
@@ -217,8 +352,106 @@ public:
         return m_graph.append_child(_itr, node);
     }
 
+    /// cached lookup of the child of \param _parent with the given id
+    inline iterator find_child(iterator _parent, int64_t _id) const
+    {
+        return m_children.find(_parent.node, _id);
+    }
+
+    /// caches \param _child under the node it was actually inserted below so a
+    /// lookup can never return a node from a different call-path
+    inline void cache_child(iterator _child)
+    {
+        if(!_child)
+            return;
+        auto _parent = graph_t::parent(_child);
+        if(_parent)
+            m_children.insert(_parent.node, _child->id(), _child);
+    }
+
     bool at_sea_level() const { return (m_depth == m_sea_level); }
 
+    graph_data* get_master() const { return m_master; }
+
+    /// grafts the subgraphs below each bookmark (dummy) of \param rhs onto the
+    /// equivalent bookmark of this graph (adding the bookmark if there is no match)
+    /// and clears \param rhs. Returns the number of subgraphs which were grafted.
+    inline int64_t combine(this_type& rhs)
+    {
+        return combine(rhs, [](NodeT&, const NodeT&) { return false; });
+    }
+
+    /// same as above but \param _reduce is invoked with the equivalent nodes of this
+    /// graph and \param rhs and returns whether it added the data of the latter to
+    /// the former. The children of combined nodes are combined recursively so this
+    /// graph does not grow with the number of graphs combined into it. Returns the
+    /// number of nodes which were combined plus the number of grafted subgraphs.
+    template <typename FuncT>
+    inline int64_t combine(this_type& rhs, FuncT&& _reduce)
+    {
+        if(&rhs == this || !m_has_head || !rhs.m_has_head)
+            return 0;
+
+        int64_t _n = 0;
+        for(const auto& ritr : rhs.m_dummies)
+        {
+            iterator _rhs = ritr.second;
+            if(!rhs.m_graph.is_valid(_rhs))
+                continue;
+
+            iterator _lhs   = nullptr;
+            auto     _range = m_dummies.equal_range(ritr.first);
+            for(auto litr = _range.first; litr != _range.second; ++litr)
+            {
+                if(*litr->second == *_rhs)
+                {
+                    _lhs = litr->second;
+                    break;
+                }
+            }
+
+            if(!_lhs)
+            {
+                _lhs = m_graph.insert_after(m_head, *_rhs);
+                m_dummies.insert({ ritr.first, _lhs });
+            }
+
+            _n += combine(_lhs, _rhs, _reduce);
+        }
+
+        rhs.clear();
+        return _n;
+    }
+
+private:
+    template <typename FuncT>
+    int64_t combine(iterator _lhs, iterator _rhs, FuncT& _reduce)
+    {
+        int64_t          _n      = 0;
+        sibling_iterator _this   = _lhs;
+        sibling_iterator _other  = _rhs;
+        auto             _lookup = std::unordered_map<uint64_t, iterator>{};
+        for(auto litr = _this.begin(); litr != _this.end(); ++litr)
+            _lookup.emplace(litr->id(), litr);
+
+        for(auto sitr = _other.begin(); sitr != _other.end(); ++sitr)
+        {
+            auto litr = _lookup.find(sitr->id());
+            if(litr != _lookup.end() && *litr->second == *sitr &&
+               _reduce(*litr->second, *sitr))
+            {
+                _n += combine(litr->second, sitr, _reduce) + 1;
+            }
+            else
+            {
+                m_graph.append_child(_lhs, pre_order_iterator(sitr));
+                ++_n;
+            }
+        }
+        return _n;
+    }
+
+public:
     inverse_insert_t get_inverse_insert() const
     {
         inverse_insert_t ret;
@@ -228,6 +461,18 @@ public:
         return ret;
     }
 
+private:
+    // return the memory of the erased nodes when the allocator is an arena
+    template <typename AllocT>
+    static auto trim(const AllocT& _alloc, int) -> decltype(_alloc.trim(), void())
+    {
+        _alloc.trim();
+    }
+
+    template <typename AllocT>
+    static void trim(const AllocT&, long)
+    {}
+
 private:
     bool                             m_has_head  = false;
     int64_t                          m_depth     = 0;
@@ -236,6 +481,104 @@ private:
     iterator                         m_current = nullptr;
     iterator                         m_head    = nullptr;
     graph_data*                      m_master  = nullptr;
-    std::multimap<int64_t, iterator> m_dummies = {};
+    std::multimap<int64_t, iterator> m_dummies  = {};
+    graph_child_index<iterator>      m_children = {};
+};
+
+//--------------------------------------------------------------------------------------//
+//
+//  background combination of graph_data instances
+//
+//--------------------------------------------------------------------------------------//
+/// \class tim::graph_data_merger
+/// \brief Worker threads push the call-graphs they have completed and a background
+/// thread (started on the first push) combines them into a single staged graph via
+/// graph_data::combine. \ref release joins the background thread and returns the
+/// staged graph so that finalization only has to merge one graph.
+///
+template <typename GraphDataT>
+class graph_data_merger
+{
+public:
+    using data_type     = GraphDataT;
+    using node_type     = typename data_type::node_type;
+    using pointer       = std::unique_ptr<data_type>;
+    using lock_t        = std::unique_lock<std::mutex>;
+    using reduce_func_t = std::function<bool(node_type&, const node_type&)>;
+
+    /// \param _reduce is passed to graph_data::combine when it is set
+    explicit graph_data_merger(reduce_func_t _reduce = {})
+    : m_reduce(std::move(_reduce))
+    {}
+
+    ~graph_data_merger() { release(); }
+
+    graph_data_merger(const graph_data_merger&) = delete;
+    graph_data_merger(graph_data_merger&&)      = delete;
+
+    graph_data_merger& operator=(const graph_data_merger&) = delete;
+    graph_data_merger& operator=(graph_data_merger&&) = delete;
+
+    void push(pointer&& _data)
+    {
+        if(!_data)
+            return;
+        lock_t _lk(m_mutex);
+        m_queue.emplace_back(std::move(_data));
+        if(!m_thread.joinable())
+        {
+            m_stop   = false;
+            m_thread = std::thread(&graph_data_merger::run, this);
+        }
+        _lk.unlock();
+        m_cv.notify_one();
+    }
+
+    pointer release()
+    {
+        {
+            lock_t _lk(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if(m_thread.joinable())
+            m_thread.join();
+        return std::move(m_staged);
+    }
+
+private:
+    void run()
+    {
+        lock_t _lk(m_mutex);
+        while(true)
+        {
+            m_cv.wait(_lk, [this]() { return m_stop || !m_queue.empty(); });
+            while(!m_queue.empty())
+            {
+                auto _data = std::move(m_queue.front());
+                m_queue.pop_front();
+                _lk.unlock();
+                if(!m_staged)
+                    m_staged = std::move(_data);
+                else if(m_reduce)
+                    m_staged->combine(*_data, m_reduce);
+                else
+                    m_staged->combine(*_data);
+                _data.reset();
+                _lk.lock();
+            }
+            if(m_stop)
+                break;
+        }
+    }
+
+private:
+    bool                    m_stop   = false;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::deque<pointer>     m_queue  = {};
+    pointer                 m_staged = {};
+    reduce_func_t           m_reduce = {};
+    std::thread             m_thread;
 };
 }  // namespace tim
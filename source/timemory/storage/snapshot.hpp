@@ -0,0 +1,330 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \headerfile "timemory/storage/snapshot.hpp"
+ * \brief Periodic snapshots of the call-graph of a storage instance: the clock which
+ * schedules them, the difference vs. the previous snapshot and the writer which
+ * appends them to the snapshot file
+ *
+ */
+
+#pragma once
+
+//--------------------------------------------------------------------------------------//
+
+#include "timemory/storage/node.hpp"
+#include "timemory/utility/types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//--------------------------------------------------------------------------------------//
+//
+namespace tim
+{
+//--------------------------------------------------------------------------------------//
+/// \class tim::snapshot_clock
+/// \brief Background thread which advances a process-wide generation once per
+/// interval. Storage instances compare the generation when a component is popped and
+/// take the snapshot at the next point where no component of the type is running on
+/// the thread, so the graph is only read by the thread which owns it and measurements
+/// never wait on the clock.
+///
+class snapshot_clock
+{
+public:
+    using lock_t = std::unique_lock<std::mutex>;
+
+    static snapshot_clock& instance()
+    {
+        static snapshot_clock _instance{};
+        return _instance;
+    }
+
+    /// the generation is zero until the clock is started
+    static uint64_t generation()
+    {
+        return f_generation().load(std::memory_order_relaxed);
+    }
+
+    snapshot_clock() = default;
+    ~snapshot_clock() { stop(); }
+
+    snapshot_clock(const snapshot_clock&) = delete;
+    snapshot_clock(snapshot_clock&&)      = delete;
+
+    snapshot_clock& operator=(const snapshot_clock&) = delete;
+    snapshot_clock& operator=(snapshot_clock&&) = delete;
+
+    /// start the clock with a period of \param _interval seconds. Does nothing if the
+    /// clock is running or the interval is not positive
+    void start(double _interval)
+    {
+        if(!(_interval > 0.0))
+            return;
+        lock_t _lk(m_mutex);
+        if(m_thread.joinable())
+            return;
+        m_stop   = false;
+        m_thread = std::thread(&snapshot_clock::run, this,
+                               std::chrono::duration<double>(_interval));
+    }
+
+    void stop()
+    {
+        std::thread _thread{};
+        {
+            lock_t _lk(m_mutex);
+            m_stop = true;
+            std::swap(_thread, m_thread);
+        }
+        m_cv.notify_one();
+        if(_thread.joinable())
+            _thread.join();
+    }
+
+private:
+    static std::atomic<uint64_t>& f_generation()
+    {
+        static std::atomic<uint64_t> _instance{ 0 };
+        return _instance;
+    }
+
+    void run(std::chrono::duration<double> _interval)
+    {
+        lock_t _lk(m_mutex);
+        while(!m_cv.wait_for(_lk, _interval, [this]() { return m_stop; }))
+            f_generation().fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    bool                    m_stop = false;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::thread             m_thread;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::snapshot_writer
+/// \brief Appends serialized snapshots to a file. Shared by all the threads of a
+/// component type: the threads only queue the difference of their graph and the
+/// serialization and the writing happen on the thread of the writer so that neither
+/// is done by a measured thread.
+///
+class snapshot_writer
+{
+public:
+    using lock_t    = std::unique_lock<std::mutex>;
+    using task_type = std::function<std::string()>;
+
+    snapshot_writer(std::string _fname)
+    : m_fname(std::move(_fname))
+    {}
+
+    ~snapshot_writer() { stop(); }
+
+    snapshot_writer(const snapshot_writer&) = delete;
+    snapshot_writer(snapshot_writer&&)      = delete;
+
+    snapshot_writer& operator=(const snapshot_writer&) = delete;
+    snapshot_writer& operator=(snapshot_writer&&) = delete;
+
+    /// queue \param _task which returns a serialized snapshot. The tasks are invoked
+    /// in order and each result is appended as one line. Once the writer is stopped
+    /// the task is invoked by the calling thread
+    void push(task_type _task)
+    {
+        lock_t _lk(m_mutex);
+        if(m_stop)
+        {
+            append(_task());
+            return;
+        }
+        m_queue.emplace_back(std::move(_task));
+        if(!m_thread.joinable())
+            m_thread = std::thread(&snapshot_writer::run, this);
+        _lk.unlock();
+        m_cv.notify_all();
+    }
+
+    /// block until the queued snapshots have been written
+    void wait()
+    {
+        lock_t _lk(m_mutex);
+        m_cv.wait(_lk, [this]() { return m_queue.empty() && !m_busy; });
+    }
+
+    /// write the queued snapshots and stop the thread of the writer
+    void stop()
+    {
+        std::thread _thread{};
+        {
+            lock_t _lk(m_mutex);
+            m_stop = true;
+            std::swap(_thread, m_thread);
+        }
+        m_cv.notify_all();
+        if(_thread.joinable())
+            _thread.join();
+    }
+
+    const std::string& get_filename() const { return m_fname; }
+
+    /// the number of snapshots which have been written
+    uint64_t size() const
+    {
+        lock_t _lk(m_mutex);
+        return m_count;
+    }
+
+private:
+    void run()
+    {
+        lock_t _lk(m_mutex);
+        while(true)
+        {
+            m_cv.wait(_lk, [this]() { return m_stop || !m_queue.empty(); });
+            if(m_queue.empty())
+                break;
+            auto _task = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            _lk.unlock();
+            auto _data = _task();
+            _lk.lock();
+            append(_data);
+            m_busy = false;
+            m_cv.notify_all();
+        }
+    }
+
+    // append \param _data followed by a newline. Must be called with the lock held
+    bool append(const std::string& _data)
+    {
+        if(!m_ofs.is_open())
+        {
+            m_ofs.open(m_fname.c_str());
+            if(!m_ofs)
+                return false;
+        }
+        m_ofs << _data << '\n' << std::flush;
+        ++m_count;
+        return static_cast<bool>(m_ofs);
+    }
+
+private:
+    bool                    m_stop  = false;
+    bool                    m_busy  = false;
+    uint64_t                m_count = 0;
+    std::string             m_fname = {};
+    std::deque<task_type>   m_queue = {};
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cv;
+    std::thread             m_thread;
+    std::ofstream           m_ofs;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::graph_snapshot
+/// \brief Retains the results of the previous snapshot of a graph and computes the
+/// difference of the current results vs. them. Nodes which were not invoked since the
+/// previous snapshot are omitted from the difference.
+///
+template <typename Tp>
+class graph_snapshot
+{
+public:
+    using result_node    = node::result<Tp>;
+    using result_array_t = std::vector<result_node>;
+    using base_type      = typename Tp::base_type;
+
+    /// returns \param _current minus the previous results and retains \param _current
+    result_array_t difference(const result_array_t& _current)
+    {
+        result_array_t _delta{};
+        _delta.reserve(_current.size());
+        for(const auto& itr : _current)
+        {
+            const auto* _prev = find(itr);
+            if(_prev && _prev->data().get_laps() == itr.data().get_laps())
+                continue;
+            _delta.emplace_back(itr);
+            if(_prev)
+            {
+                _delta.back() -= *_prev;
+                // the arithmetic operators of the components do not modify the laps
+                static_cast<base_type&>(_delta.back().data())
+                    .minus(crtp::base{}, _prev->data());
+            }
+        }
+        rebase(_current);
+        ++m_count;
+        return _delta;
+    }
+
+    /// retain \param _current as the previous results without computing a difference
+    void rebase(const result_array_t& _current)
+    {
+        m_previous = _current;
+        m_index.clear();
+        m_index.reserve(m_previous.size());
+        for(size_t i = 0; i < m_previous.size(); ++i)
+            m_index.emplace(m_previous.at(i).rolling_hash(), i);
+    }
+
+    /// number of differences computed
+    uint64_t count() const { return m_count; }
+
+private:
+    const result_node* find(const result_node& _node) const
+    {
+        auto _range = m_index.equal_range(_node.rolling_hash());
+        for(auto itr = _range.first; itr != _range.second; ++itr)
+        {
+            const auto& _prev = m_previous.at(itr->second);
+            if(_prev == _node)
+                return &_prev;
+        }
+        return nullptr;
+    }
+
+private:
+    uint64_t                                  m_count    = 0;
+    result_array_t                            m_previous = {};
+    std::unordered_multimap<uint64_t, size_t> m_index    = {};
+};
+}  // namespace tim
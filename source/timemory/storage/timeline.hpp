@@ -0,0 +1,681 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \headerfile "timemory/storage/timeline.hpp"
+ * \brief Fixed-size timeline event records, the per-thread ring buffers they are
+ * recorded into and the background writers which stream them to disk (compact
+ * binary timeline or Chrome trace event JSON)
+ *
+ */
+
+#pragma once
+
+//--------------------------------------------------------------------------------------//
+
+#include "timemory/utility/types.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//--------------------------------------------------------------------------------------//
+//
+namespace tim
+{
+namespace node
+{
+//--------------------------------------------------------------------------------------//
+/// \struct tim::node::event
+/// \brief A single timeline entry: the (non-unique) hash of the label, the wall-clock
+/// start and stop in nanoseconds since the epoch, the thread and the value of the
+/// component after it was stopped
+///
+template <typename Tp>
+struct event
+{
+    using value_type = typename Tp::value_type;
+
+    uint64_t   hash  = 0;
+    int64_t    start = 0;
+    int64_t    stop  = 0;
+    uint32_t   tid   = 0;
+    value_type value = {};
+};
+}  // namespace node
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::event_writer
+/// \brief Receives blocks of events from the per-thread buffers and writes them to a
+/// file from a background thread (started on the first push). Each block carries the
+/// labels of the hashes which the thread had not reported yet because the hash maps
+/// are thread-local. The format is implemented by the derived classes, which must call
+/// \ref close in their destructor.
+///
+template <typename Tp>
+class event_writer
+{
+public:
+    using event_type    = node::event<Tp>;
+    using value_type    = typename event_type::value_type;
+    using event_array_t = std::vector<event_type>;
+    using label_map_t   = std::map<uint64_t, std::string>;
+    using resolver_t    = std::function<std::string(uint64_t)>;
+    using lock_t        = std::unique_lock<std::mutex>;
+
+    struct block_type
+    {
+        uint32_t      tid    = 0;
+        event_array_t events = {};
+        label_map_t   labels = {};
+    };
+
+    event_writer(std::string _fname)
+    : m_fname(std::move(_fname))
+    {}
+
+    virtual ~event_writer() { stop_thread(); }
+
+    event_writer(const event_writer&) = delete;
+    event_writer(event_writer&&)      = delete;
+
+    event_writer& operator=(const event_writer&) = delete;
+    event_writer& operator=(event_writer&&) = delete;
+
+    /// queue a block of events (in chronological order) from thread \param _tid
+    void push(uint32_t _tid, event_array_t&& _events, label_map_t&& _labels = {})
+    {
+        if(_events.empty() && _labels.empty())
+            return;
+        lock_t _lk(m_mutex);
+        if(m_closed)
+            return;
+        m_queue.emplace_back(block_type{ _tid, std::move(_events), std::move(_labels) });
+        if(!m_thread.joinable())
+        {
+            m_stop   = false;
+            m_thread = std::thread(&event_writer::run, this);
+        }
+        _lk.unlock();
+        m_cv.notify_one();
+    }
+
+    /// write all the queued blocks, finish and close the file. The resolver provides
+    /// the label of any hash which was not reported with the blocks. Returns the
+    /// filename if anything was written
+    std::string close(const resolver_t& _resolver = {})
+    {
+        {
+            lock_t _lk(m_mutex);
+            if(m_closed)
+                return (m_nevents > 0) ? m_fname : std::string{};
+        }
+        stop_thread();
+
+        lock_t _lk(m_mutex);
+        m_closed = true;
+        if(!m_ofs.is_open())
+            return std::string{};
+
+        for(const auto& itr : m_hashes)
+        {
+            if(m_labels.find(itr) == m_labels.end())
+                m_labels[itr] = (_resolver) ? _resolver(itr) : std::to_string(itr);
+        }
+        finish();
+        flush();
+        m_ofs.close();
+        return m_fname;
+    }
+
+    size_t             size() const { return m_nevents; }
+    const std::string& get_filename() const { return m_fname; }
+
+protected:
+    /// write the file header
+    virtual void open() = 0;
+    /// write a block of events
+    virtual void write(const block_type&) = 0;
+    /// write the file trailer
+    virtual void finish() = 0;
+
+    void put(uint8_t c) { m_buffer.push_back(static_cast<char>(c)); }
+
+    void write_bytes(const char* data, size_t n)
+    {
+        m_buffer.insert(m_buffer.end(), data, data + n);
+    }
+
+    void write_string(const std::string& _str)
+    {
+        write_bytes(_str.data(), _str.length());
+    }
+
+    void flush()
+    {
+        if(!m_buffer.empty() && m_ofs)
+            m_ofs.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+
+    const std::string& get_label(uint64_t _hash)
+    {
+        auto itr = m_labels.find(_hash);
+        if(itr == m_labels.end())
+            itr = m_labels.insert({ _hash, std::to_string(_hash) }).first;
+        return itr->second;
+    }
+
+private:
+    void stop_thread()
+    {
+        {
+            lock_t _lk(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if(m_thread.joinable())
+            m_thread.join();
+    }
+
+    void run()
+    {
+        lock_t _lk(m_mutex);
+        while(true)
+        {
+            m_cv.wait(_lk, [this]() { return m_stop || !m_queue.empty(); });
+            while(!m_queue.empty())
+            {
+                auto _block = std::move(m_queue.front());
+                m_queue.pop_front();
+                _lk.unlock();
+                process(_block);
+                _lk.lock();
+            }
+            if(m_stop)
+                break;
+        }
+    }
+
+    void process(block_type& _block)
+    {
+        for(auto& itr : _block.labels)
+            m_labels[itr.first] = std::move(itr.second);
+        if(_block.events.empty())
+            return;
+        if(!m_ofs.is_open())
+        {
+            m_ofs.open(m_fname.c_str(), std::ios::out | std::ios::binary);
+            if(!m_ofs)
+                return;
+            open();
+        }
+        if(!m_ofs)
+            return;
+        for(const auto& itr : _block.events)
+            m_hashes.insert(itr.hash);
+        write(_block);
+        m_nevents += _block.events.size();
+        flush();
+    }
+
+protected:
+    bool                    m_stop    = false;
+    bool                    m_closed  = false;
+    size_t                  m_nevents = 0;
+    std::string             m_fname   = "";
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::deque<block_type>  m_queue  = {};
+    std::set<uint64_t>      m_hashes = {};
+    label_map_t             m_labels = {};
+    std::vector<char>       m_buffer = {};
+    std::ofstream           m_ofs;
+    std::thread             m_thread;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::timeline_writer
+/// \brief Writes the events in a compact binary layout (.tmt):
+///
+///     "TMTL" magic, version, flags (bit 0: compressed), value encoding
+///     (0: raw bytes, 1: zig-zag varint, 2: float64, 3: float32), varint value size,
+///     varint label length + label
+///
+///     0x01 event block: varint thread, varint count, events
+///     0x02 label table: varint count, (varint hash, varint length + label)...
+///
+/// When compressed, each event is the varint hash, the zig-zag varint of the start
+/// relative to the previous start in the block, the varint duration and the encoded
+/// value. Otherwise, each event is the fixed-size hash, start, stop and value. Values
+/// which are not trivially copyable are not written.
+///
+template <typename Tp>
+class timeline_writer : public event_writer<Tp>
+{
+public:
+    using base_type  = event_writer<Tp>;
+    using value_type = typename base_type::value_type;
+    using block_type = typename base_type::block_type;
+
+    static constexpr uint8_t version = 1;
+
+    timeline_writer(std::string _fname, std::string _label, bool _compress)
+    : base_type(std::move(_fname))
+    , m_compress(_compress)
+    , m_label(std::move(_label))
+    {}
+
+    ~timeline_writer() override { this->close(); }
+
+    bool is_compressed() const { return m_compress; }
+
+protected:
+    void open() override
+    {
+        this->write_bytes("TMTL", 4);
+        this->put(version);
+        this->put((m_compress) ? 1 : 0);
+        this->put(value_encoding());
+        write_varint((std::is_trivially_copyable<value_type>::value) ? sizeof(value_type)
+                                                                      : 0);
+        write_varint(m_label.length());
+        this->write_string(m_label);
+    }
+
+    void write(const block_type& _block) override
+    {
+        this->put(0x01);
+        write_varint(_block.tid);
+        write_varint(_block.events.size());
+        int64_t _prev = 0;
+        for(const auto& itr : _block.events)
+        {
+            if(m_compress)
+            {
+                write_varint(itr.hash);
+                write_signed(itr.start - _prev);
+                write_varint(static_cast<uint64_t>(itr.stop - itr.start));
+                write_value(itr.value);
+                _prev = itr.start;
+            }
+            else
+            {
+                write_fixed(itr.hash);
+                write_fixed(itr.start);
+                write_fixed(itr.stop);
+                write_fixed(itr.value);
+            }
+        }
+    }
+
+    void finish() override
+    {
+        this->put(0x02);
+        write_varint(this->m_hashes.size());
+        for(const auto& itr : this->m_hashes)
+        {
+            const auto& _label = this->get_label(itr);
+            write_varint(itr);
+            write_varint(_label.length());
+            this->write_string(_label);
+        }
+    }
+
+private:
+    static constexpr uint8_t value_encoding()
+    {
+        return (std::is_integral<value_type>::value)
+                   ? 1
+                   : (std::is_same<value_type, double>::value)
+                         ? 2
+                         : (std::is_same<value_type, float>::value) ? 3 : 0;
+    }
+
+    void write_varint(uint64_t v)
+    {
+        while(v >= 0x80)
+        {
+            this->put(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        this->put(static_cast<uint8_t>(v));
+    }
+
+    void write_signed(int64_t v)
+    {
+        write_varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    template <typename Up,
+              enable_if_t<(std::is_trivially_copyable<Up>::value), int> = 0>
+    void write_fixed(const Up& v)
+    {
+        char _bytes[sizeof(Up)];
+        std::memcpy(_bytes, &v, sizeof(Up));
+        this->write_bytes(_bytes, sizeof(Up));
+    }
+
+    template <typename Up,
+              enable_if_t<!(std::is_trivially_copyable<Up>::value), int> = 0>
+    void write_fixed(const Up&)
+    {}
+
+    template <typename Up, enable_if_t<(std::is_integral<Up>::value), int> = 0>
+    void write_value(const Up& v)
+    {
+        write_signed(static_cast<int64_t>(v));
+    }
+
+    template <typename Up, enable_if_t<!(std::is_integral<Up>::value), int> = 0>
+    void write_value(const Up& v)
+    {
+        write_fixed(v);
+    }
+
+private:
+    bool        m_compress = true;
+    std::string m_label    = "";
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::chrome_trace_writer
+/// \brief Writes the events in the Chrome trace event JSON format, which can be loaded
+/// by chrome://tracing and the Perfetto UI (ui.perfetto.dev). Each event is a complete
+/// ("X") event with microsecond timestamps; arithmetic values are stored in the
+/// arguments of the event. The process and thread names are written when closed.
+///
+template <typename Tp>
+class chrome_trace_writer : public event_writer<Tp>
+{
+public:
+    using base_type  = event_writer<Tp>;
+    using value_type = typename base_type::value_type;
+    using block_type = typename base_type::block_type;
+
+    chrome_trace_writer(std::string _fname, std::string _label, int64_t _pid,
+                        int32_t _rank = 0)
+    : base_type(std::move(_fname))
+    , m_pid(_pid)
+    , m_rank(_rank)
+    , m_label(escape(_label))
+    {}
+
+    ~chrome_trace_writer() override { this->close(); }
+
+    static std::string escape(const std::string& _str)
+    {
+        std::stringstream ss;
+        for(const auto& c : _str)
+        {
+            switch(c)
+            {
+                case '"': ss << "\\\""; break;
+                case '\\': ss << "\\\\"; break;
+                case '\n': ss << "\\n"; break;
+                case '\t': ss << "\\t"; break;
+                case '\r': ss << "\\r"; break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20)
+                        ss << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf]
+                           << "0123456789abcdef"[c & 0xf];
+                    else
+                        ss << c;
+            }
+        }
+        return ss.str();
+    }
+
+protected:
+    void open() override { this->write_string("{\"traceEvents\":[\n"); }
+
+    void write(const block_type& _block) override
+    {
+        m_tids.insert(_block.tid);
+        std::stringstream ss;
+        ss.precision(3);
+        ss << std::fixed;
+        for(const auto& itr : _block.events)
+        {
+            if(m_count++ > 0)
+                ss << ",\n";
+            ss << "{\"name\":\"" << escape(this->get_label(itr.hash)) << "\",\"cat\":\""
+               << m_label << "\",\"ph\":\"X\",\"pid\":" << m_pid
+               << ",\"tid\":" << _block.tid << ",\"ts\":" << (itr.start / 1.0e3)
+               << ",\"dur\":" << ((itr.stop - itr.start) / 1.0e3);
+            write_args(ss, itr.value);
+            ss << "}";
+        }
+        this->write_string(ss.str());
+    }
+
+    void finish() override
+    {
+        std::stringstream ss;
+        auto              _sep = [&]() { return (m_count++ > 0) ? ",\n" : ""; };
+        ss << _sep() << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << m_pid
+           << ",\"args\":{\"name\":\"rank " << m_rank << "\"}}";
+        for(const auto& itr : m_tids)
+        {
+            ss << _sep() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << m_pid
+               << ",\"tid\":" << itr << ",\"args\":{\"name\":\"thread " << itr
+               << "\"}}";
+        }
+        ss << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        this->write_string(ss.str());
+    }
+
+private:
+    template <typename Up, enable_if_t<(std::is_arithmetic<Up>::value), int> = 0>
+    static void write_args(std::ostream& os, const Up& v)
+    {
+        os << ",\"args\":{\"value\":" << v << "}";
+    }
+
+    template <typename Up, enable_if_t<!(std::is_arithmetic<Up>::value), int> = 0>
+    static void write_args(std::ostream&, const Up&)
+    {}
+
+private:
+    int64_t            m_pid   = 0;
+    int32_t            m_rank  = 0;
+    size_t             m_count = 0;
+    std::string        m_label = "";
+    std::set<uint32_t> m_tids  = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+/// \class tim::timeline_buffer
+/// \brief Per-thread ring buffer of timeline events with a fixed capacity. It is only
+/// accessed by the thread which owns it so recording an event never takes a lock.
+/// When the buffer is full, the events are either handed off to the writer
+/// (streaming) or the oldest event is overwritten (retention of the most recent
+/// events).
+///
+template <typename Tp>
+class timeline_buffer
+{
+public:
+    using event_type     = node::event<Tp>;
+    using event_array_t  = std::vector<event_type>;
+    using writer_type    = event_writer<Tp>;
+    using writer_pointer = std::shared_ptr<writer_type>;
+    using label_map_t    = typename writer_type::label_map_t;
+    using resolver_t     = typename writer_type::resolver_t;
+
+    /// an event which has been started but not yet stopped
+    struct pending_type
+    {
+        const Tp* obj   = nullptr;
+        uint64_t  hash  = 0;
+        int64_t   start = 0;
+    };
+
+    using pending_array_t = std::vector<pending_type>;
+
+    /// whether the value of the component can be stored in the binary timeline
+    static constexpr bool is_supported =
+        std::is_trivially_copyable<typename event_type::value_type>::value;
+
+    /// the initial depth of the pending event stack
+    static constexpr size_t pending_reserve = 256;
+
+    timeline_buffer(size_t _capacity, uint32_t _tid, bool _stream, writer_pointer _writer,
+                    resolver_t _resolver = {})
+    : m_stream(_stream)
+    , m_tid(_tid)
+    , m_data((_capacity > 0) ? _capacity : 1)
+    , m_writer(std::move(_writer))
+    , m_resolver(std::move(_resolver))
+    {
+        m_pending.reserve(pending_reserve);
+    }
+
+    ~timeline_buffer() { flush(); }
+
+    timeline_buffer(const timeline_buffer&) = delete;
+    timeline_buffer& operator=(const timeline_buffer&) = delete;
+
+    static int64_t now()
+    {
+        using clock_type = std::chrono::system_clock;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   clock_type::now().time_since_epoch())
+            .count();
+    }
+
+    /// record the start of an event for the component instance. The pending events
+    /// are kept in a stack which is reserved up front so that starting an event does
+    /// not allocate unless the nesting exceeds the reserved depth
+    void start(const Tp* _obj, uint64_t _hash)
+    {
+        m_pending.push_back(pending_type{ _obj, _hash, now() });
+    }
+
+    /// complete the event for the component instance. Events are almost always
+    /// stopped in the reverse order they were started so the search begins at the top
+    bool stop(const Tp* _obj)
+    {
+        auto _stop = now();
+        for(auto itr = m_pending.rbegin(); itr != m_pending.rend(); ++itr)
+        {
+            if(itr->obj != _obj)
+                continue;
+            push(event_type{ itr->hash, itr->start, _stop, m_tid, _obj->get_value() });
+            m_pending.erase(std::next(itr).base());
+            return true;
+        }
+        return false;
+    }
+
+    void push(const event_type& _event)
+    {
+        auto _capacity = m_data.size();
+        if(m_size == _capacity)
+        {
+            if(m_stream && m_writer)
+                flush();
+            else
+            {
+                // overwrite the oldest event
+                m_data[m_head] = _event;
+                m_head         = (m_head + 1) % _capacity;
+                ++m_dropped;
+                return;
+            }
+        }
+        m_data[(m_head + m_size) % _capacity] = _event;
+        ++m_size;
+    }
+
+    /// hand the buffered events (and the labels of any new hashes) to the writer and
+    /// reset the ring
+    void flush()
+    {
+        if(m_size == 0 || !m_writer)
+            return;
+        auto        _events = get();
+        label_map_t _labels;
+        if(m_resolver)
+        {
+            for(const auto& itr : _events)
+            {
+                if(m_reported.insert(itr.hash).second)
+                    _labels[itr.hash] = m_resolver(itr.hash);
+            }
+        }
+        m_writer->push(m_tid, std::move(_events), std::move(_labels));
+        m_head = 0;
+        m_size = 0;
+    }
+
+    /// the buffered events in chronological order of completion
+    event_array_t get() const
+    {
+        event_array_t _ret;
+        _ret.reserve(m_size);
+        for(size_t i = 0; i < m_size; ++i)
+            _ret.emplace_back(m_data[(m_head + i) % m_data.size()]);
+        return _ret;
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_data.size(); }
+    size_t dropped() const { return m_dropped; }
+    size_t pending() const { return m_pending.size(); }
+    bool   empty() const { return (m_size == 0); }
+
+private:
+    bool               m_stream   = true;
+    uint32_t           m_tid      = 0;
+    size_t             m_head     = 0;
+    size_t             m_size     = 0;
+    size_t             m_dropped  = 0;
+    event_array_t      m_data     = {};
+    writer_pointer     m_writer   = {};
+    resolver_t         m_resolver = {};
+    std::set<uint64_t> m_reported = {};
+    pending_array_t    m_pending  = {};
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+}  // namespace tim
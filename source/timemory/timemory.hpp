@@ -92,6 +92,8 @@ struct dummy
 #    define TIMEMORY_BLANK_MARKER(...)
 #    define TIMEMORY_BASIC_MARKER(...)
 #    define TIMEMORY_MARKER(...)
+#    define TIMEMORY_CONSTEXPR_BLANK_MARKER(...)
+#    define TIMEMORY_CONSTEXPR_BASIC_MARKER(...)
 
 // define an unique pointer object
 #    define TIMEMORY_BLANK_POINTER(...)
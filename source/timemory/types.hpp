@@ -101,12 +101,14 @@
     component::process_cpu_clock,               \
     component::process_cpu_util,                \
     component::read_bytes,                      \
+    component::sampling_cpu_clock,              \
     component::stack_rss,                       \
     component::system_clock,                    \
     component::tau_marker,                      \
     component::thread_cpu_clock,                \
     component::thread_cpu_util,                 \
     component::trip_count,                      \
+    component::tsc_clock,                       \
     component::user_clock,                      \
     component::user_global_bundle,              \
     component::user_list_bundle,                \
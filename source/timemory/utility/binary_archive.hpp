@@ -0,0 +1,435 @@
+//  MIT License
+//
+//  Copyright (c) 2020, The Regents of the University of California,
+//  through Lawrence Berkeley National Laboratory (subject to receipt of any
+//  required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+/** \file utility/binary_archive.hpp
+ * \headerfile utility/binary_archive.hpp "timemory/utility/binary_archive.hpp"
+ * Compact, streaming binary archive which preserves the object/array/name layout of
+ * the JSON archives so that it can be converted back to the equivalent JSON
+ */
+
+#pragma once
+
+#include <cereal/cereal.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stack>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace cereal
+{
+//--------------------------------------------------------------------------------------//
+//
+/// \class cereal::StreamingBinaryOutputArchive
+/// \brief Writes a tagged binary representation of the JSON tree that the JSON
+/// archives would produce: object and array markers, keys and typed scalar values.
+/// Keys are interned (the first use of a name defines it, later uses reference it by
+/// index), integers are varint encoded and floating-point values are written as raw
+/// little-endian IEEE-754. The encoded bytes are buffered and flushed to the stream in
+/// large blocks as they are produced so that the archive never holds the entire
+/// output in memory. See timemory/util/binary.py for the reader and JSON converter.
+///
+/// Layout: "TMBIN" magic, one byte version, followed by the root object. Tokens:
+///
+///     0x01 begin object   0x02 begin array   0x03 end object/array
+///     0x04 define key (varint id, varint length, bytes)   0x05 key (varint id)
+///     0x10 null   0x11 false   0x12 true
+///     0x13 signed integer (zig-zag varint)   0x14 unsigned integer (varint)
+///     0x15 float64   0x16 float32   0x17 string (varint length, bytes)
+///
+class StreamingBinaryOutputArchive
+: public OutputArchive<StreamingBinaryOutputArchive>
+{
+public:
+    static constexpr uint8_t version     = 1;
+    static constexpr size_t  buffer_size = (1 << 20);
+
+    enum token : uint8_t
+    {
+        begin_object = 0x01,
+        begin_array  = 0x02,
+        end_node     = 0x03,
+        define_key   = 0x04,
+        key_ref      = 0x05,
+        null_value   = 0x10,
+        false_value  = 0x11,
+        true_value   = 0x12,
+        int_value    = 0x13,
+        uint_value   = 0x14,
+        f64_value    = 0x15,
+        f32_value    = 0x16,
+        str_value    = 0x17,
+    };
+
+    explicit StreamingBinaryOutputArchive(std::ostream& os)
+    : OutputArchive<StreamingBinaryOutputArchive>(this)
+    , m_os(os)
+    {
+        m_buffer.reserve(buffer_size + 64);
+        write_bytes("TMBIN", 5);
+        m_buffer.push_back(static_cast<char>(version));
+        m_nodes.push(node_type::start_object);
+        m_counters.push(0);
+    }
+
+    ~StreamingBinaryOutputArchive() CEREAL_NOEXCEPT
+    {
+        switch(m_nodes.top())
+        {
+            case node_type::start_object:
+                put(begin_object);
+                put(end_node);
+                break;
+            case node_type::start_array:
+                put(begin_array);
+                put(end_node);
+                break;
+            default: put(end_node); break;
+        }
+        flush();
+    }
+
+    StreamingBinaryOutputArchive(const StreamingBinaryOutputArchive&) = delete;
+    StreamingBinaryOutputArchive& operator=(const StreamingBinaryOutputArchive&) = delete;
+
+    //----------------------------------------------------------------------------------//
+    //  node handling (mirrors the JSON archives)
+    //
+    void startNode()
+    {
+        writeName();
+        m_nodes.push(node_type::start_object);
+        m_counters.push(0);
+    }
+
+    void finishNode()
+    {
+        switch(m_nodes.top())
+        {
+            case node_type::start_object: put(begin_object); break;
+            case node_type::start_array: put(begin_array); break;
+            default: break;
+        }
+        put(end_node);
+        m_nodes.pop();
+        m_counters.pop();
+        if(m_buffer.size() >= buffer_size)
+            flush();
+    }
+
+    void setNextName(const char* name) { m_next_name = name; }
+
+    void makeArray() { m_nodes.top() = node_type::start_array; }
+
+    void writeName()
+    {
+        auto& _top = m_nodes.top();
+        if(_top == node_type::start_object)
+        {
+            put(begin_object);
+            _top = node_type::in_object;
+        }
+        else if(_top == node_type::start_array)
+        {
+            put(begin_array);
+            _top = node_type::in_array;
+        }
+
+        if(_top == node_type::in_array)
+        {
+            m_next_name = nullptr;
+            return;
+        }
+
+        if(m_next_name)
+        {
+            write_key(m_next_name);
+            m_next_name = nullptr;
+        }
+        else
+        {
+            // unnamed entries of an object are named the same as the JSON archives
+            write_key("value" + std::to_string(m_counters.top()++));
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  values
+    //
+    void saveValue(bool b) { put((b) ? true_value : false_value); }
+    void saveValue(std::nullptr_t) { put(null_value); }
+    void saveValue(const std::string& s)
+    {
+        put(str_value);
+        write_varint(s.length());
+        write_bytes(s.data(), s.length());
+    }
+    void saveValue(const char* s) { saveValue(std::string(s)); }
+    void saveValue(float v)
+    {
+        put(f32_value);
+        write_fixed(v);
+    }
+    void saveValue(double v)
+    {
+        put(f64_value);
+        write_fixed(v);
+    }
+    void saveValue(long double v) { saveValue(static_cast<double>(v)); }
+
+    template <typename Tp, traits::EnableIf<std::is_integral<Tp>::value,
+                                            std::is_signed<Tp>::value> = traits::sfinae>
+    void saveValue(Tp v)
+    {
+        auto _v = static_cast<int64_t>(v);
+        put(int_value);
+        write_varint((static_cast<uint64_t>(_v) << 1) ^ static_cast<uint64_t>(_v >> 63));
+    }
+
+    template <typename Tp, traits::EnableIf<std::is_integral<Tp>::value,
+                                            !std::is_signed<Tp>::value> = traits::sfinae>
+    void saveValue(Tp v)
+    {
+        put(uint_value);
+        write_varint(static_cast<uint64_t>(v));
+    }
+
+    /// write any buffered output to the stream
+    void flush()
+    {
+        if(!m_buffer.empty())
+            m_os.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+
+private:
+    enum class node_type : uint8_t
+    {
+        start_object,
+        in_object,
+        start_array,
+        in_array
+    };
+
+    void put(uint8_t c) { m_buffer.push_back(static_cast<char>(c)); }
+
+    void write_bytes(const char* data, size_t n)
+    {
+        m_buffer.insert(m_buffer.end(), data, data + n);
+    }
+
+    void write_varint(uint64_t v)
+    {
+        while(v >= 0x80)
+        {
+            put(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        put(static_cast<uint8_t>(v));
+    }
+
+    template <typename Tp>
+    void write_fixed(Tp v)
+    {
+        char _bytes[sizeof(Tp)];
+        std::memcpy(_bytes, &v, sizeof(Tp));
+        if(is_big_endian())
+        {
+            for(size_t i = 0; i < sizeof(Tp) / 2; ++i)
+                std::swap(_bytes[i], _bytes[sizeof(Tp) - i - 1]);
+        }
+        write_bytes(_bytes, sizeof(Tp));
+    }
+
+    void write_key(const std::string& name)
+    {
+        auto itr = m_keys.find(name);
+        if(itr != m_keys.end())
+        {
+            put(key_ref);
+            write_varint(itr->second);
+            return;
+        }
+        auto _id = m_keys.size();
+        m_keys.insert({ name, _id });
+        put(define_key);
+        write_varint(_id);
+        write_varint(name.length());
+        write_bytes(name.data(), name.length());
+    }
+
+    static bool is_big_endian()
+    {
+        const uint16_t _val = 1;
+        uint8_t        _byte;
+        std::memcpy(&_byte, &_val, 1);
+        return (_byte == 0);
+    }
+
+private:
+    std::ostream&                             m_os;
+    const char*                               m_next_name = nullptr;
+    std::stack<node_type>                     m_nodes;
+    std::stack<uint64_t>                      m_counters;
+    std::unordered_map<std::string, uint64_t> m_keys;
+    std::vector<char>                         m_buffer;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+//  prologue and epilogue functions
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename T>
+inline void
+prologue(StreamingBinaryOutputArchive&, const NameValuePair<T>&)
+{}
+//
+template <typename T>
+inline void
+epilogue(StreamingBinaryOutputArchive&, const NameValuePair<T>&)
+{}
+//
+template <typename T>
+inline void
+prologue(StreamingBinaryOutputArchive& ar, const SizeTag<T>&)
+{
+    ar.makeArray();
+}
+//
+template <typename T>
+inline void
+epilogue(StreamingBinaryOutputArchive&, const SizeTag<T>&)
+{}
+//
+/// objects (anything that is not arithmetic or minimally serialized) become nodes
+template <typename T,
+          traits::EnableIf<!std::is_arithmetic<T>::value,
+                           !traits::has_minimal_base_class_serialization<
+                               T, traits::has_minimal_output_serialization,
+                               StreamingBinaryOutputArchive>::value,
+                           !traits::has_minimal_output_serialization<
+                               T, StreamingBinaryOutputArchive>::value> = traits::sfinae>
+inline void
+prologue(StreamingBinaryOutputArchive& ar, const T&)
+{
+    ar.startNode();
+}
+//
+template <typename T,
+          traits::EnableIf<!std::is_arithmetic<T>::value,
+                           !traits::has_minimal_base_class_serialization<
+                               T, traits::has_minimal_output_serialization,
+                               StreamingBinaryOutputArchive>::value,
+                           !traits::has_minimal_output_serialization<
+                               T, StreamingBinaryOutputArchive>::value> = traits::sfinae>
+inline void
+epilogue(StreamingBinaryOutputArchive& ar, const T&)
+{
+    ar.finishNode();
+}
+//
+inline void
+prologue(StreamingBinaryOutputArchive& ar, const std::nullptr_t&)
+{
+    ar.writeName();
+}
+//
+inline void
+epilogue(StreamingBinaryOutputArchive&, const std::nullptr_t&)
+{}
+//
+template <typename T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae>
+inline void
+prologue(StreamingBinaryOutputArchive& ar, const T&)
+{
+    ar.writeName();
+}
+//
+template <typename T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae>
+inline void
+epilogue(StreamingBinaryOutputArchive&, const T&)
+{}
+//
+template <typename CharT, typename Traits, typename Alloc>
+inline void
+prologue(StreamingBinaryOutputArchive& ar, const std::basic_string<CharT, Traits, Alloc>&)
+{
+    ar.writeName();
+}
+//
+template <typename CharT, typename Traits, typename Alloc>
+inline void
+epilogue(StreamingBinaryOutputArchive&, const std::basic_string<CharT, Traits, Alloc>&)
+{}
+//
+//--------------------------------------------------------------------------------------//
+//
+//  save functions
+//
+//--------------------------------------------------------------------------------------//
+//
+template <typename T>
+inline void
+CEREAL_SAVE_FUNCTION_NAME(StreamingBinaryOutputArchive& ar, const NameValuePair<T>& t)
+{
+    ar.setNextName(t.name);
+    ar(t.value);
+}
+//
+inline void
+CEREAL_SAVE_FUNCTION_NAME(StreamingBinaryOutputArchive& ar, const std::nullptr_t& t)
+{
+    ar.saveValue(t);
+}
+//
+template <typename T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae>
+inline void
+CEREAL_SAVE_FUNCTION_NAME(StreamingBinaryOutputArchive& ar, const T& t)
+{
+    ar.saveValue(t);
+}
+//
+template <typename CharT, typename Traits, typename Alloc>
+inline void
+CEREAL_SAVE_FUNCTION_NAME(StreamingBinaryOutputArchive&                   ar,
+                          const std::basic_string<CharT, Traits, Alloc>& str)
+{
+    ar.saveValue(std::string(str.begin(), str.end()));
+}
+//
+template <typename T>
+inline void
+CEREAL_SAVE_FUNCTION_NAME(StreamingBinaryOutputArchive&, const SizeTag<T>&)
+{}
+//
+}  // namespace cereal
+
+CEREAL_REGISTER_ARCHIVE(cereal::StreamingBinaryOutputArchive)
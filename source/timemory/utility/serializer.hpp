@@ -55,10 +55,12 @@
 #include <cereal/types/vector.hpp>
 
 // archives
+#include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 #if defined(TIMEMORY_USE_XML_ARCHIVE)
 #    include <cereal/archives/xml.hpp>
 #endif
+#include "timemory/utility/binary_archive.hpp"
 
 #if defined(__GNUC__) && (__GNUC__ > 7)
 #    pragma GCC diagnostic pop
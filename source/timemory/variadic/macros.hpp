@@ -113,6 +113,28 @@ using string = tim::apply<std::string>;
 
 #    define TIMEMORY_COMP_TYPE(TYPE) typename TYPE::component_type
 
+//--------------------------------------------------------------------------------------//
+//  hash of a string literal label computed at compile-time
+//
+#    define TIMEMORY_HASH_LITERAL(LABEL)                                                 \
+        std::integral_constant<::tim::hash_result_type,                                  \
+                               ::tim::get_hash_id(LABEL)>::value
+
+//--------------------------------------------------------------------------------------//
+//  hash of the label of TIMEMORY_BASIC_MARKER with a string literal computed at
+//  compile-time, i.e. "<function>/<label>"
+//
+#    define TIMEMORY_HASH_BASIC_LITERAL(LABEL)                                           \
+        std::integral_constant<::tim::hash_result_type,                                  \
+                               ::tim::hash::fnv1a_append(                                \
+                                   ::tim::hash::fnv1a_append(                            \
+                                       ::tim::get_hash_id(__FUNCTION__), "/"),           \
+                                   LABEL)>::value
+
+//--------------------------------------------------------------------------------------//
+
+#    define _TIM_HASH_VARIABLE(Y) _TIM_VAR_NAME_COMBINE(timemory_hash_, Y)
+
 //======================================================================================//
 //
 //                      MARKER MACROS
@@ -138,6 +160,24 @@ using string = tim::apply<std::string>;
         TIMEMORY_AUTO_TYPE(TYPE)                                                         \
         _TIM_VARIABLE(__LINE__)(TIMEMORY_CAPTURE_ARGS(__VA_ARGS__))
 
+//--------------------------------------------------------------------------------------//
+//  equivalent to TIMEMORY_BLANK_MARKER and TIMEMORY_BASIC_MARKER for a string literal
+//  label: the hash is computed at compile-time and the label is registered (and
+//  checked for hash collisions) once per thread instead of building a label
+//
+#    define TIMEMORY_CONSTEXPR_BLANK_MARKER(TYPE, LABEL)                                 \
+        static thread_local const auto _TIM_HASH_VARIABLE(__LINE__) =                    \
+            ::tim::add_hash_id(TIMEMORY_HASH_LITERAL(LABEL), LABEL);                     \
+        TIMEMORY_AUTO_TYPE(TYPE) _TIM_VARIABLE(__LINE__)(_TIM_HASH_VARIABLE(__LINE__))
+
+//--------------------------------------------------------------------------------------//
+
+#    define TIMEMORY_CONSTEXPR_BASIC_MARKER(TYPE, LABEL)                                 \
+        static thread_local const auto _TIM_HASH_VARIABLE(__LINE__) =                    \
+            ::tim::add_hash_id(TIMEMORY_HASH_BASIC_LITERAL(LABEL),                       \
+                               TIMEMORY_JOIN("/", __FUNCTION__, LABEL).c_str());         \
+        TIMEMORY_AUTO_TYPE(TYPE) _TIM_VARIABLE(__LINE__)(_TIM_HASH_VARIABLE(__LINE__))
+
 //======================================================================================//
 //
 //                      CONDITIONAL MARKER MACROS
@@ -0,0 +1,195 @@
+// MIT License
+//
+// Copyright (c) 2020, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "timemory/environment.hpp"
+#include "timemory/utility/argparse.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//--------------------------------------------------------------------------------------//
+//
+//  Queries the call-graphs served by a process running with TIMEMORY_EXPORT_SOCKET
+//  (see timemory/storage/export.hpp for the protocol)
+//
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    using parser_t = tim::argparse::argument_parser;
+
+    const char* _env = "TIMEMORY_EXPORT_SOCKET";
+
+    std::string              _path   = tim::get_env<std::string>(_env, "");
+    std::string              _pid    = "";
+    std::string              _format = "json";
+    std::string              _output = "";
+    std::vector<std::string> _labels = {};
+
+    parser_t parser("timemory-query");
+
+    parser.enable_help();
+    parser.add_argument({ "-s", "--socket" },
+                        "Path of the socket (default: TIMEMORY_EXPORT_SOCKET)")
+        .count(1);
+    parser.add_argument({ "-p", "--pid" }, "PID which replaces '%p' in the socket path")
+        .count(1);
+    parser
+        .add_argument({ "-f", "--format" },
+                      "Format of the response: 'json', 'binary', or 'list' (the labels "
+                      "of the components which are served)")
+        .count(1);
+    parser.add_argument({ "-c", "--components" },
+                        "Labels of the components to query (default: all)");
+    parser.add_argument({ "-o", "--output" }, "Write the response to file").count(1);
+
+    auto err = parser.parse(argc, argv);
+    if(err)
+        std::cerr << err << std::endl;
+
+    if(err || parser.exists("help"))
+    {
+        parser.print_help();
+        return EXIT_FAILURE;
+    }
+
+    if(parser.exists("socket"))
+        _path = parser.get<std::string>("socket");
+
+    if(parser.exists("pid"))
+        _pid = parser.get<std::string>("pid");
+
+    if(parser.exists("format"))
+        _format = parser.get<std::string>("format");
+
+    if(parser.exists("components"))
+        _labels = parser.get<std::vector<std::string>>("components");
+
+    if(parser.exists("output"))
+        _output = parser.get<std::string>("output");
+
+    if(_path.empty())
+    {
+        fprintf(stderr, "[%s]> no socket was provided\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto _pos = _path.find("%p");
+    if(_pos != std::string::npos)
+    {
+        if(_pid.empty())
+        {
+            fprintf(stderr, "[%s]> socket '%s' requires a PID\n", argv[0], _path.c_str());
+            return EXIT_FAILURE;
+        }
+        _path.replace(_pos, 2, _pid);
+    }
+
+    if(_format == "binary" && _output.empty() && isatty(STDOUT_FILENO))
+    {
+        fprintf(stderr, "[%s]> refusing to write binary data to a terminal\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sockaddr_un _addr{};
+    _addr.sun_family = AF_UNIX;
+    if(_path.length() >= sizeof(_addr.sun_path))
+    {
+        fprintf(stderr, "[%s]> socket path is too long: '%s'\n", argv[0], _path.c_str());
+        return EXIT_FAILURE;
+    }
+    strncpy(_addr.sun_path, _path.c_str(), sizeof(_addr.sun_path) - 1);
+
+    int _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(_fd < 0 || connect(_fd, reinterpret_cast<sockaddr*>(&_addr), sizeof(_addr)) != 0)
+    {
+        fprintf(stderr, "[%s]> unable to connect to '%s': %s\n", argv[0], _path.c_str(),
+                strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    std::string _request = _format;
+    for(const auto& itr : _labels)
+        _request += " " + itr;
+    _request += "\n";
+
+    for(size_t _n = 0; _n < _request.length();)
+    {
+        auto _ret = send(_fd, _request.data() + _n, _request.length() - _n, 0);
+        if(_ret < 0 && errno == EINTR)
+            continue;
+        if(_ret <= 0)
+        {
+            fprintf(stderr, "[%s]> error sending the request: %s\n", argv[0],
+                    strerror(errno));
+            close(_fd);
+            return EXIT_FAILURE;
+        }
+        _n += static_cast<size_t>(_ret);
+    }
+
+    std::ofstream _ofs{};
+    if(!_output.empty())
+    {
+        _ofs.open(_output.c_str(), std::ios::out | std::ios::binary);
+        if(!_ofs)
+        {
+            fprintf(stderr, "[%s]> unable to open '%s'\n", argv[0], _output.c_str());
+            close(_fd);
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& _os = (_ofs.is_open()) ? _ofs : std::cout;
+
+    // the server closes the connection after the response
+    char _buff[8192];
+    while(true)
+    {
+        auto _ret = recv(_fd, _buff, sizeof(_buff), 0);
+        if(_ret < 0 && errno == EINTR)
+            continue;
+        if(_ret <= 0)
+            break;
+        _os.write(_buff, _ret);
+    }
+    _os.flush();
+    close(_fd);
+
+    if(!_output.empty())
+        fprintf(stderr, "[%s]> Outputting '%s'...\n", argv[0], _output.c_str());
+
+    return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 
 static strset_t                                   extra_libs = {};
 static std::vector<std::pair<uint64_t, string_t>> hash_ids;
+static std::vector<std::pair<uint64_t, variable_expr_t*>> site_flags;
 static std::map<string_t, bool>                   use_stubs;
 static std::map<string_t, procedure_t*>           beg_stubs;
 static std::map<string_t, procedure_t*>           end_stubs;
@@ -238,6 +239,12 @@ main(int argc, char** argv)
         .choices({ "file", "line", "return", "args" });
     parser.add_argument({ "--mpip" }, "Enable MPI profiling via GOTCHA").count(0);
     parser.add_argument({ "--ompt" }, "Enable OpenMP profiling via OMPT").count(0);
+    parser
+        .add_argument({ "--patchable" },
+                      "Guard the instrumentation of each function with a flag which the "
+                      "trace library sets when the function is throttled so that "
+                      "throttled functions skip the calls into the library entirely")
+        .count(0);
     parser.add_argument({ "--load" },
                         "Supplemental instrumentation library names w/o extension (e.g. "
                         "'libinstr' for 'libinstr.so' or 'libinstr.a')");
@@ -361,6 +368,9 @@ main(int argc, char** argv)
     else
         use_stubs["ompt"] = false;
 
+    if(parser.exists("patchable"))
+        use_patchable = true;
+
     if(parser.exists("p"))
         _pid = parser.get<int>("p");
 
@@ -727,6 +737,7 @@ main(int argc, char** argv)
     auto* env_func      = find_function(app_image, "timemory_trace_set_env");
     auto* mpi_func      = find_function(app_image, "timemory_trace_set_mpi");
     auto* hash_func     = find_function(app_image, "timemory_add_hash_id");
+    auto* site_func     = find_function(app_image, "timemory_add_trace_site");
     auto* exit_func     = find_function(app_image, "exit", { "_exit" });
     auto* mpi_init_func = find_function(app_image, "MPI_Init", { "MPI_Init_thread" });
     auto* mpi_fini_func = find_function(app_image, "MPI_Finalize");
@@ -737,6 +748,15 @@ main(int argc, char** argv)
     if(mpi_init_func && mpi_fini_func)
         use_mpi = true;
 
+    auto* site_type = app_image->findType("int");
+    if(use_patchable && (!entr_hash || !exit_hash || !site_func || !site_type))
+    {
+        fprintf(stderr, "[timemory-run]> Warning! Patchable instrumentation requires "
+                        "'%s', '%s', and 'timemory_add_trace_site'. Disabling...\n",
+                instr_push_hash.c_str(), instr_pop_hash.c_str());
+        use_patchable = false;
+    }
+
     //----------------------------------------------------------------------------------//
     //
     //  Handle supplemental instrumentation library functions
@@ -1169,21 +1189,40 @@ main(int argc, char** argv)
                 continue;
             }
 
-            hash_ids.push_back({ std::hash<string_t>()(name.get()), name.get() });
+            hash_ids.push_back({ tim::get_hash_id(name.get()), name.get() });
             available_module_functions.insert(module_function(mod, itr));
             instrumented_module_functions.insert(module_function(mod, itr));
 
+            // zero-initialized flag in the data section of the mutatee which the
+            // trace library sets while the function is throttled
+            variable_expr_t* _flag = nullptr;
+            if(use_patchable)
+            {
+                _flag = addr_space->malloc(*site_type);
+                if(_flag)
+                    site_flags.push_back({ hash_ids.back().first, _flag });
+            }
+
             auto _f = [=]() {
                 verbprintf(0, "Instrumenting |> [ %s ] -> [ %s ]\n", modname,
                            name.m_name.c_str());
                 auto _name       = name.get();
-                auto _hash       = std::hash<string_t>()(_name);
+                auto _hash       = tim::get_hash_id(_name);
                 auto _trace_entr = (entr_hash) ? timemory_call_expr(_hash)
                                                : timemory_call_expr(_name.c_str());
                 auto _trace_exit = (exit_hash) ? timemory_call_expr(_hash)
                                                : timemory_call_expr(_name.c_str());
-                auto _entr = _trace_entr.get((entr_hash) ? entr_hash : entr_trace);
-                auto _exit = _trace_exit.get((exit_hash) ? exit_hash : exit_trace);
+                snippet_pointer_t _entr =
+                    _trace_entr.get((entr_hash) ? entr_hash : entr_trace);
+                snippet_pointer_t _exit =
+                    _trace_exit.get((exit_hash) ? exit_hash : exit_trace);
+
+                if(_flag && _entr && _exit)
+                {
+                    auto _active = BPatch_boolExpr(BPatch_eq, *_flag, const_expr_t(0));
+                    _entr = snippet_pointer_t(new BPatch_ifExpr(_active, *_entr));
+                    _exit = snippet_pointer_t(new BPatch_ifExpr(_active, *_exit));
+                }
 
                 insert_instr(addr_space, itr, _entr, BPatch_entry, nullptr, nullptr);
                 insert_instr(addr_space, itr, _exit, BPatch_exit, nullptr, nullptr);
@@ -1205,7 +1244,7 @@ main(int argc, char** argv)
                     auto _lf = [=]() {
                         auto lname        = get_loop_file_line_info(mod, itr, flow, litr);
                         auto _lname       = lname.get();
-                        auto _lhash       = std::hash<string_t>()(_lname);
+                        auto _lhash       = tim::get_hash_id(_lname);
                         auto _ltrace_entr = (entr_hash)
                                                 ? timemory_call_expr(_lhash)
                                                 : timemory_call_expr(_lname.c_str());
@@ -1282,6 +1321,9 @@ main(int argc, char** argv)
     // generate a call expression for each hash + key
     for(auto& itr : hash_ids)
         hash_snippet_vec.generate(hash_func, itr.first, itr.second.c_str());
+    // register the address of the flag guarding each function
+    for(auto& itr : site_flags)
+        hash_snippet_vec.generate(site_func, itr.first, itr.second);
     // append all the call expressions to init names
     hash_snippet_vec.append(init_names);
 
@@ -1710,7 +1752,7 @@ instrument_entity(const string_t& function_name)
 //
 void
 insert_instr(address_space_t* mutatee, procedure_t* funcToInstr,
-             call_expr_pointer_t traceFunc, procedure_loc_t traceLoc,
+             snippet_pointer_t traceFunc, procedure_loc_t traceLoc,
              flow_graph_t* cfGraph, basic_loop_t* loopToInstrument)
 {
     module_t* module = funcToInstr->getModule();
@@ -29,6 +29,7 @@
 
 #include "timemory/backends/process.hpp"
 #include "timemory/environment.hpp"
+#include "timemory/hash/types.hpp"
 #include "timemory/mpl/apply.hpp"
 #include "timemory/utility/argparse.hpp"
 #include "timemory/utility/macros.hpp"
@@ -99,6 +100,8 @@ using procedure_loc_t       = BPatch_procedureLocation;
 using point_t               = BPatch_point;
 using local_var_t           = BPatch_localVar;
 using const_expr_t          = BPatch_constExpr;
+using variable_expr_t       = BPatch_variableExpr;
+using address_expr_t        = BPatch_addressExpr;
 using error_level_t         = BPatchErrorLevel;
 using patch_pointer_t       = std::shared_ptr<patch_t>;
 using snippet_pointer_t     = std::shared_ptr<snippet_t>;
@@ -130,6 +133,7 @@ static bool use_return_info  = false;
 static bool use_args_info    = false;
 static bool use_file_info    = false;
 static bool use_line_info    = false;
+static bool use_patchable    = false;
 //
 //  integral settings
 //
@@ -209,7 +213,7 @@ get_loop_file_line_info(module_t* mutatee_module, procedure_t* f, flow_graph_t*
 
 void
 insert_instr(address_space_t* mutatee, procedure_t* funcToInstr,
-             call_expr_pointer_t traceFunc, procedure_loc_t traceLoc,
+             snippet_pointer_t traceFunc, procedure_loc_t traceLoc,
              flow_graph_t* cfGraph = nullptr, basic_loop_t* loopToInstrument = nullptr);
 
 void
@@ -492,6 +496,16 @@ get_snippet(string_t arg)
 //
 //======================================================================================//
 //
+//  variables in the mutatee are passed by address
+//
+inline snippet_pointer_t
+get_snippet(variable_expr_t* arg)
+{
+    return snippet_pointer_t(new address_expr_t(*arg));
+}
+//
+//======================================================================================//
+//
 template <typename... Args>
 snippet_pointer_vec_t
 get_snippets(Args&&... args)
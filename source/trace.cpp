@@ -32,10 +32,19 @@
 #    include "timemory/backends/types/mpi/extern.hpp"
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <deque>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 // #include <dlfcn.h>
 
@@ -69,6 +78,8 @@ static auto&
 get_throttle() TIMEMORY_VISIBILITY("default");
 static trace_map_t&
 get_trace_map() TIMEMORY_VISIBILITY("default");
+static bool
+check_throttle(uint64_t id, uint64_t _count, uint64_t _accum, double _factor = 1.0);
 
 //--------------------------------------------------------------------------------------//
 
@@ -97,11 +108,550 @@ get_trace_map()
     return _instance;
 }
 
+//--------------------------------------------------------------------------------------//
+//
+//      Dense-index fast path for timemory_{push,pop}_trace_hash
+//
+//--------------------------------------------------------------------------------------//
+//
+//  The hash ids which are registered via timemory_add_hash_id (i.e. the ids inserted
+//  by timemory-run) are assigned a dense index exactly once. The hash -> index
+//  mapping is a fixed-capacity, open-addressing table where insertions are serialized
+//  and lookups are lock-free. Since the keys are already hashes, the probe is just a
+//  mask of the low bits. Each thread then keeps a preallocated shadow stack of
+//  records and a flat array of per-function state indexed by the dense index so
+//  that push/pop do not hash, lock, or allocate. Anything that does not fit in
+//  the fast path (unregistered ids, shadow-stack overflow, debug mode) falls back
+//  to the trace map.
+//
+//  Throttling decisions are made by the thread which accumulates throttle_count
+//  calls to a function but they apply to every thread: the decision is published in
+//  a process-wide bitmap indexed by the dense index and each thread keeps a copy of
+//  the bitmap which is refreshed whenever the generation of the bitmap changes.
+//  Every throttle_interval seconds, the throttled functions are re-enabled on
+//  probation and a function on probation must exceed the throttling criteria by a
+//  factor of throttle_hysteresis or it is throttled again. When throttle_budget is
+//  non-zero, the criteria is the fraction of the run-time spent in the
+//  instrumentation instead of the average run-time of the function.
+//
+//  Binaries rewritten by timemory-run with --patchable guard the push/pop call sites
+//  of each function with a flag in the data section of the binary and register the
+//  address of the flag via timemory_add_trace_site. The flags of a function are
+//  set when it is throttled and cleared when it is re-enabled so a throttled
+//  function in a patched binary only pays for a load and a branch.
+//
+namespace
+{
+//
+struct trace_index_table
+{
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    explicit trace_index_table(size_t _capacity)
+    {
+        // round up to power of two
+        size_t _cap = 64;
+        while(_cap < _capacity)
+            _cap <<= 1;
+        m_mask   = _cap - 1;
+        m_limit  = _cap / 2;
+        m_keys.reset(new std::atomic<uint64_t>[_cap]);
+        m_values.reset(new uint32_t[_cap]);
+        for(size_t i = 0; i < _cap; ++i)
+        {
+            m_keys[i].store(0, std::memory_order_relaxed);
+            m_values[i] = npos;
+        }
+    }
+
+    uint32_t find(uint64_t _hash) const
+    {
+        if(_hash == 0)
+            return npos;
+        for(size_t i = _hash & m_mask;; i = (i + 1) & m_mask)
+        {
+            auto _key = m_keys[i].load(std::memory_order_acquire);
+            if(_key == _hash)
+                return m_values[i];
+            if(_key == 0)
+                return npos;
+        }
+    }
+
+    uint32_t insert(uint64_t _hash)
+    {
+        auto _idx = find(_hash);
+        if(_idx != npos || _hash == 0)
+            return _idx;
+
+        std::lock_guard<std::mutex> _lk(m_mutex);
+        // keep load-factor at or below 0.5 so probe sequences stay short
+        if(m_size.load(std::memory_order_relaxed) >= m_limit)
+            return npos;
+        size_t i = _hash & m_mask;
+        for(;; i = (i + 1) & m_mask)
+        {
+            auto _key = m_keys[i].load(std::memory_order_relaxed);
+            if(_key == _hash)
+                return m_values[i];
+            if(_key == 0)
+                break;
+        }
+        _idx        = m_size.load(std::memory_order_relaxed);
+        m_values[i] = _idx;
+        m_keys[i].store(_hash, std::memory_order_release);
+        m_size.store(_idx + 1, std::memory_order_release);
+        return _idx;
+    }
+
+    uint32_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    /// maximum number of dense indices
+    uint32_t capacity() const { return m_limit; }
+
+private:
+    size_t                                   m_mask  = 0;
+    size_t                                   m_limit = 0;
+    std::atomic<uint32_t>                    m_size{ 0 };
+    std::unique_ptr<std::atomic<uint64_t>[]> m_keys;
+    std::unique_ptr<uint32_t[]>              m_values;
+    std::mutex                               m_mutex;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+struct trace_record
+{
+    using storage_type =
+        typename std::aligned_storage<sizeof(traceset_t), alignof(traceset_t)>::type;
+
+    uint32_t     index = trace_index_table::npos;
+    int64_t      enter = 0;  // only recorded when the overhead budget is enabled
+    int64_t      begin = 0;
+    storage_type data;
+
+    traceset_t& get() { return *reinterpret_cast<traceset_t*>(&data); }
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+struct trace_function_state
+{
+    uint64_t count    = 0;
+    int64_t  accum    = 0;
+    int64_t  overhead = 0;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+struct trace_stack
+{
+    explicit trace_stack(size_t _capacity)
+    : capacity(_capacity)
+    , records(new trace_record[_capacity])
+    {}
+
+    ~trace_stack() { clear(false); }
+
+    trace_stack(const trace_stack&) = delete;
+    trace_stack& operator=(const trace_stack&) = delete;
+
+    // stop (optionally) and destroy all the remaining records
+    void clear(bool _stop)
+    {
+        while(depth > 0)
+            pop(_stop);
+        overflow = 0;
+    }
+
+    // stop (optionally) and destroy the record on top of the stack
+    void pop(bool _stop = true)
+    {
+        auto& _rec = records[--depth];
+        if(_stop)
+            _rec.get().stop();
+        _rec.get().~traceset_t();
+        _rec.index = trace_index_table::npos;
+    }
+
+    // pops the records above the innermost record of the function so that it is
+    // on top of the stack. The records above it missed their pop, e.g. an
+    // exception unwound through them or their exit call site was patched out
+    // after the entry executed, or the function was throttled while the record
+    // was on the stack. Returns false if there is no record to pop.
+    bool unwind(uint32_t _idx)
+    {
+        auto _pos = depth;
+        while(_pos > 0 && records[_pos - 1].index != _idx)
+            --_pos;
+        if(_pos == 0)
+            return false;
+        while(depth > _pos)
+            pop();
+        return true;
+    }
+
+    trace_function_state& function(uint32_t _idx, uint32_t _size)
+    {
+        if(_idx >= functions.size())
+            functions.resize(std::max<size_t>(_idx + 1, _size));
+        return functions[_idx];
+    }
+
+    void reset(uint32_t _idx)
+    {
+        if(_idx < functions.size())
+            functions[_idx] = trace_function_state{};
+    }
+
+    bool is_throttled(uint32_t _idx) const
+    {
+        auto _word = _idx / 64;
+        return _word < throttled.size() &&
+               (throttled[_word] & (uint64_t{ 1 } << (_idx % 64))) != 0;
+    }
+
+    size_t                            depth      = 0;
+    size_t                            capacity   = 0;
+    size_t                            overflow   = 0;
+    uint64_t                          generation = 0;
+    uint64_t                          skipped    = 0;
+    int64_t                           overhead   = 0;
+    int64_t                           runtime    = 0;
+    std::unique_ptr<trace_record[]>   records;
+    std::vector<trace_function_state> functions;
+    std::vector<uint64_t>             throttled;
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+struct trace_sites
+{
+    using flag_vec_t = std::vector<volatile int*>;
+
+    void add(uint32_t _idx, int* _flag, bool _throttled)
+    {
+        std::lock_guard<std::mutex> _lk(m_mutex);
+        if(_idx >= m_flags.size())
+            m_flags.resize(_idx + 1);
+        m_flags[_idx].emplace_back(_flag);
+        *m_flags[_idx].back() = (_throttled) ? 1 : 0;
+        m_any.store(true, std::memory_order_release);
+    }
+
+    void set(uint32_t _idx, bool _throttled)
+    {
+        if(!m_any.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> _lk(m_mutex);
+        if(_idx >= m_flags.size())
+            return;
+        for(auto& itr : m_flags[_idx])
+            *itr = (_throttled) ? 1 : 0;
+    }
+
+    bool empty() const { return !m_any.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool>       m_any{ false };
+    std::mutex              m_mutex;
+    std::vector<flag_vec_t> m_flags;
+};
+//
+trace_sites&
+get_trace_sites()
+{
+    static trace_sites _instance{};
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+struct trace_throttle
+{
+    explicit trace_throttle(size_t _capacity)
+    : m_words((_capacity + 63) / 64)
+    , m_throttled(new std::atomic<uint64_t>[m_words])
+    , m_probation(new std::atomic<uint64_t>[m_words])
+    {
+        for(size_t i = 0; i < m_words; ++i)
+        {
+            m_throttled[i].store(0, std::memory_order_relaxed);
+            m_probation[i].store(0, std::memory_order_relaxed);
+        }
+        m_last.store(tim::get_clock_real_now<int64_t, std::nano>());
+    }
+
+    uint64_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+    bool is_throttled(uint32_t _idx) const
+    {
+        return _idx / 64 < m_words &&
+               (m_throttled[_idx / 64].load(std::memory_order_relaxed) & bit(_idx)) != 0;
+    }
+
+    // refresh the bitmap of the thread. Functions which were re-enabled restart
+    // their measurements
+    void sync(trace_stack& _stack, uint32_t _size) const
+    {
+        auto   _gen = generation();
+        size_t _n   = std::min<size_t>((_size + 63) / 64, m_words);
+        if(_stack.throttled.size() < _n)
+            _stack.throttled.resize(_n, 0);
+        for(size_t i = 0; i < _n; ++i)
+        {
+            auto _curr = m_throttled[i].load(std::memory_order_relaxed);
+            auto _diff = _stack.throttled[i] & ~_curr;
+            for(uint32_t j = 0; _diff != 0; ++j, _diff >>= 1)
+            {
+                if(_diff & 1)
+                    _stack.reset(i * 64 + j);
+            }
+            _stack.throttled[i] = _curr;
+        }
+        _stack.generation = _gen;
+    }
+
+    // evaluate the measurements of a function after throttle_count calls
+    bool update(uint64_t _id, uint32_t _idx, const trace_function_state& _func,
+                trace_stack& _stack)
+    {
+        m_overhead.fetch_add(_stack.overhead, std::memory_order_relaxed);
+        m_runtime.fetch_add(_stack.runtime, std::memory_order_relaxed);
+        _stack.overhead = 0;
+        _stack.runtime  = 0;
+
+        if(_idx / 64 >= m_words || _func.count == 0)
+            return false;
+
+        auto _word      = _idx / 64;
+        bool _probation = (m_probation[_word].fetch_and(~bit(_idx)) & bit(_idx)) != 0;
+        auto _factor    = (_probation) ? tim::settings::throttle_hysteresis() : 1.0;
+        auto _budget    = tim::settings::throttle_budget();
+        bool _throttle  = false;
+
+        if(_budget > 0.0)
+        {
+            auto _overhead = m_overhead.load(std::memory_order_relaxed);
+            auto _runtime  = m_runtime.load(std::memory_order_relaxed);
+            auto _global   = (_runtime > 0) ? (100.0 * _overhead) / _runtime : 0.0;
+            auto _local    = (100.0 * _func.overhead) / (_func.accum + _func.overhead);
+            // a function on probation is not re-enabled unless its relative overhead
+            // is well under the budget, regardless of the overall overhead
+            _throttle = (_probation) ? (_local * _factor > _budget)
+                                     : (_global > _budget && _local > _budget);
+            if(_throttle && (tim::settings::debug() || tim::settings::verbose() > 0))
+            {
+                auto name = tim::get_hash_identifier(_id);
+                fprintf(stderr,
+                        "[timemory-trace]> Throttling all future calls to '%s' on rank "
+                        "= %i, pid = %i. overhead = %.2f%% of run-time (overall = "
+                        "%.2f%%, budget = %.2f%%) from %lu invocations...\n",
+                        name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
+                        _local, _global, _budget, (unsigned long) _func.count);
+            }
+        }
+        else
+        {
+            _throttle = check_throttle(_id, _func.count, _func.accum / _func.count,
+                                       _factor);
+        }
+
+        if(_throttle && (m_throttled[_word].fetch_or(bit(_idx)) & bit(_idx)) == 0)
+        {
+            m_generation.fetch_add(1, std::memory_order_release);
+            get_trace_sites().set(_idx, true);
+        }
+        return _throttle;
+    }
+
+    // re-enable the throttled functions on probation once throttle_interval elapsed
+    void reevaluate()
+    {
+        auto _interval = tim::settings::throttle_interval();
+        if(_interval <= 0.0)
+            return;
+        auto _now  = tim::get_clock_real_now<int64_t, std::nano>();
+        auto _last = m_last.load(std::memory_order_relaxed);
+        if(_now - _last < static_cast<int64_t>(_interval * 1.0e9) ||
+           !m_last.compare_exchange_strong(_last, _now))
+            return;
+
+        bool _changed = false;
+        for(size_t i = 0; i < m_words; ++i)
+        {
+            auto _bits = m_throttled[i].exchange(0);
+            if(_bits != 0)
+            {
+                m_probation[i].fetch_or(_bits);
+                _changed = true;
+            }
+            for(uint32_t j = 0; _bits != 0; ++j, _bits >>= 1)
+            {
+                if(_bits & 1)
+                    get_trace_sites().set(i * 64 + j, false);
+            }
+        }
+        // start a new window for the overall overhead
+        m_overhead.store(0, std::memory_order_relaxed);
+        m_runtime.store(0, std::memory_order_relaxed);
+        if(_changed)
+            m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    static uint64_t bit(uint32_t _idx) { return uint64_t{ 1 } << (_idx % 64); }
+
+    size_t                                   m_words = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_throttled;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_probation;
+    std::atomic<uint64_t>                    m_generation{ 0 };
+    std::atomic<int64_t>                     m_last{ 0 };
+    std::atomic<int64_t>                     m_overhead{ 0 };
+    std::atomic<int64_t>                     m_runtime{ 0 };
+};
+//
+//--------------------------------------------------------------------------------------//
+//
+trace_index_table&
+get_trace_index()
+{
+    static trace_index_table _instance(
+        tim::get_env<size_t>("TIMEMORY_TRACE_INDEX_CAPACITY", 1 << 17));
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+std::unique_ptr<trace_stack>&
+get_trace_stack()
+{
+    static thread_local auto _instance = std::make_unique<trace_stack>(
+        tim::get_env<size_t>("TIMEMORY_TRACE_STACK_DEPTH", 512));
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+trace_throttle&
+get_trace_throttle()
+{
+    static trace_throttle _instance(get_trace_index().capacity());
+    return _instance;
+}
+//
+//--------------------------------------------------------------------------------------//
+//
+//  a disabled (patched-out) call site never calls into the library so the throttled
+//  functions are re-evaluated every throttle_interval by a background thread once
+//  a site was registered. Otherwise, functions which are only invoked via these
+//  sites would never be re-enabled on probation
+//
+struct trace_site_monitor
+{
+    ~trace_site_monitor() { stop(); }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> _lk(m_mutex);
+        if(m_thread.joinable())
+            return;
+        m_stop   = false;
+        m_thread = std::thread(&trace_site_monitor::run, this);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> _lk(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if(m_thread.joinable())
+            m_thread.join();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        while(!m_stop)
+        {
+            // re-evaluation is disabled when the interval is zero but it may change
+            auto _interval = tim::settings::throttle_interval();
+            _interval      = (_interval > 0.0) ? std::max(_interval, 1.0e-3) : 1.0;
+            m_cv.wait_for(_lk, std::chrono::duration<double>(_interval),
+                          [this]() { return m_stop; });
+            if(m_stop)
+                break;
+            _lk.unlock();
+            get_trace_throttle().reevaluate();
+            _lk.lock();
+        }
+    }
+
+    bool                    m_stop = false;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::thread             m_thread;
+};
+//
+trace_site_monitor&
+get_trace_site_monitor()
+{
+    static trace_site_monitor _instance{};
+    return _instance;
+}
+//
+}  // namespace
+
 //--------------------------------------------------------------------------------------//
 
 extern std::array<bool, 2>&
 get_library_state();
 
+//--------------------------------------------------------------------------------------//
+//  report and return whether a function with the given average runtime
+//  should be throttled. The threshold is scaled by the hysteresis factor for
+//  functions which were re-enabled on probation
+//
+static bool
+check_throttle(uint64_t id, uint64_t _count, uint64_t _accum, double _factor)
+{
+    if(_accum < _factor * tim::settings::throttle_value())
+    {
+        if(tim::settings::debug() || tim::settings::verbose() > 0)
+        {
+            auto name = tim::get_hash_identifier(id);
+            fprintf(stderr,
+                    "[timemory-trace]> Throttling all future calls to '%s' on rank = "
+                    "%i, pid = "
+                    "%i, thread = %i. avg runtime = %lu ns from %lu invocations... "
+                    "Consider eliminating from instrumentation...\n",
+                    name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
+                    (int) tim::threading::get_id(), (unsigned long) _accum,
+                    (unsigned long) _count);
+        }
+        return true;
+    }
+
+    if(_accum < (10 * tim::settings::throttle_value()) &&
+       (tim::settings::debug() || tim::settings::verbose() > 1))
+    {
+        auto name = tim::get_hash_identifier(id);
+        fprintf(stderr,
+                "[timemory-trace]> Warning! function call '%s' within an order "
+                "of magnitude of threshold for throttling value on rank = %i, "
+                "pid = "
+                "%i, thread = %i. avg runtime = %lu ns from %lu invocations... "
+                "Consider eliminating from instrumentation...\n",
+                name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
+                (int) tim::threading::get_id(), (unsigned long) _accum,
+                (unsigned long) _count);
+    }
+    return false;
+}
+
 //--------------------------------------------------------------------------------------//
 
 static bool use_mpi_gotcha  = false;
@@ -322,7 +872,6 @@ setup_mpi_gotcha()
 
 static bool                                mpi_gotcha_configured = setup_mpi_gotcha();
 static std::shared_ptr<mpi_trace_bundle_t> mpi_gotcha_handle{ nullptr };
-static std::map<size_t, string_t>          master_hash_ids;
 
 //--------------------------------------------------------------------------------------//
 //
@@ -370,7 +919,10 @@ extern "C"
     //
     bool timemory_is_throttled(const char* name)
     {
-        size_t _id = tim::get_hash_id(name);
+        size_t _id  = tim::get_hash_id(name);
+        auto   _idx = get_trace_index().find(_id);
+        if(_idx != trace_index_table::npos && get_trace_throttle().is_throttled(_idx))
+            return true;
         return (get_throttle()->count(_id) > 0);
     }
     //
@@ -386,13 +938,10 @@ extern "C"
         if(_id != id)
             tim::add_hash_id(_id, id);
 
-        // master thread adds the ids
-        if(tim::threading::get_id() == 0)
-        {
-            master_hash_ids[id] = name;
-            if(_id != id)
-                master_hash_ids[_id] = name;
-        }
+        // assign the dense index(es) used by the push/pop fast path
+        get_trace_index().insert(id);
+        if(_id != id)
+            get_trace_index().insert(_id);
     }
     //
     //----------------------------------------------------------------------------------//
@@ -405,16 +954,18 @@ extern "C"
     //
     //----------------------------------------------------------------------------------//
     //
-    void timemory_copy_hash_ids()
+    void timemory_add_trace_site(uint64_t id, int* throttled)
     {
-        auto                     lk = tim::trace::lock<tim::trace::library>();
-        static thread_local bool once_per_thread = false;
-        if(!once_per_thread && tim::threading::get_id() > 0)
+        if(!throttled)
+            return;
+        auto lk   = tim::trace::lock<tim::trace::library>();
+        auto _idx = get_trace_index().insert(id);
+        // without a dense index the site is never disabled
+        if(_idx != trace_index_table::npos)
         {
-            once_per_thread  = true;
-            auto _master_ids = master_hash_ids;
-            for(auto itr : _master_ids)
-                timemory_add_hash_id(itr.first, itr.second.c_str());
+            get_trace_sites().add(_idx, throttled,
+                                  get_trace_throttle().is_throttled(_idx));
+            get_trace_site_monitor().start();
         }
     }
     //
@@ -430,14 +981,42 @@ extern "C"
         if(!get_library_state()[0] || get_library_state()[1] || !tim::settings::enabled())
             return;
 
-        if(get_throttle()->count(id) > 0)
+        auto _idx = get_trace_index().find(id);
+        if(_idx != trace_index_table::npos && !tim::settings::debug())
+        {
+            auto& _stack    = get_trace_stack();
+            auto& _throttle = get_trace_throttle();
+            if(_stack->generation != _throttle.generation())
+                _throttle.sync(*_stack, get_trace_index().size());
+            // every push beyond the capacity of the shadow stack is counted, even
+            // when throttled, so that the matching pop goes to the trace map
+            if(_stack->depth == _stack->capacity)
+                ++_stack->overflow;
+            if(_stack->is_throttled(_idx))
+            {
+                if(++_stack->skipped % tim::settings::throttle_count() == 0)
+                    _throttle.reevaluate();
+                return;
+            }
+            if(_stack->overflow == 0)
+            {
+                auto& _rec = _stack->records[_stack->depth++];
+                _rec.enter = (tim::settings::throttle_budget() > 0.0)
+                             ? tim::get_clock_real_now<int64_t, std::nano>()
+                             : 0;
+                new(&_rec.data) traceset_t(id);
+                _rec.index = _idx;
+                _rec.get().start();
+                _rec.begin = tim::get_clock_real_now<int64_t, std::nano>();
+                return;
+            }
+        }
+
+        if(!get_throttle()->empty() && get_throttle()->count(id) > 0)
             return;
 
         auto& _trace_map = get_trace_map();
 
-        if(_trace_map.empty())
-            timemory_copy_hash_ids();
-
         if(tim::settings::debug())
         {
             int64_t  n    = _trace_map[id].size();
@@ -465,6 +1044,56 @@ extern "C"
         if(!get_library_state()[0] || get_library_state()[1])
             return;
 
+        auto _idx = get_trace_index().find(id);
+        if(_idx != trace_index_table::npos)
+        {
+            auto& _stack = get_trace_stack();
+            // pushes are LIFO so while there are pushes which did not fit in the
+            // shadow stack, this pop belongs to the innermost one: the trace map
+            if(_stack->overflow > 0)
+            {
+                --_stack->overflow;
+                if(_stack->is_throttled(_idx))
+                    return;
+            }
+            // throttled in the fast path so there is no record. This must be checked
+            // before searching the stack, otherwise in a recursive function the pop
+            // would unwind the record of an ancestor call
+            else if(_stack->is_throttled(_idx))
+            {
+                return;
+            }
+            else if(_stack->unwind(_idx))
+            {
+                auto  _end     = tim::get_clock_real_now<int64_t, std::nano>();
+                auto& _rec     = _stack->records[_stack->depth - 1];
+                auto  _enter   = _rec.enter;
+                auto  _elapsed = _end - _rec.begin;
+                _stack->pop();
+
+                auto& _func = _stack->function(_idx, get_trace_index().size());
+                _func.accum += _elapsed;
+                if(_enter > 0)
+                {
+                    // time spent in the instrumentation outside of [begin, end]
+                    auto _exit     = tim::get_clock_real_now<int64_t, std::nano>();
+                    auto _overhead = (_exit - _enter) - _elapsed;
+                    _func.overhead += _overhead;
+                    _stack->overhead += _overhead;
+                    if(_stack->depth == 0)
+                        _stack->runtime += _exit - _enter;
+                }
+                if(++_func.count % tim::settings::throttle_count() == 0)
+                {
+                    auto& _throttle = get_trace_throttle();
+                    _throttle.update(id, _idx, _func, *_stack);
+                    _throttle.reevaluate();
+                    _func = trace_function_state{};
+                }
+                return;
+            }
+        }
+
         auto& _trace_map = get_trace_map();
         if(!tim::settings::enabled() && _trace_map.empty())
             return;
@@ -497,7 +1126,7 @@ extern "C"
             _trace_map[id].pop_back();
         }
 
-        if(get_throttle() && get_throttle()->count(id) > 0)
+        if(get_throttle() && !get_throttle()->empty() && get_throttle()->count(id) > 0)
             return;
 
         if(!get_overhead())
@@ -508,41 +1137,8 @@ extern "C"
         if(_count % tim::settings::throttle_count() == 0)
         {
             auto _accum = get_overhead()->at(id).first.get_accum() / _count;
-            if(_accum < tim::settings::throttle_value())
-            {
-                if(tim::settings::debug() || tim::settings::verbose() > 0)
-                {
-                    auto name = tim::get_hash_ids()->find(id)->second;
-                    fprintf(
-                        stderr,
-                        "[timemory-trace]> Throttling all future calls to '%s' on rank = "
-                        "%i, pid = "
-                        "%i, thread = %i. avg runtime = %lu ns from %lu invocations... "
-                        "Consider eliminating from instrumentation...\n",
-                        name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
-                        (int) tim::threading::get_id(), (unsigned long) _accum,
-                        (unsigned long) _count);
-                }
+            if(check_throttle(id, _count, _accum))
                 get_throttle()->insert(id);
-            }
-            else
-            {
-                if(_accum < (10 * tim::settings::throttle_value()) &&
-                   (tim::settings::debug() || tim::settings::verbose() > 1))
-                {
-                    auto name = tim::get_hash_ids()->find(id)->second;
-                    fprintf(
-                        stderr,
-                        "[timemory-trace]> Warning! function call '%s' within an order "
-                        "of magnitude of threshold for throttling value on rank = %i, "
-                        "pid = "
-                        "%i, thread = %i. avg runtime = %lu ns from %lu invocations... "
-                        "Consider eliminating from instrumentation...\n",
-                        name.c_str(), tim::dmp::rank(), (int) tim::process::get_id(),
-                        (int) tim::threading::get_id(), (unsigned long) _accum,
-                        (unsigned long) _count);
-                }
-            }
             get_overhead()->at(id).first.reset();
             get_overhead()->at(id).second = 0;
         }
@@ -565,6 +1161,7 @@ extern "C"
                 return;
 
             _hash = tim::add_hash_id(name);
+            get_trace_index().insert(_hash);
         }
         timemory_push_trace_hash(_hash);
     }
@@ -729,7 +1326,10 @@ extern "C"
         // reset traces just in case
         user_trace_bundle::reset();
 
+        get_trace_site_monitor().stop();
+
         // clean up any remaining entries
+        get_trace_stack()->clear(true);
         for(auto& itr : get_trace_map())
         {
             for(auto& eitr : itr.second)
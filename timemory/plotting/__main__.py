@@ -38,6 +38,7 @@ import traceback
 import timemory
 import timemory.plotting as _plotting
 from timemory.plotting import plot_parameters
+from timemory.util.binary import is_binary_file, load_binary
 
 
 def try_plot():
@@ -108,8 +109,11 @@ def try_plot():
 
         data = {}
         for i in range(len(args.files)):
-            f = open(args.files[i], "r")
-            _jdata = json.load(f)
+            if is_binary_file(args.files[i]):
+                _jdata = load_binary(args.files[i])
+            else:
+                with open(args.files[i], "r") as f:
+                    _jdata = json.load(f)
             _ranks = _jdata["timemory"]["ranks"]
 
             nranks = len(_ranks)
@@ -119,7 +123,8 @@ def try_plot():
                 _rtag = '' if nranks == 1 else '_{}'.format(j)
                 _rtitle = '' if nranks == 1 else ' (MPI rank: {})'.format(j)
 
-                _data.filename = args.files[i].replace('.json', _rtag)
+                _data.filename = args.files[i].replace(
+                    '.json', _rtag).replace('.tmb', _rtag)
                 if len(args.titles) == 1:
                     _data.title = args.titles[0] + _rtitle
                 else:
@@ -809,9 +809,12 @@ def plot(data=[], files=[], plot_params=plot_parameters(),
     if len(files) > 0:
         for filename in files:
             # print('Reading {}...'.format(filename))
-            f = open(filename, "r")
-            _data = read(json.load(f))
-            f.close()
+            from ..util.binary import is_binary_file, load_binary
+            if is_binary_file(filename):
+                _data = read(load_binary(filename))
+            else:
+                with open(filename, "r") as f:
+                    _data = read(json.load(f))
             _data.filename = filename
             _data.title = filename
             data.append(_data)
@@ -257,6 +257,21 @@ def read_ert(inp):
     return inst
 
 
+#==============================================================================#
+#
+def read_ceilings(inp):
+    """
+    Read the measured bandwidth and latency of each level of the memory
+    hierarchy (not present in the output of older versions)
+    """
+    data = inp
+    if not "ceilings" in data and "roofline" in data:
+        data = data["roofline"]
+    if not "ceilings" in data:
+        return []
+    return data["ceilings"]
+
+
 #==============================================================================#
 #
 def get_peak_ops(roof_data, flop_info=None):
@@ -391,6 +406,22 @@ def get_peak_bandwidth(roof_data, band_labels):
     return peak_bandwidths
 
 
+#==============================================================================#
+#
+def get_cache_bandwidth(ceilings, band_labels, key="triad-bandwidth"):
+    """
+    Get the bandwidth of each level of the memory hierarchy from the ceilings
+    measured by ERT
+    """
+    peak_bandwidths = []
+    for ceiling in ceilings:
+        if not ceiling["level"] in band_labels:
+            continue
+        peak_bandwidths.append([float(ceiling[key]) / GIGABYTE,
+                                ceiling["level"] + " GB/s"])
+    return peak_bandwidths
+
+
 #==============================================================================#
 #
 def get_theo_bandwidth_txns(txn_bandwidth):
@@ -807,6 +838,7 @@ def plot_roofline(ai_data, op_data, band_labels, txn_bandwidths,inst_peak, _rtyp
 
     band_data = read_ert(ai_data)
     peak_data = read_ert(op_data)
+    ceilings = read_ceilings(ai_data)
 
     info = op_data["unit_repr"] if "unit_repr" in op_data else None
 
@@ -817,6 +849,8 @@ def plot_roofline(ai_data, op_data, band_labels, txn_bandwidths,inst_peak, _rtyp
 
     if inst_roofline:
         peak_band = get_theo_bandwidth_txns(txn_bandwidths)
+    elif len(ceilings) > 0:
+        peak_band = get_cache_bandwidth(ceilings, band_labels)
     else:
         peak_band = get_peak_bandwidth(band_data,band_labels)
 
@@ -0,0 +1,246 @@
+#!@PYTHON_EXECUTABLE@
+# MIT License
+#
+# Copyright (c) 2018, The Regents of the University of California,
+# through Lawrence Berkeley National Laboratory (subject to receipt of any
+# required approvals from the U.S. Dept. of Energy).  All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+from __future__ import absolute_import
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2020, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__version__ = "@PROJECT_VERSION@"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+__status__ = "Development"
+
+import io
+import os
+import json
+import shutil
+import struct
+import tempfile
+import unittest
+from timemory.util import binary
+
+# --------------------------- helper functions ----------------------------------------- #
+# unsigned LEB128
+def varint(v):
+    _out = bytearray()
+    while True:
+        _c = v & 0x7f
+        v >>= 7
+        if v == 0:
+            _out.append(_c)
+            return bytes(_out)
+        _out.append(_c | 0x80)
+
+
+# zig-zag encoding of signed integers
+def zigzag(v):
+    return (v << 1) if v >= 0 else ((-v << 1) - 1)
+
+
+def string(s):
+    _s = s.encode("utf-8")
+    return varint(len(_s)) + _s
+
+
+# encodes the data with the tokens of cereal::StreamingBinaryOutputArchive
+class encoder():
+    def __init__(self):
+        self.keys = {}
+
+    def key(self, k):
+        if k in self.keys:
+            return bytes(bytearray([0x05])) + varint(self.keys[k])
+        self.keys[k] = len(self.keys)
+        return bytes(bytearray([0x04])) + varint(self.keys[k]) + string(k)
+
+    def value(self, v):
+        if isinstance(v, dict):
+            _out = bytes(bytearray([0x01]))
+            for k in sorted(v.keys()):
+                _out += self.key(k) + self.value(v[k])
+            return _out + bytes(bytearray([0x03]))
+        elif isinstance(v, list):
+            _out = bytes(bytearray([0x02]))
+            for itr in v:
+                _out += self.value(itr)
+            return _out + bytes(bytearray([0x03]))
+        elif v is None:
+            return bytes(bytearray([0x10]))
+        elif isinstance(v, bool):
+            return bytes(bytearray([0x12 if v else 0x11]))
+        elif isinstance(v, int) and v < 0:
+            return bytes(bytearray([0x13])) + varint(zigzag(v))
+        elif isinstance(v, int):
+            return bytes(bytearray([0x14])) + varint(v)
+        elif isinstance(v, float):
+            return bytes(bytearray([0x15])) + struct.pack("<d", v)
+        return bytes(bytearray([0x17])) + string(v)
+
+
+def encode(data):
+    return b"TMBIN" + bytes(bytearray([1])) + encoder().value(data)
+
+
+# timeline of (tid, hash, start, stop, value) events with integer values
+def encode_timeline(label, events, labels, compressed):
+    _out = b"TMTL" + bytes(bytearray([1, 1 if compressed else 0, 1]))
+    _out += varint(8) + string(label)
+    _tids = sorted(set([itr[0] for itr in events]))
+    for _tid in _tids:
+        _events = [itr for itr in events if itr[0] == _tid]
+        _out += bytes(bytearray([0x01])) + varint(_tid) + varint(len(_events))
+        _prev = 0
+        for _, _hash, _start, _stop, _value in _events:
+            if compressed:
+                _out += varint(_hash) + varint(zigzag(_start - _prev))
+                _out += varint(_stop - _start) + varint(zigzag(_value))
+                _prev = _start
+            else:
+                _out += struct.pack("<Qqq", _hash, _start, _stop)
+                _out += struct.pack("<q", _value)
+    _out += bytes(bytearray([0x02])) + varint(len(labels))
+    for _hash, _label in sorted(labels.items()):
+        _out += varint(_hash) + string(_label)
+    return _out
+
+
+# -------------------------- Binary Tests set ----------------------------------------- #
+# Binary tests class
+class TimemoryBinaryTests(unittest.TestCase):
+    # setup class: temporary directory
+    @classmethod
+    def setUpClass(self):
+        self.data = {
+            "timemory": {
+                "ranks": [
+                    {
+                        "rank": 0,
+                        "graph": [
+                            {"hash": 12345678901234567890, "prefix": ">>> main",
+                             "depth": 0, "entry": {"laps": 3, "value": 1.5e-3}},
+                            {"hash": 42, "prefix": ">>> |_inner",
+                             "depth": 1, "entry": {"laps": 6, "value": -2}},
+                        ],
+                        "empty": [],
+                        "none": None,
+                        "flags": [True, False],
+                    }
+                ]
+            }
+        }
+        self.tmpdir = tempfile.mkdtemp()
+
+    # Tear down class: remove temporary directory
+    @classmethod
+    def tearDownClass(self):
+        shutil.rmtree(self.tmpdir)
+
+    def write(self, name, data):
+        _fname = os.path.join(self.tmpdir, name)
+        with open(_fname, "wb") as f:
+            f.write(data)
+        return _fname
+
+    # ---------------------------------------------------------------------------------- #
+    # test decoding into the same data as json.load
+    def test_read_binary(self):
+        """
+        read_binary
+        """
+        _data = binary.read_binary(io.BytesIO(encode(self.data)))
+        self.assertEqual(_data, self.data)
+        self.assertEqual(_data, json.loads(json.dumps(self.data)))
+
+    # ---------------------------------------------------------------------------------- #
+    # test files are detected and converted to json
+    def test_binary_to_json(self):
+        """
+        binary_to_json
+        """
+        _fname = self.write("data.tmb", encode(self.data))
+        self.assertTrue(binary.is_binary_file(_fname))
+        self.assertFalse(binary.is_timeline_file(_fname))
+        self.assertEqual(binary.load_binary(_fname), self.data)
+
+        _output = binary.binary_to_json(_fname)
+        self.assertEqual(_output, os.path.join(self.tmpdir, "data.json"))
+        self.assertFalse(binary.is_binary_file(_output))
+        with open(_output, "r") as f:
+            self.assertEqual(json.load(f), self.data)
+
+    # ---------------------------------------------------------------------------------- #
+    # test invalid input is rejected
+    def test_invalid(self):
+        """
+        invalid
+        """
+        _encoded = encode(self.data)
+        with self.assertRaises(ValueError):
+            binary.read_binary(io.BytesIO(b"TMBAD" + _encoded[5:]))
+        with self.assertRaises(ValueError):
+            binary.read_binary(io.BytesIO(_encoded[:5] + b"\x02" + _encoded[6:]))
+        with self.assertRaises(EOFError):
+            binary.read_binary(io.BytesIO(_encoded[:-4]))
+
+    # ---------------------------------------------------------------------------------- #
+    # test the compressed and uncompressed timelines
+    def test_timeline(self):
+        """
+        timeline
+        """
+        _events = [(0, 11, 1000, 1500, 500), (0, 12, 1100, 1200, -100),
+                   (0, 11, 900, 2000, 1100), (3, 13, 5000, 7000, 2000)]
+        _labels = {11: "outer", 12: "inner"}
+        for _compressed in [False, True]:
+            _fname = self.write("data.tmt", encode_timeline(
+                "wall", _events, _labels, _compressed))
+            self.assertTrue(binary.is_timeline_file(_fname))
+            self.assertFalse(binary.is_binary_file(_fname))
+
+            _data = binary.load_timeline(_fname)
+            self.assertEqual(_data["label"], "wall")
+            self.assertEqual(len(_data["events"]), len(_events))
+            for itr, ref in zip(_data["events"], _events):
+                self.assertEqual((itr["tid"], itr["hash"], itr["start"], itr["stop"],
+                                  itr["value"]), ref)
+                self.assertEqual(itr["label"], _labels.get(ref[1], "{}".format(ref[1])))
+
+            _output = binary.binary_to_json(_fname)
+            with open(_output, "r") as f:
+                self.assertEqual(json.load(f), _data)
+
+
+# ----------------------------- main test runner ---------------------------------------- #
+# main runner
+def run():
+    # run all tests
+    unittest.main()
+
+
+if __name__ == '__main__':
+    run()
@@ -44,7 +44,16 @@ __all__ = ['util',
            'timer',
            'rss_usage',
            'marker',
-           'auto_tuple']
+           'auto_tuple',
+           'binary',
+           'read_binary',
+           'load_binary',
+           'binary_to_json',
+           'is_binary_file',
+           'is_timeline_file',
+           'load_timeline']
 
 from . import util
 from .util import *
+from . import binary
+from .binary import *
@@ -0,0 +1,310 @@
+#!@PYTHON_EXECUTABLE@
+#
+# MIT License
+#
+# Copyright (c) 2018, The Regents of the University of California,
+# through Lawrence Berkeley National Laboratory (subject to receipt of any
+# required approvals from the U.S. Dept. of Energy).  All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# @file binary.py
+# Reader for the binary (.tmb) and timeline (.tmt) outputs and converter to JSON
+#
+
+from __future__ import absolute_import
+from __future__ import division
+import io
+import sys
+import json
+import struct
+import argparse
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2020, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__version__ = "@PROJECT_VERSION@"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+__status__ = "Development"
+__all__ = ['read_binary',
+           'load_binary',
+           'binary_to_json',
+           'is_binary_file',
+           'is_timeline_file',
+           'load_timeline']
+
+# tokens written by cereal::StreamingBinaryOutputArchive
+_MAGIC = b"TMBIN"
+_BEGIN_OBJECT = 0x01
+_BEGIN_ARRAY = 0x02
+_END_NODE = 0x03
+_DEFINE_KEY = 0x04
+_KEY_REF = 0x05
+_NULL = 0x10
+_FALSE = 0x11
+_TRUE = 0x12
+_INT = 0x13
+_UINT = 0x14
+_F64 = 0x15
+_F32 = 0x16
+_STR = 0x17
+
+# timeline (.tmt) output written by tim::timeline_writer
+_TIMELINE_MAGIC = b"TMTL"
+_TIMELINE_EVENTS = 0x01
+_TIMELINE_LABELS = 0x02
+
+
+class _reader():
+    """
+    Decodes the token stream. The input is consumed from a buffered file object
+    so the whole file is never held in memory twice.
+    """
+
+    def __init__(self, stream):
+        self.stream = stream
+        self.keys = {}
+
+    def byte(self):
+        _c = self.stream.read(1)
+        if len(_c) == 0:
+            raise EOFError("Unexpected end of binary timemory data")
+        return ord(_c)
+
+    def bytes(self, n):
+        _b = self.stream.read(n)
+        if len(_b) != n:
+            raise EOFError("Unexpected end of binary timemory data")
+        return _b
+
+    def varint(self):
+        _shift = 0
+        _value = 0
+        while True:
+            _c = self.byte()
+            _value |= (_c & 0x7f) << _shift
+            if _c < 0x80:
+                return _value
+            _shift += 7
+
+    def string(self):
+        return self.bytes(self.varint()).decode("utf-8", "replace")
+
+    def key(self, tok):
+        if tok == _DEFINE_KEY:
+            _id = self.varint()
+            self.keys[_id] = self.string()
+            return self.keys[_id]
+        elif tok == _KEY_REF:
+            return self.keys[self.varint()]
+        raise ValueError("Expected a key token, found {}".format(hex(tok)))
+
+    def value(self, tok):
+        if tok == _BEGIN_OBJECT:
+            _obj = {}
+            while True:
+                _tok = self.byte()
+                if _tok == _END_NODE:
+                    return _obj
+                _key = self.key(_tok)
+                _obj[_key] = self.value(self.byte())
+        elif tok == _BEGIN_ARRAY:
+            _arr = []
+            while True:
+                _tok = self.byte()
+                if _tok == _END_NODE:
+                    return _arr
+                _arr.append(self.value(_tok))
+        elif tok == _NULL:
+            return None
+        elif tok == _FALSE:
+            return False
+        elif tok == _TRUE:
+            return True
+        elif tok == _INT:
+            _v = self.varint()
+            return (_v >> 1) ^ -(_v & 1)
+        elif tok == _UINT:
+            return self.varint()
+        elif tok == _F64:
+            return struct.unpack("<d", self.bytes(8))[0]
+        elif tok == _F32:
+            return struct.unpack("<f", self.bytes(4))[0]
+        elif tok == _STR:
+            return self.string()
+        raise ValueError("Invalid token in binary timemory data: {}".format(hex(tok)))
+
+
+def is_binary_file(filename):
+    """
+    Returns true if the file starts with the binary timemory header
+    """
+    try:
+        with open(filename, "rb") as f:
+            return f.read(len(_MAGIC)) == _MAGIC
+    except (IOError, OSError):
+        return False
+
+
+def read_binary(stream):
+    """
+    Reads binary timemory data from a file object opened in binary mode and returns
+    the same dictionary that json.load would return for the equivalent JSON output
+    """
+    _magic = stream.read(len(_MAGIC))
+    if _magic != _MAGIC:
+        raise ValueError("Not binary timemory data (invalid header)")
+    _version = ord(stream.read(1))
+    if _version != 1:
+        raise ValueError("Unsupported binary timemory version: {}".format(_version))
+    _r = _reader(stream)
+    return _r.value(_r.byte())
+
+
+def load_binary(filename):
+    """
+    Reads a binary timemory file (.tmb)
+    """
+    with io.open(filename, "rb", buffering=(1 << 20)) as f:
+        return read_binary(f)
+
+
+def is_timeline_file(filename):
+    """
+    Returns true if the file starts with the timeline header
+    """
+    try:
+        with open(filename, "rb") as f:
+            return f.read(len(_TIMELINE_MAGIC)) == _TIMELINE_MAGIC
+    except (IOError, OSError):
+        return False
+
+
+def load_timeline(filename):
+    """
+    Reads a timeline file (.tmt) and returns a dictionary with the component label
+    and the list of events. Each event provides the thread, hash, label, start and
+    stop (nanoseconds since the epoch) and the value of the component
+    """
+    with io.open(filename, "rb", buffering=(1 << 20)) as f:
+        if f.read(len(_TIMELINE_MAGIC)) != _TIMELINE_MAGIC:
+            raise ValueError("Not a timemory timeline (invalid header)")
+        _r = _reader(f)
+        _version = _r.byte()
+        if _version != 1:
+            raise ValueError("Unsupported timeline version: {}".format(_version))
+        _compressed = (_r.byte() & 1) == 1
+        _encoding = _r.byte()
+        _value_size = _r.varint()
+        _label = _r.string()
+
+        _int_formats = {1: "<b", 2: "<h", 4: "<i", 8: "<q"}
+
+        def _signed(v):
+            return (v >> 1) ^ -(v & 1)
+
+        def _value():
+            if _compressed and _encoding == 1:
+                return _signed(_r.varint())
+            _bytes = _r.bytes(_value_size)
+            if _encoding == 1 and _value_size in _int_formats:
+                return struct.unpack(_int_formats[_value_size], _bytes)[0]
+            elif _encoding == 2:
+                return struct.unpack("<d", _bytes)[0]
+            elif _encoding == 3:
+                return struct.unpack("<f", _bytes)[0]
+            return list(bytearray(_bytes))
+
+        _events = []
+        _labels = {}
+        while True:
+            _tok = f.read(1)
+            if len(_tok) == 0:
+                break
+            _tok = ord(_tok)
+            if _tok == _TIMELINE_EVENTS:
+                _tid = _r.varint()
+                _prev = 0
+                for i in range(_r.varint()):
+                    if _compressed:
+                        _hash = _r.varint()
+                        _start = _prev + _signed(_r.varint())
+                        _stop = _start + _r.varint()
+                        _prev = _start
+                    else:
+                        _hash, _start, _stop = struct.unpack("<Qqq", _r.bytes(24))
+                    _events.append({"tid": _tid, "hash": _hash, "start": _start,
+                                    "stop": _stop, "value": _value()})
+            elif _tok == _TIMELINE_LABELS:
+                for i in range(_r.varint()):
+                    _hash = _r.varint()
+                    _labels[_hash] = _r.string()
+            else:
+                raise ValueError(
+                    "Invalid token in timemory timeline: {}".format(hex(_tok)))
+
+        for itr in _events:
+            itr["label"] = _labels.get(itr["hash"], "{}".format(itr["hash"]))
+        return {"label": _label, "events": _events}
+
+
+def binary_to_json(filename, output=None, indent=None):
+    """
+    Converts a binary timemory file or timeline to JSON. If output is None, the
+    output filename is the input filename with a .json extension
+    """
+    if output is None:
+        _base = filename
+        for _ext in (".tmb", ".tmt"):
+            if filename.endswith(_ext):
+                _base = filename[:-len(_ext)]
+        output = _base + ".json"
+    if is_timeline_file(filename):
+        _data = load_timeline(filename)
+    else:
+        _data = load_binary(filename)
+    with open(output, "w") as f:
+        json.dump(_data, f, indent=indent)
+        f.write("\n")
+    return output
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Convert binary timemory output (.tmb, .tmt) to JSON")
+    parser.add_argument("files", nargs='+', help="Binary timemory files")
+    parser.add_argument("-o", "--output", nargs='*', default=[],
+                        help="Output filenames (default: input with .json extension)")
+    parser.add_argument("-i", "--indent", type=int, default=None,
+                        help="JSON indentation")
+    args = parser.parse_args(argv)
+
+    if len(args.output) > 0 and len(args.output) != len(args.files):
+        raise ValueError("Must provide an output filename for each input file")
+
+    for i, filename in enumerate(args.files):
+        _output = args.output[i] if len(args.output) > 0 else None
+        print("[timemory]> Converting '{}' to '{}'...".format(
+            filename, binary_to_json(filename, _output, args.indent)))
+
+
+if __name__ == "__main__":
+    main()